@@ -18,6 +18,7 @@ public:
 	~ConfigLoader();
 
 	std::vector<ServerConfig> loadConfig(const std::vector<ASTnode*>& astNodes);
+	void            loadConfig(const std::vector<ASTnode*>& astNodes, GlobalConfig& globalConfig);
 
 private:
 	// --- Core Parsing Functions ---
@@ -31,6 +32,7 @@ private:
 
 
 	// --- Dispatcher Functions ---
+	void            processDirective(const DirectiveNode* directive, GlobalConfig& globalConfig);
 	void            processDirective(const DirectiveNode* directive, ServerConfig& serverConfig);
 	void            processDirective(const DirectiveNode* directive, LocationConfig& locationConfig);
 
@@ -38,10 +40,22 @@ private:
 	// --- Dedicated Helper Functions for Each Directive's Specific Logic ---
 	// (As defined in previous comments, these remain the same)
 
+	// Global (main context) directives
+	void            handleWorkerProcessesDirective(const DirectiveNode* directive, GlobalConfig& globalConfig);
+	void            handleWorkerThreadsDirective(const DirectiveNode* directive, GlobalConfig& globalConfig);
+	void            handleAcceptBatchDirective(const DirectiveNode* directive, GlobalConfig& globalConfig);
+	void            handleWorkerConnectionsDirective(const DirectiveNode* directive, GlobalConfig& globalConfig);
+	void            handleMaxPendingRequestsDirective(const DirectiveNode* directive, GlobalConfig& globalConfig);
+
 	// Server-specific directives
 	void            handleListenDirective(const DirectiveNode* directive, ServerConfig& serverConfig);
 	void            handleServerNameDirective(const DirectiveNode* directive, ServerConfig& serverConfig);
 	void            handleErrorLogDirective(const DirectiveNode* directive, ServerConfig& serverConfig);
+	void            handleKeepaliveTimeoutDirective(const DirectiveNode* directive, ServerConfig& serverConfig);
+	void            handleKeepaliveRequestsDirective(const DirectiveNode* directive, ServerConfig& serverConfig);
+	void            handleClientHeaderTimeoutDirective(const DirectiveNode* directive, ServerConfig& serverConfig);
+	void            handleClientBodyTimeoutDirective(const DirectiveNode* directive, ServerConfig& serverConfig);
+	void            handleLargeClientHeaderBuffersDirective(const DirectiveNode* directive, ServerConfig& serverConfig);
 
 	// Directives common to both Server and Location contexts (overloaded)
 	void            handleRootDirective(const DirectiveNode* directive, ServerConfig& serverConfig);
@@ -54,6 +68,8 @@ private:
 	void            handleErrorPageDirective(const DirectiveNode* directive, LocationConfig& locationConfig);
 	void            handleClientMaxBodySizeDirective(const DirectiveNode* directive, ServerConfig& serverConfig);
 	void            handleClientMaxBodySizeDirective(const DirectiveNode* directive, LocationConfig& locationConfig);
+	void            handleClientBodyBufferSizeDirective(const DirectiveNode* directive, ServerConfig& serverConfig);
+	void            handleClientBodyBufferSizeDirective(const DirectiveNode* directive, LocationConfig& locationConfig);
 
 	// Location-specific directives
 	void            handleAllowedMethodsDirective(const DirectiveNode* directive, LocationConfig& locationConfig);
@@ -62,12 +78,17 @@ private:
 	void            handleCgiExtensionDirective(const DirectiveNode* directive, LocationConfig& locationConfig);
 	void            handleCgiPathDirective(const DirectiveNode* directive, LocationConfig& locationConfig);
 	void            handleReturnDirective(const DirectiveNode* directive, LocationConfig& locationConfig);
+	void            handleLimitReqDirective(const DirectiveNode* directive, LocationConfig& locationConfig);
 
 
 	// --- General Utility/Conversion Functions (Members of ConfigLoader) ---
 	HttpMethod      stringToHttpMethod(const std::string& methodStr) const;
 	LogLevel        stringToLogLevel(const std::string& levelStr) const;
 	long            parseSizeToBytes(const std::string& sizeStr) const;
+	int             parseWorkerCount(const DirectiveNode* directive) const;
+	long            parseCountArgument(const DirectiveNode* directive, long minValue, long maxValue) const;
+	long            parseTimeToMs(const std::string& timeStr) const;
+	long            parseTimeDirective(const DirectiveNode* directive) const;
 
 	// --- Error Handling Helper ---
 	void            error(const std::string& msg, int line, int col) const;
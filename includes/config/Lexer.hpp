@@ -14,6 +14,7 @@
 # define LEXER_HPP
 
 # include <string>
+# include <vector>
 # include <fstream>
 # include <sstream>
 # include <iostream>
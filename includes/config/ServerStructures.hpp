@@ -108,9 +108,20 @@ struct LocationConfig {
     // Justification: Allows location-specific client body size limits.
     long                        clientMaxBodySize; // Stored in bytes
 
+	// Request bodies larger than this are spooled to a temp file in the upload store as they arrive
+	// Example: client_body_buffer_size 64k; -> up to 64k kept in memory, beyond the body goes to disk
+	long                        clientBodyBufferSize; // Stored in bytes
+
+	// Per client address request rate limit (token bucket), checked before any file or CGI work.
+	// Example: limit_req 10 20; -> 10 requests/s per client IP, bursts of up to 20 extra requests,
+	// anything beyond is answered with 429 Too Many Requests
+	int                         limitReqRate;  // requests per second, 0 = no limit
+	int                         limitReqBurst; // extra requests allowed at once
+
 	// Constructor to set sensible defaults
 	LocationConfig() : root(""), autoindex(false), uploadEnabled(false), uploadStore(""),
-					   returnCode(0), path("/"), matchType("") {}
+					   returnCode(0), path("/"), matchType(""), clientBodyBufferSize(16384),
+					   limitReqRate(0), limitReqBurst(0) {}
 };
 
 // --- Server Configuration Structure ---
@@ -137,12 +148,36 @@ struct ServerConfig {
 	// Example: client_max_body_size 10m; -> 10 * 1024 * 1024
 	long                        clientMaxBodySize; // Stored in bytes
 
+	// Memory kept for a request body before it is spooled to disk (inherited by locations)
+	// Justification: an upload costs a bounded amount of memory, whatever its size.
+	// Example: client_body_buffer_size 16k; -> bodies over 16k go to a temp file in the upload store
+	long                        clientBodyBufferSize; // Stored in bytes
+
 	// Subject Requirement: (Implied by robustness) Error logging path and level
 	// Justification: Critical for debugging and monitoring server health.
 	// Example: error_log /var/log/webserv_error.log error;
 	std::string                 errorLogPath;
 	LogLevel                    errorLogLevel;
 
+	// Persistent connections and timeouts (all delays stored in milliseconds)
+	// Justification: Reusing connections saves TCP handshakes; the timeouts keep slow or idle
+	// clients from holding connections forever (slowloris).
+	// Example: keepalive_timeout 75s; -> idle delay between two requests, 0 disables keep-alive
+	// Example: keepalive_requests 1000; -> requests served on one connection before closing it
+	// Example: client_header_timeout 60s; -> delay to receive a whole request head
+	// Example: client_body_timeout 60s; -> delay between two reads of the body (or two writes of the response)
+	long                        keepaliveTimeout;
+	long                        keepaliveRequests;
+	long                        clientHeaderTimeout;
+	long                        clientBodyTimeout;
+
+	// Request head limits, as nginx's large_client_header_buffers
+	// Justification: bounds the memory a client can pin with a huge request line or header block.
+	// Example: large_client_header_buffers 4 8k; -> request line up to 8k (else 414), each header line
+	// up to 8k and the whole head up to 4 * 8k (else 431)
+	long                        largeHeaderBuffers;
+	long                        largeHeaderBufferSize; // Stored in bytes
+
 	// Default configuration inherited by locations if not overridden
 	// Justification: Simplifies configuration and matches Nginx behavior.
 	std::string                 root;
@@ -155,7 +190,11 @@ struct ServerConfig {
 
 	// Constructor to set sensible defaults
 	ServerConfig() : host("0.0.0.0"), port(80), clientMaxBodySize(1048576), // Default 1MB
+					 clientBodyBufferSize(16384), // Default 16k, as nginx on 64-bit
 					 errorLogPath(""), errorLogLevel(DEFAULT_LOG),
+					 keepaliveTimeout(75000), keepaliveRequests(1000),
+					 clientHeaderTimeout(60000), clientBodyTimeout(60000),
+					 largeHeaderBuffers(4), largeHeaderBufferSize(8192),
 					 root(""), autoindex(false) {} // These roots/autoindex will be overridden if set
 };
 
@@ -163,8 +202,31 @@ struct ServerConfig {
 // Justification: A webserv typically manages multiple independent server blocks.
 struct GlobalConfig {
 	std::vector<ServerConfig> servers;
-	// Potentially global directives if your subject allowed them
-	// (e.g., common error_log for all servers if not overridden)
+
+	// Global (main context) directives, outside of any server block.
+	// Example: worker_processes 4; -> 4 worker processes forked by the master
+	// Example: worker_processes auto; -> 0, resolved to the number of online CPUs at startup
+	int                       workerProcesses;
+
+	// Example: worker_threads 8; -> 8 reactor threads per process, each with its own event loop
+	// Example: worker_threads auto; -> 0, resolved to the number of online CPUs at startup
+	int                       workerThreads;
+
+	// Example: accept_batch 64; -> at most 64 connections accepted per listener event,
+	// the rest of the queue waits for the next loop iteration so established clients are not starved
+	int                       acceptBatch;
+
+	// Example: worker_connections 4096; -> at most 4096 open client connections per reactor,
+	// extra clients get an immediate 503 and are closed
+	int                       workerConnections;
+
+	// Example: max_pending_requests 256; -> when 256 responses are already waiting to be sent,
+	// new requests are answered with 503 + Retry-After instead of being processed (0 = unlimited)
+	int                       maxPendingRequests;
+
+	// Constructor to set sensible defaults (single process, single thread, no master)
+	GlobalConfig() : workerProcesses(1), workerThreads(1), acceptBatch(64), workerConnections(1024),
+		maxPendingRequests(0) {}
 };
 
 // --- Helper functions for parsing string to enum/long ---
@@ -49,6 +49,18 @@ typedef enum tokenType {
 	T_UPLOAD_STORE,			// "upload_store"
 	T_LOCATION,				// "location"
 	T_ERROR_LOG,			// "error_log"
+	T_KEEPALIVE_TIMEOUT,	// "keepalive_timeout"
+	T_KEEPALIVE_REQUESTS,	// "keepalive_requests"
+	T_CLIENT_HEADER_TIMEOUT,	// "client_header_timeout"
+	T_CLIENT_BODY_TIMEOUT,	// "client_body_timeout"
+	T_WORKER_PROCESSES,		// "worker_processes" (global context)
+	T_WORKER_THREADS,		// "worker_threads" (global context)
+	T_ACCEPT_BATCH,			// "accept_batch" (global context)
+	T_WORKER_CONNECTIONS,	// "worker_connections" (global context)
+	T_MAX_PENDING_REQUESTS,	// "max_pending_requests" (global context)
+	T_LIMIT_REQ,			// "limit_req" (location context)
+	T_LARGE_CLIENT_HEADER_BUFFERS,	// "large_client_header_buffers"
+	T_CLIENT_BODY_BUFFER_SIZE,		// "client_body_buffer_size"
 
 	// Other data/values
 	T_IDENTIFIER,			// strings/words that are not keywords specified above
@@ -0,0 +1,25 @@
+#ifndef BODY_SINK_HPP
+# define BODY_SINK_HPP
+
+#include <cstddef>
+#include <vector>
+
+// Destination of decoded request body bytes, handed over as they arrive:
+// memory (the request body vector), an upload file, a CGI stdin pipe...
+class BodySink {
+public:
+    virtual ~BodySink() {}
+    virtual void write(const char* data, size_t len) = 0;
+};
+
+// Appends to a vector, typically HttpRequest::body
+class VectorBodySink : public BodySink {
+private:
+    std::vector<char>& _out;
+
+public:
+    explicit VectorBodySink(std::vector<char>& out) : _out(out) {}
+    virtual void write(const char* data, size_t len) { _out.insert(_out.end(), data, data + len); }
+};
+
+#endif // BODY_SINK_HPP
@@ -0,0 +1,56 @@
+#ifndef BODY_SPOOL_HPP
+# define BODY_SPOOL_HPP
+
+#include "BodySink.hpp"
+#include <string>
+#include <vector>
+
+// Request body kept in memory while small, spooled to disk once it outgrows the threshold
+// (client_body_buffer_size): what was received so far is written out, the memory is released,
+// and the rest of the body is appended to the file as it arrives. Memory stays bounded by the
+// receive buffers whatever the body size.
+// The file is created without a name (O_TMPFILE) in the directory the body is meant for, so that
+// publish() can give it its final name with linkat: the upload appears whole or not at all, and
+// nothing is left behind if the request fails. Where O_TMPFILE is not available, a hidden temp
+// file is used instead: publish() links it under its final name with link(), which never replaces
+// an existing file, and the temp name is unlinked.
+class BodySpool : public BodySink {
+private:
+    std::vector<char>&  _memory;    // body while it is below the threshold (HttpRequest::body)
+    std::string         _dir;       // where to spool, empty: the body stays in memory
+    size_t              _threshold;
+    int                 _fd;        // -1 until the body is spooled
+    std::string         _tempPath;  // name of the temp file when O_TMPFILE could not be used
+    size_t              _size;      // body bytes received, in memory or on disk
+    bool                _failed;    // a write to the file failed: the body is incomplete
+
+    bool openFile();
+    void writeFile(const char* data, size_t len);
+    void closeFile();
+
+    BodySpool(const BodySpool&);
+    BodySpool& operator=(const BodySpool&);
+
+public:
+    explicit BodySpool(std::vector<char>& memory);
+    ~BodySpool();
+
+    // Drops the body (an unpublished file goes with it) and goes back to memory only
+    void reset();
+    // Bodies growing past 'threshold' bytes go to a file in 'dir'
+    void spoolTo(const std::string& dir, size_t threshold);
+
+    virtual void write(const char* data, size_t len);
+    // Announced body length: past the threshold the file is opened before the first byte.
+    // True if the body goes to the file
+    bool expect(size_t length);
+
+    size_t size() const;
+    bool inFile() const;
+    bool failed() const;
+    // Links the spooled body at 'path' (which must not exist, in the spool directory's file system).
+    // False if the body is not in a file, is incomplete, or the link failed (errno is set)
+    bool publish(const std::string& path);
+};
+
+#endif // BODY_SPOOL_HPP
@@ -0,0 +1,62 @@
+#ifndef CHUNKED_DECODER_HPP
+# define CHUNKED_DECODER_HPP
+
+#include "BodySink.hpp"
+#include <cstddef>
+
+// Longest chunk extension / trailer section accepted (both are skipped, never stored)
+const size_t CHUNK_EXT_MAX = 4096;
+const size_t CHUNK_TRAILER_MAX = 8192;
+
+// Incremental decoder for "Transfer-Encoding: chunked" bodies (RFC 9112, section 7.1).
+// Bytes can be fed in pieces of any size, split anywhere: the state machine keeps where it stopped
+// and nothing is buffered. Chunk data goes straight to the sink; sizes, extensions and trailers
+// are consumed and dropped. The body limit is checked against each announced chunk size,
+// so an oversized body is refused before its data arrives.
+class ChunkedDecoder {
+public:
+    enum State {
+        CHUNK_SIZE,         // hex digits of the chunk size
+        CHUNK_EXT,          // ";name=value" after the size, skipped
+        CHUNK_SIZE_LF,      // LF ending the size line
+        CHUNK_DATA,         // chunk data, to the sink
+        CHUNK_DATA_CR,      // CRLF after the data
+        CHUNK_DATA_LF,
+        CHUNK_TRAILER,      // start of a trailer line, or the final CRLF
+        CHUNK_TRAILER_LINE, // trailer field, skipped
+        CHUNK_TRAILER_LF,
+        CHUNK_FINAL_LF,     // LF of the empty line ending the body
+        CHUNK_DONE,
+        CHUNK_ERROR
+    };
+
+    ChunkedDecoder();
+
+    void reset();
+    // Largest decoded body accepted (client_max_body_size), 0 for no limit
+    void setLimit(size_t maxBody);
+
+    // Decodes from data[0, len), writing chunk data to 'sink'. Returns the number of bytes consumed:
+    // all of them unless the body ended (the rest belongs to the next request) or an error was found.
+    size_t decode(const char* data, size_t len, BodySink& sink);
+
+    bool isDone() const;
+    bool hasError() const;
+    int getErrorStatus() const;         // 413 over the limit, 400 otherwise
+    const char* getErrorMessage() const;
+    size_t decodedSize() const;         // body bytes written to the sink so far
+
+private:
+    State       _state;
+    size_t      _chunkSize;     // size being read, then data left in the current chunk
+    size_t      _digits;        // hex digits read for the current size
+    size_t      _skipped;       // extension / trailer bytes skipped so far
+    size_t      _decoded;
+    size_t      _limit;
+    int         _errorStatus;
+    const char* _errorMessage;
+
+    void fail(const char* msg, int status = 400);
+};
+
+#endif // CHUNKED_DECODER_HPP
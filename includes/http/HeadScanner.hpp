@@ -0,0 +1,62 @@
+#ifndef HEAD_SCANNER_HPP
+# define HEAD_SCANNER_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Offsets of one header line: [start, end) excludes the CRLF,
+// colon is the position of the first ':' (npos if the line has none)
+struct HeadLine {
+    size_t start;
+    size_t end;
+    size_t colon;
+};
+
+// Delimiters of a request head (request line + header block), found in a single pass.
+// All offsets are relative to the start of the scanned buffer. The layout also keeps where the
+// scan stopped: scanning the same buffer again after more bytes arrived only looks at the new ones.
+struct HeadLayout {
+    size_t lineEnd;                 // CR ending the request line, npos until received
+    size_t firstSpace;              // first and second SP of the request line, npos if missing
+    size_t secondSpace;
+    std::vector<HeadLine> headers;  // one entry per header line, in order
+    size_t headEnd;                 // offset just past the empty line ending the head, 0 until received
+    bool malformed;                 // a bare CR or LF was found: lines must end with CRLF
+
+    // Resume point
+    size_t scanned;                 // bytes already examined
+    size_t lineStart;               // start of the line being received
+    size_t colon;                   // first ':' of that line, npos if none yet
+    bool inRequestLine;
+
+    HeadLayout();
+    void clear();                   // restarts the scan; keeps the capacity of 'headers'
+};
+
+// Vectorized scanner for the bytes that structure a request head: CR, LF, ':' and SP.
+// Each 64-byte block is turned into a bitmask of those bytes (AVX2: 2 compares of 32 bytes,
+// SSE2: 4 of 16, scalar fallback otherwise) and only the set bits are visited.
+// The implementation is chosen once at runtime from CPUID.
+class HeadScanner {
+public:
+    enum Level {
+        LEVEL_SCALAR,
+        LEVEL_SSE2,
+        LEVEL_AVX2
+    };
+
+    // Completes 'out' with the delimiters of data[out.scanned, len). Stops at the end of the head.
+    // The bytes before out.scanned must not have changed since the previous call (clear() otherwise).
+    static void scan(const char* data, size_t len, HeadLayout& out);
+
+    // Best implementation supported by this CPU
+    static Level detectedLevel();
+    // Implementation used by scan(); forceLevel() is meant for benchmarks and tests,
+    // a level above detectedLevel() is clamped to it
+    static Level level();
+    static void forceLevel(Level lvl);
+    static const char* levelName(Level lvl);
+};
+
+#endif // HEAD_SCANNER_HPP
@@ -0,0 +1,91 @@
+#ifndef HEADER_NAMES_HPP
+# define HEADER_NAMES_HPP
+
+#include <cstddef>
+
+// Well-known request/response header names, resolved once while parsing.
+// Keep in the same order as the name table of HeaderNames.cpp.
+enum HeaderId {
+    HEADER_ACCEPT,
+    HEADER_ACCEPT_CHARSET,
+    HEADER_ACCEPT_ENCODING,
+    HEADER_ACCEPT_LANGUAGE,
+    HEADER_ACCEPT_RANGES,
+    HEADER_ACCESS_CONTROL_REQUEST_HEADERS,
+    HEADER_ACCESS_CONTROL_REQUEST_METHOD,
+    HEADER_AGE,
+    HEADER_ALLOW,
+    HEADER_AUTHORIZATION,
+    HEADER_CACHE_CONTROL,
+    HEADER_CONNECTION,
+    HEADER_CONTENT_DISPOSITION,
+    HEADER_CONTENT_ENCODING,
+    HEADER_CONTENT_LANGUAGE,
+    HEADER_CONTENT_LENGTH,
+    HEADER_CONTENT_LOCATION,
+    HEADER_CONTENT_RANGE,
+    HEADER_CONTENT_TYPE,
+    HEADER_COOKIE,
+    HEADER_DATE,
+    HEADER_DNT,
+    HEADER_ETAG,
+    HEADER_EXPECT,
+    HEADER_EXPIRES,
+    HEADER_FORWARDED,
+    HEADER_FROM,
+    HEADER_HOST,
+    HEADER_IF_MATCH,
+    HEADER_IF_MODIFIED_SINCE,
+    HEADER_IF_NONE_MATCH,
+    HEADER_IF_RANGE,
+    HEADER_IF_UNMODIFIED_SINCE,
+    HEADER_KEEP_ALIVE,
+    HEADER_LAST_MODIFIED,
+    HEADER_LINK,
+    HEADER_LOCATION,
+    HEADER_MAX_FORWARDS,
+    HEADER_ORIGIN,
+    HEADER_PRAGMA,
+    HEADER_PROXY_AUTHORIZATION,
+    HEADER_RANGE,
+    HEADER_REFERER,
+    HEADER_RETRY_AFTER,
+    HEADER_SEC_CH_UA,
+    HEADER_SEC_CH_UA_MOBILE,
+    HEADER_SEC_CH_UA_PLATFORM,
+    HEADER_SEC_FETCH_DEST,
+    HEADER_SEC_FETCH_MODE,
+    HEADER_SEC_FETCH_SITE,
+    HEADER_SEC_FETCH_USER,
+    HEADER_SERVER,
+    HEADER_SET_COOKIE,
+    HEADER_TE,
+    HEADER_TRAILER,
+    HEADER_TRANSFER_ENCODING,
+    HEADER_UPGRADE,
+    HEADER_UPGRADE_INSECURE_REQUESTS,
+    HEADER_USER_AGENT,
+    HEADER_VIA,
+    HEADER_WARNING,
+    HEADER_WWW_AUTHENTICATE,
+    HEADER_X_FORWARDED_FOR,
+    HEADER_X_FORWARDED_HOST,
+    HEADER_X_FORWARDED_PROTO,
+    HEADER_X_REAL_IP,
+    HEADER_X_REQUESTED_WITH,
+    HEADER_ID_COUNT,                // number of known names
+    HEADER_UNKNOWN = HEADER_ID_COUNT
+};
+
+// Perfect hash of the known names: one hash of the (lowercase) name, one table read and one
+// comparison tell which HeaderId it is. The table is built before main(), with the first seed
+// for which no two known names share a slot.
+class HeaderNames {
+public:
+    // 'name' must already be lowercase (the parser lowercases header names in place)
+    static HeaderId lookup(const char* name, size_t len);
+    // Lowercase name of a known header, NULL for HEADER_UNKNOWN
+    static const char* name(HeaderId id);
+};
+
+#endif // HEADER_NAMES_HPP
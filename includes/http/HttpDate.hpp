@@ -0,0 +1,23 @@
+#ifndef HTTP_DATE_HPP
+# define HTTP_DATE_HPP
+
+#include <cstddef>
+
+// Clock for the "Date" header (RFC 9110, 6.6.1), one per thread, so one per event loop.
+// The loop calls tick() when it wakes up; the RFC 1123 string is only reformatted when
+// the second has changed. Responses read it with now(): no time(), gmtime() or strftime()
+// per response. A thread without an event loop (tests, tools) gets a clock that ticks on each read.
+class HttpDate {
+public:
+    static const size_t LENGTH = 29; // "Sun, 06 Nov 1994 08:49:37 GMT"
+
+    // Refreshes this thread's date if the second changed; from now on the caller drives the clock
+    static void tick();
+    // This thread's current date, LENGTH characters, NUL-terminated
+    static const char* now();
+
+private:
+    HttpDate();
+};
+
+#endif // HTTP_DATE_HPP
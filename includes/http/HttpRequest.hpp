@@ -15,10 +15,11 @@
 
 #include <string>
 #include <vector>
-#include <map>
 #include <iostream> // For print()
-#include <algorithm> // For std::tolower
-#include <sstream> // For internal use in print() or future debugging
+#include "../utils/StringView.hpp"
+#include "HeaderNames.hpp"
+
+class BodySpool;
 
 // --- Enum for HTTP Methods ---
 // Defined directly in HttpRequest.hpp as requested.
@@ -34,26 +35,37 @@ enum HttpMethod {
 // For simplicity in this direct example, it's declared here.
 std::string httpMethodToString(HttpMethod method);
 
+// Header fields stored in the request itself; a request with more spills into a vector
+# define REQUEST_INLINE_FIELDS 32
 
+// A parsed request does not copy its head: method, URI, path, query string, version and every
+// header name/value are (offset, length) slices into the parser buffer, which keeps those bytes
+// in place until the parser is reset. The accessors return StringViews built on the fly.
+// Views are valid while the request is being handled; call StringView::str() on a value to keep it,
+// or retain() to give the request its own copy of the head (a request built with setRequestLine()
+// and setHeader() always owns its bytes).
 class HttpRequest {
 public:
-    // --- Request Line Components ---
-    std::string method;         // e.g., "GET", "POST" - The raw string method (no enum here)
-    std::string uri;            // The full URI as received, e.g., "/path/to/resource?key=value"
-    std::string protocolVersion;// e.g., "HTTP/1.1"
-
-    // --- URI Decomposed Components (Derived from 'uri' AFTER parsing is complete) ---
-    std::string path;           // e.g., "/path/to/resource"
-    std::map<std::string, std::string> queryParams; // e.g., {"key": "value"}
-
-    // --- Headers ---
-    // Header names will be stored in a canonical form (e.g., all lowercase) for case-insensitive lookup.
-    std::map<std::string, std::string> headers;
+    // [offset, offset + length) in the bytes the request refers to
+    struct Slice {
+        size_t offset;
+        size_t length;
+        Slice() : offset(0), length(0) {}
+        Slice(size_t off, size_t len) : offset(off), length(len) {}
+    };
+    struct HeaderField {
+        Slice name;  // lowercase
+        Slice value; // trimmed
+        HeaderId id; // HEADER_UNKNOWN if the name is not a well-known one
+    };
 
     // --- Message Body ---
     // Use std::vector<char> for the body to handle binary data safely.
     std::vector<char> body;
-    size_t expectedBodyLength; // From Content-Length header, 0 if no Content-Length or not POST
+    size_t expectedBodyLength; // From Content-Length header (any method), 0 if none
+    // Set by the parser when the body was spooled to a file (client_body_buffer_size exceeded):
+    // 'body' is then empty and the file is published with spool->publish(). Owned by the parser
+    BodySpool* spool;
 
     // --- Parsing State ---
     enum ParsingState {
@@ -68,12 +80,79 @@ public:
     // --- Constructor ---
     HttpRequest();
 
-    // --- Helper Method to get header value (case-insensitive lookup) ---
-    // Converts the input 'name' to lowercase before looking it up.
-    std::string getHeader(const std::string& name) const;
+    // --- Request Line Components ---
+    StringView method() const;          // e.g., "GET", "POST" - as received
+    HttpMethod methodId() const;        // the same, HTTP_UNKNOWN if not GET/POST/DELETE
+    StringView uri() const;             // the full URI as received, e.g., "/path/to/resource?key=value"
+    StringView protocolVersion() const; // e.g., "HTTP/1.1"
+
+    // --- URI Decomposed Components ---
+    StringView path() const;            // e.g., "/path/to/resource"
+    StringView queryString() const;     // e.g., "key=value", empty without '?'
+    // Value of a query parameter (empty for a lonely key); the query string is walked on each call
+    StringView queryParam(const StringView& key) const;
+    bool hasQueryParam(const StringView& key) const;
+
+    // --- Headers ---
+    // For a repeated header the last one wins. Empty view if absent.
+    // Known headers are indexed by HeaderId: one array read, no name comparison
+    StringView header(HeaderId id) const;
+    bool hasHeader(HeaderId id) const;
+    // Any name, case-insensitive: resolved to its HeaderId first, unknown names are searched
+    // among the fields without an id
+    StringView header(const StringView& name) const;
+    bool hasHeader(const StringView& name) const;
+    // Every header field in received order (names lowercase)
+    size_t headerCount() const;
+    StringView headerName(size_t i) const;
+    StringView headerValue(size_t i) const;
+    HeaderId headerId(size_t i) const;
+    bool isOverridden(size_t i) const; // a later field has the same name: header() returns that one
+
+    // --- Body ---
+    size_t bodySize() const;            // decoded body length, in 'body' or in the spool file
+
+    // --- Building a request without the parser (tests, forged requests): the request owns its bytes ---
+    void setRequestLine(const std::string& method, const std::string& uri, const std::string& version = "HTTP/1.1");
+    void setHeader(const std::string& name, const std::string& value);
+
+    // Copies the head into the request: its views no longer depend on the parser buffer
+    void retain();
 
     // --- Helper Method for debugging ---
     void print() const;
+
+private:
+    friend class HttpRequestParser;
+
+    const std::vector<char>* _source;   // parser buffer the slices refer to, NULL when the request owns its bytes
+    std::vector<char>   _owned;         // bytes of a retained or built request
+    size_t              _rawBegin;      // part of _source covered by the slices, copied by retain()
+    size_t              _rawEnd;
+
+    Slice               _method;
+    HttpMethod          _methodId;
+    Slice               _uri;
+    Slice               _version;
+    Slice               _path;
+    Slice               _query;
+
+    HeaderField         _fields[REQUEST_INLINE_FIELDS];
+    std::vector<HeaderField> _extraFields; // fields past REQUEST_INLINE_FIELDS
+    size_t              _fieldCount;
+    unsigned int        _known[HEADER_ID_COUNT]; // 1 + index of the last field with this id, 0 if none
+
+    const char* bytes() const;
+    StringView view(const Slice& slice) const;
+    const HeaderField& field(size_t i) const;
+    size_t findField(HeaderId id) const;            // index of the last field with this id, headerCount() if none
+    size_t findField(const StringView& name) const; // same, by name
+
+    // Used by the parser (slices into its buffer) and by the builders (slices into _owned)
+    void bindSource(const std::vector<char>* source, size_t begin, size_t end);
+    void setRequestLineSlices(const Slice& method, const Slice& uri, const Slice& version);
+    void addField(const Slice& name, const Slice& value, HeaderId id);
+    Slice appendOwned(const std::string& str, bool lowercase);
 };
 
 #endif // HTTP_REQUEST_HPP
\ No newline at end of file
@@ -53,6 +53,17 @@ public:
      */
     HttpResponse handleRequest(const HttpRequest& request, const MatchedConfig& matchedConfig);
 
+    /**
+     * @brief Runs the checks that only need the request head: redirection, allowed method and,
+     * for a POST, the announced Content-Length against client_max_body_size.
+     * Called before the body is read, so a refused request does not cost its upload.
+     * @param request The request, whose head is complete (the body may not be there yet).
+     * @param matchedConfig The configuration (server and location) determined by the dispatcher.
+     * @param response Set to the final response when the checks settle the request.
+     * @return true if the request is settled from its head, false if it goes on to its body.
+     */
+    bool answerFromHead(const HttpRequest& request, const MatchedConfig& matchedConfig, HttpResponse& response);
+
 private:
     // --- Helper Methods for Response Generation ---
 
@@ -147,6 +158,9 @@ private:
     // Checks if a file exists
     bool _fileExists(const std::string& path) const;
 
+    // Builds a 200 response whose body is sent straight from the file
+    HttpResponse _serveFile(const std::string& path) const;
+
     // Checks if a file/directory has read permissions
     bool _canRead(const std::string& path) const;
 
@@ -14,6 +14,9 @@
 # define HTTP_REQUEST_PARSER_HPP
 
 #include "HttpRequest.hpp" // Now contains HttpMethod enum
+#include "HeadScanner.hpp"
+#include "ChunkedDecoder.hpp"
+#include "BodySpool.hpp"
 #include <vector>
 #include <string>
 
@@ -21,23 +24,56 @@
 const std::string CRLF = "\r\n";
 const std::string DOUBLE_CRLF = "\r\n\r\n";
 
+// Default request head limits, as nginx's "large_client_header_buffers 4 8k"
+const size_t DEFAULT_MAX_HEADER_LINE = 8192;
+const size_t DEFAULT_MAX_HEAD = 4 * 8192;
+
+// Body space reserved up front from Content-Length; beyond, the body vector grows geometrically
+// (a client announcing a huge body without sending it must not pin that much memory)
+const size_t BODY_RESERVE_MAX = 1024 * 1024;
+
+// Told when a request head is complete, before any body byte is read: the request can be routed
+// right away, and the route sets the body limit (setBodyLimit) and where the body goes (spoolBodyTo).
+// Returns 0 to go on, or the status of the final response the router has already sent:
+// the request then ends in the ERROR state with that status and its body is never read.
+class RequestRouter {
+public:
+    virtual ~RequestRouter() {}
+    virtual int routeRequest(const HttpRequest& request, bool bodyFollows) = 0;
+};
+
 class HttpRequestParser {
 private:
     HttpRequest         _request;
-    std::vector<char>   _buffer; // Buffer to accumulate incoming raw data
+    std::vector<char>   _buffer; // Buffer to accumulate incoming raw data; holds the head the request's slices refer to
+    size_t              _readPos; // Read cursor: bytes before it are consumed, dropped on the next compaction
+    HeadLayout          _head;   // Delimiters of the request head, found by HeadScanner
+    size_t              _maxLine; // Longest request line / header line accepted (414 / 431 beyond)
+    size_t              _maxHead; // Longest request head accepted (431 beyond)
+    int                 _errorStatus; // Status code to answer with once in the ERROR state
+    size_t              _maxBody; // Largest body accepted (413 beyond), 0: no limit
+    bool                _isChunked; // Body sent with "Transfer-Encoding: chunked"
+    ChunkedDecoder      _chunked; // Decodes it as it arrives, straight into the request body
+    BodySpool           _spool;   // Receives the body: the request body vector, or a file once it is large
+    RequestRouter*      _router;  // Routes each head before its body, NULL: limits as set, body in memory
 
     // Private helper functions for parsing stages
     void parseRequestLine();
     void parseHeaders();
     void parseBody();
-    void decomposeURI(); // Separates URI into path and query parameters
+    void parseChunkedBody();
 
-    // Helper to find a substring (pattern) within a std::vector<char>
-    size_t findInVector(const std::string& pattern);
-    // Helper to remove parsed data from the beginning of the buffer
+    // Helper to scan the bytes of the head received since the previous call
+    void scanHead();
+    // Helper to check the head against _maxLine / _maxHead
+    bool checkHeadLimits();
+    // Helper to mark parsed data at the read cursor as consumed
     void consumeBuffer(size_t count);
-    // Helper to set the error state and potentially log a message
-    void setError(const std::string& msg);
+    // Unread part of the buffer (the head offsets of _head are relative to it)
+    const char* unreadData() const;
+    size_t unreadSize() const;
+    // Helper to set the error state (with the status to answer) and potentially log a message
+    void setError(const std::string& msg, int status = 400);
 
 public:
     HttpRequestParser();
@@ -53,13 +89,29 @@ public:
     bool isComplete() const;
     // Check if parsing encountered an error
     bool hasError() const;
+    // Status code matching the error (400, 413, 414, 431 or 501)
+    int getErrorStatus() const;
+
+    // Limits of the request head (large_client_header_buffers of the server block)
+    void setHeaderLimits(size_t maxLine, size_t maxHead);
+    // Body limit (client_max_body_size), 0 for none: checked against Content-Length before the body
+    // is read, and against chunk sizes as they are decoded
+    void setBodyLimit(size_t maxBody);
+    void setRequestRouter(RequestRouter* router);
+    // Called by the router: the current body goes to a file in 'dir' once over 'threshold' bytes
+    void spoolBodyTo(const std::string& dir, size_t threshold);
 
     // Get the parsed HttpRequest object
     HttpRequest& getRequest();
     const HttpRequest& getRequest() const; // Const version
 
-    // Reset the parser for a new request (e.g., for Keep-Alive)
+    // Check if bytes of a request not yet complete are waiting in the buffer
+    bool hasBufferedData() const;
+
+    // Reset the parser for the next request (Keep-Alive), keeping pipelined bytes already received
     void reset();
+    // Free the buffer when nothing of a next request is in it (connection going idle)
+    void releaseBuffer();
 };
 
 #endif // HTTP_REQUEST_PARSER_HPP
\ No newline at end of file
@@ -16,8 +16,17 @@
 #include <string>
 #include <vector>
 #include <map>
-#include <sstream> // For building the response string
-#include <ctime>   // For generating Date header
+
+// A status the server sends: its reason phrase and its complete, pre-serialized status line
+struct HttpStatusLine {
+    int         code;
+    const char* reason;     // e.g., "Not Found"
+    const char* line;       // e.g., "HTTP/1.1 404 Not Found\r\n"
+    size_t      length;     // of 'line'
+};
+
+// Entry of the status line table for this code, NULL if the code is not in it
+const HttpStatusLine* findHttpStatusLine(int statusCode);
 
 // Helper function to get HTTP status message for a given code
 std::string getHttpStatusMessage(int statusCode);
@@ -34,7 +43,9 @@ class HttpResponse {
 public:
     /**
      * @brief Constructor for HttpResponse.
-     * Initializes with default protocol version and common headers.
+     * Initializes with default protocol version and status 200. The default Server and
+     * Date headers are not stored: they are written by the serialization, unless the
+     * handler sets its own or removes Date.
      */
     HttpResponse();
 
@@ -45,7 +56,7 @@ public:
 
     /**
      * @brief Sets the HTTP status of the response.
-     * Automatically sets the status message based on common HTTP status codes.
+     * Looks the code up in the table of pre-serialized status lines: no string is built.
      * @param code The HTTP status code (e.g., 200, 404).
      */
     void setStatus(int code);
@@ -57,6 +68,12 @@ public:
      */
     void addHeader(const std::string& name, const std::string& value);
 
+    /**
+     * @brief Removes a header from the response, if present.
+     * @param name The name of the header (e.g., "Date").
+     */
+    void removeHeader(const std::string& name);
+
     /**
      * @brief Sets the response body from a string.
      * Automatically sets the Content-Length header.
@@ -78,26 +95,61 @@ public:
      */
     std::string toString() const;
 
+    /**
+     * @brief Generates only the status line and headers, terminated by the empty line.
+     * Lets the connection queue the header block and the body as separate segments
+     * instead of concatenating them into one string. The head is written into a buffer
+     * allocated once at its exact size, so its cost does not depend on the body.
+     * @return A string holding the serialized head of the response.
+     */
+    std::string headToString() const;
+
+    /**
+     * @brief Sets the response body to a file on disk, sent later as a file range.
+     * The file is not read here: the connection opens it when queuing the response.
+     * Automatically sets the Content-Length header.
+     * @param path Path of the file to send.
+     * @param size Size of the file in bytes.
+     */
+    void setBodyFile(const std::string& path, size_t size);
+
+    /**
+     * @brief Moves the in-memory body out of the response without copying it.
+     * @param out Receives the body; the response body is left empty.
+     */
+    void releaseBody(std::vector<char>& out);
+
     // --- Getters for Response Components (Optional, but good for debugging/inspection) ---
     int getStatusCode() const { return _statusCode; }
-    const std::string& getStatusMessage() const { return _statusMessage; }
+    const char* getStatusMessage() const;
     const std::string& getProtocolVersion() const { return _protocolVersion; }
     const std::map<std::string, std::string>& getHeaders() const { return _headers; }
     const std::vector<char>& getBody() const { return _body; }
+    bool hasBodyFile() const { return !_bodyFile.empty(); }
+    const std::string& getBodyFile() const { return _bodyFile; }
+    size_t getBodyFileSize() const { return _bodyFileSize; }
 
 
 private:
     std::string _protocolVersion;    // e.g., "HTTP/1.1"
     int         _statusCode;         // e.g., 200, 404
-    std::string _statusMessage;      // e.g., "OK", "Not Found"
+    const HttpStatusLine* _status;   // e.g., 404 "Not Found"; NULL for a code outside the table
     std::map<std::string, std::string> _headers; // Header names are typically canonical (e.g., "Content-Type")
     std::vector<char> _body;         // Use std::vector<char> for the body to handle binary data safely.
+    std::string _bodyFile;           // Path of a file body (empty if the body is in _body)
+    size_t      _bodyFileSize;       // Size of the file body in bytes
+    bool        _sendDate;           // Date header written at serialization (removeHeader("Date") clears it)
+
+    // Sets the Content-Length header to 'length'
+    void setContentLength(size_t length);
 
-    // Helper to generate current GMT date/time for the "Date" header
-    std::string getCurrentGmTime() const;
+    // Serialized size of the status line and headers, empty line included
+    size_t headSize() const;
+    // Appends the serialized head to 'head' (sized by the caller with headSize())
+    void appendHead(std::string& head) const;
 
-    // Default headers that should always be present unless explicitly overridden
-    void setDefaultHeaders();
+    bool sendsDefaultDate() const;
+    bool hasStatusLine() const;
 };
 
 #endif // HTTP_RESPONSE_HPP
@@ -0,0 +1,32 @@
+#ifndef BUFFERPOOL_HPP
+# define BUFFERPOOL_HPP
+
+# include <vector>
+# include <cstddef>
+
+# define RECV_CHUNK_SIZE		16384	// taille d'un bloc de reception
+# define RECV_CHUNKS_HEADERS	1		// en-tete / keep-alive : 16 KiB par readv
+# define RECV_CHUNKS_BODY		4		// corps : 64 KiB par readv
+# define RECV_POOL_MAX_FREE		256		// blocs gardes en reserve (4 MiB), le reste est rendu au systeme
+
+// reserve de blocs de taille fixe pour les lectures : une par Server (donc par thread),
+// pas de verrou. Les connexions empruntent des blocs pour readv et les rendent au repos
+class BufferPool {
+	private:
+		std::vector<char*>	_free;
+		size_t				_inUse;
+
+		BufferPool(const BufferPool& cpy);
+		BufferPool& operator=(const BufferPool& src);
+
+	public:
+		BufferPool();
+		~BufferPool();
+
+		char*	acquire(void);
+		void	release(char* chunk);
+		size_t	inUse(void) const;
+		size_t	available(void) const;
+};
+
+#endif
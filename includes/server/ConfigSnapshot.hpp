@@ -0,0 +1,33 @@
+#ifndef CONFIGSNAPSHOT_HPP
+# define CONFIGSNAPSHOT_HPP
+
+# include <string>
+# include "../config/ServerStructures.hpp"
+# include "../http/RequestDispatcher.hpp"
+
+// une config chargee, jamais modifiee apres publication. Le Server garde une reference sur
+// la courante, chaque connexion sur celle avec laquelle elle a commence : un SIGHUP publie
+// une nouvelle snapshot sans toucher a celles encore utilisees, la derniere reference la libere
+struct ConfigSnapshot {
+	GlobalConfig		config;
+	RequestDispatcher	dispatcher;	// pointe sur config : meme duree de vie
+	unsigned long		generation;
+	volatile int		refs;
+
+	ConfigSnapshot(const GlobalConfig& cfg, unsigned long gen);
+
+	private:
+		ConfigSnapshot(const ConfigSnapshot& cpy);
+		ConfigSnapshot& operator=(const ConfigSnapshot& src);
+};
+
+bool			loadGlobalConfig(const std::string& path, GlobalConfig& config);
+void			setConfigPath(const std::string& path);
+void			publishConfig(const GlobalConfig& config);
+bool			reloadConfig(void);
+ConfigSnapshot*	acquireCurrentConfig(void);
+unsigned long	currentConfigGeneration(void);
+void			retainConfig(ConfigSnapshot* snap);
+void			releaseConfig(ConfigSnapshot* snap);
+
+#endif
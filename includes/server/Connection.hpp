@@ -1,25 +1,118 @@
 #ifndef CONNECTION_HPP
 # define CONNECTION_HPP
 
-# include "Request.hpp"
-# include "Response.hpp"
 # include "divers.hpp"
 # include "Socket.hpp"
-# include "Config.hpp"
+# include "OutputQueue.hpp"
+# include "TimerWheel.hpp"
+# include "BufferPool.hpp"
+# include "ConfigSnapshot.hpp"
+# include "RateLimiter.hpp"
+# include <sys/uio.h>
+# include "../http/HttpRequestParser.hpp"
+# include "../http/RequestDispatcher.hpp"
+# include "../http/HttpResponse.hpp"
 
-class Connection : public Socket {
+// ou en est la connexion : decide quel delai (config du server) surveille le timer
+enum ConnPhase {
+	CONN_HEADERS,	// attente / lecture d'un en-tete : client_header_timeout, pour tout l'en-tete
+	CONN_BODY,		// lecture du corps : client_body_timeout, relance a chaque lecture
+	CONN_WRITING,	// reponse en cours d'envoi : client_body_timeout, relance a chaque ecriture
+	CONN_KEEPALIVE,	// inactive entre deux requetes : keepalive_timeout
+	CONN_LINGERING	// refus envoye, ecriture fermee : on lit et jette ce que le client envoie encore
+};
+
+# define PIPELINE_MAX_RESPONSES	(OUTQ_IOV_MAX / 2)	// reponses en file avant de suspendre le pipeline (en-tete + corps : un writev)
+# define OVERLOAD_RETRY_AFTER	"1"	// secondes conseillees au client dans un 503 de surcharge
+# define CONTINUE_RESPONSE		"HTTP/1.1 100 Continue\r\n\r\n"	// reponse intermediaire a "Expect: 100-continue"
+# define LINGERING_TIME_MS		30000	// fermeture en douceur : 30s au plus (lingering_time de nginx)
+# define LINGERING_TIMEOUT_MS	5000	// ... et 5s au plus entre deux lectures (lingering_timeout)
+# define LINGERING_READS_MAX		64		// lectures jetees par evenement (1 MiB)
+
+// controle d'admission d'un Server, partage avec ses connexions
+struct AdmissionStats {
+	unsigned long	accepted;	// connexions acceptees
+	unsigned long	refused;	// connexions refusees (worker_connections atteint)
+	unsigned long	admitted;	// requetes traitees
+	unsigned long	shed;		// requetes repondues en 503 (max_pending_requests atteint)
+	unsigned long	pending;	// connexions avec une reponse en file
+	bool			overloaded;	// pending >= max_pending_requests : les nouvelles requetes sont delestees
+
+	AdmissionStats() : accepted(0), refused(0), admitted(0), shed(0), pending(0), overloaded(false) {}
+};
+
+class Connection : public Socket, public RequestRouter {
 	private:
-                std::vector<std::pair<Request*, Response*> >	requestResponseList;
-                void        parse_header();
-                void        parse_body();
+                HttpRequestParser           _parser;
+                ConfigSnapshot*             _snapshot;//config avec laquelle la requete en cours a commence
+                const RequestDispatcher*    _dispatcher;
+                OutputQueue                 _out;//reponses pretes, pas encore envoyees (en-tetes, corps, fichiers)
+                bool                        _closeAfterFlush;//fermer une fois la file videe
+                bool                        _peerClosed;//fin de flux du client lue : fermer apres les reponses en cours
+                bool                        _noKeepAlive;//arret du server en cours : plus de reponse persistante
+                int                         _interest;//flags EV_* actuellement armes dans la boucle
+                unsigned long               _requests;//requetes servies sur cette connexion
+                TimerNode                   _timer;//delai en cours, dans la roue du Server
+                int                         _timerPhase;//phase pour laquelle _timer a ete arme (-1 : aucune)
+                std::vector<char*>          _rxChunks;//blocs de reception empruntes au pool du Server
+                AdmissionStats*             _admission;//compteurs du Server, NULL hors Server
+                RateLimiter*                _rateLimiter;//table limit_req du reacteur, NULL hors Server
+                bool                        _countedPending;//compte dans _admission->pending
+                bool                        _readCut;//lecture arretee avant EAGAIN (pipeline suspendu)
+                uint32_t                    _clientIp;//adresse du client, cle de limit_req
+                size_t                      _queued;//reponses mises en file depuis le dernier flush complet
+                MatchedConfig               _matched;//server/location de la requete en cours, connus des l'en-tete
+                bool                        _routed;//_matched vaut pour la requete en cours
+                bool                        _limitChecked;//limit_req deja verifie des l'en-tete (requete avec corps)
+                bool                        _linger;//requete refusee en cours de route : fermeture en douceur
+                unsigned long               _lingerDeadline;//fin de la fermeture en douceur (0 : pas commencee)
+
+                void        processRequests(void);
+                void        buildResponse(void);
+                void        buildErrorResponse(int statusCode);
+                void        buildRateLimitedResponse(unsigned long waitMs, bool keepAlive);
+                void        shedRequest(void);
+                unsigned long   limitReqWait(const LocationConfig* loc, int port);
+                void        queueResponse(HttpResponse& response, bool keepAlive);
+                bool        wantsKeepAlive(const HttpRequest& req) const;
+                virtual int routeRequest(const HttpRequest& req, bool bodyFollows);
 
 	public:
 
 		Connection();
 		virtual ~Connection();
 
-                void            handleRequest(char buf[BUFF_SIZE]);
-                std::string     getRawResponse(void);
+                void            setSnapshot(ConfigSnapshot* snap, ServerConfig* serverBlock);
+                ConfigSnapshot* getSnapshot(void) const;
+                void            setAdmission(AdmissionStats* admission);
+                void            setRateLimiter(RateLimiter* limiter);
+                void            setClientAddr(const struct sockaddr_storage& addr);
+                bool            isCountedPending(void) const;
+                void            setCountedPending(bool counted);
+                bool            isReadCut(void) const;
+                void            setReadCut(bool cut);
+                static const std::string&   overloadResponse(void);
+                void            handleRequest(const char* buf, size_t len);
+                int             prepareRecv(BufferPool& pool, struct iovec* iov);
+                void            consumeRecv(size_t len);
+                void            releaseRecvBuffers(BufferPool& pool);
+                int             flushResponse(void);
+                bool            resumePipeline(void);
+                bool            isPipelinePaused(void) const;
+                bool            hasPendingResponse(void) const;
+                bool            shouldClose(void) const;
+                void            setPeerClosed(void);
+                bool            shouldLinger(void) const;
+                void            startLingering(unsigned long deadline);
+                bool            isLingering(void) const;
+                unsigned long   getLingerDeadline(void) const;
+                void            disableKeepAlive(void);
+                int             getInterest(void) const;
+                void            setInterest(int events);
+                int             getPhase(void) const;
+                TimerNode*      getTimer(void);
+                int             getTimerPhase(void) const;
+                void            setTimerPhase(int phase);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,57 @@
+#ifndef CONNECTIONTABLE_HPP
+# define CONNECTIONTABLE_HPP
+
+# include <vector>
+# include <stdint.h>
+# include "Socket.hpp"
+# include "Connection.hpp"
+
+# define CONN_SLAB_SIZE	256	// connexions par bloc du slab
+
+// une case par fd : le noyau rend toujours le plus petit fd libre, le tableau reste dense
+struct ConnSlot {
+	Socket*		sock;	// listener ou Connection, NULL si la case est libre
+	uint32_t	gen;	// incremente a chaque liberation : un vieux jeton ne correspond plus
+	bool		counted;// compte dans liveConnections (connexion client)
+
+	ConnSlot() : sock(NULL), gen(0), counted(false) {}
+};
+
+// table fd -> socket en O(1) + slab de Connection.
+// Le jeton donne a la boucle d'evenements est (generation << 32 | fd) : un evenement
+// en retard pour un fd ferme puis reutilise est reconnu comme perime et ignore.
+class ConnectionTable {
+	private:
+		std::vector<ConnSlot>		_slots;
+		size_t						_live;		// connexions (hors listeners) en service
+		std::vector<void*>			_slabs;		// blocs bruts de CONN_SLAB_SIZE connexions
+		std::vector<Connection*>	_freeConns;	// emplacements libres des blocs
+
+		ConnectionTable(const ConnectionTable& cpy);
+		ConnectionTable& operator=(const ConnectionTable& src);
+
+		void		growSlab(void);
+
+	public:
+		ConnectionTable();
+		~ConnectionTable();
+
+		// slots
+		uint64_t	attach(int fd, Socket* sock, bool counted = true);
+		void		detach(int fd);
+		Socket*		lookup(uint64_t token) const;
+		Socket*		get(int fd) const;
+		uint64_t	tokenOf(int fd) const;
+		size_t		capacity(void) const;
+		size_t		liveConnections(void) const;
+
+		// slab
+		Connection*	createConnection(void);
+		void		destroyConnection(Connection* conn);
+
+		static uint64_t	makeToken(int fd, uint32_t gen);
+		static int		tokenFd(uint64_t token);
+		static uint32_t	tokenGen(uint64_t token);
+};
+
+#endif
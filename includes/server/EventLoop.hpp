@@ -0,0 +1,80 @@
+#ifndef EVENTLOOP_HPP
+# define EVENTLOOP_HPP
+
+# include <vector>
+# include <string>
+# include <poll.h>
+# include <stdint.h>
+
+// interets / etats remontes par le backend, independants de poll/epoll
+# define EV_READ	0x01
+# define EV_WRITE	0x02
+# define EV_HUP		0x04
+# define EV_ERROR	0x08
+# define EV_EDGE	0x10	// edge-triggered si le backend le permet (epoll), ignore sinon
+
+# define MAXEPOLLEVENTS	512	// evenements max rendus par un epoll_wait
+
+// un evenement pret : data est le jeton donne a add() (fd + generation, cf ConnectionTable)
+struct IoEvent {
+	int			fd;
+	int			events;
+	uint64_t	data;
+};
+
+// interface commune aux backends : Server::run ne connait que ca
+class EventLoop {
+	public:
+		virtual ~EventLoop();
+
+		virtual bool		add(int fd, int events, uint64_t data) = 0;
+		virtual bool		modify(int fd, int events, uint64_t data) = 0;
+		virtual void		remove(int fd) = 0;
+		// remplit out avec les fds prets, renvoie leur nombre (-1 si erreur)
+		virtual int			wait(std::vector<IoEvent>& out, int timeoutMs) = 0;
+		virtual const char*	name(void) const = 0;
+
+		// "epoll" ou "poll" ; epoll retombe sur poll hors Linux
+		static EventLoop*	create(const std::string& backend);
+};
+
+// backend poll() : tableau dense de pollfd, jetons en parallele, index par fd pour add/remove en O(1)
+class PollEventLoop : public EventLoop {
+	private:
+		std::vector<struct pollfd>	_pfds;
+		std::vector<uint64_t>		_data;
+		std::vector<int>			_index;	// fd -> position dans _pfds, -1 si absent
+
+	public:
+		PollEventLoop();
+		virtual ~PollEventLoop();
+
+		virtual bool		add(int fd, int events, uint64_t data);
+		virtual bool		modify(int fd, int events, uint64_t data);
+		virtual void		remove(int fd);
+		virtual int			wait(std::vector<IoEvent>& out, int timeoutMs);
+		virtual const char*	name(void) const;
+};
+
+# ifdef __linux__
+// backend epoll : le noyau ne renvoie que les fds prets, jeton stocke dans epoll_event.data.u64
+class EpollEventLoop : public EventLoop {
+	private:
+		int		_epfd;
+
+		EpollEventLoop(const EpollEventLoop& cpy);
+		EpollEventLoop& operator=(const EpollEventLoop& src);
+
+	public:
+		EpollEventLoop();
+		virtual ~EpollEventLoop();
+
+		virtual bool		add(int fd, int events, uint64_t data);
+		virtual bool		modify(int fd, int events, uint64_t data);
+		virtual void		remove(int fd);
+		virtual int			wait(std::vector<IoEvent>& out, int timeoutMs);
+		virtual const char*	name(void) const;
+};
+# endif
+
+#endif
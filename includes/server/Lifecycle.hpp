@@ -0,0 +1,35 @@
+#ifndef LIFECYCLE_HPP
+# define LIFECYCLE_HPP
+
+# include <vector>
+# include <string>
+# include <sys/types.h>
+
+# define LISTEN_FDS_ENV		"WEBSERV_LISTEN_FDS"	// "port:fd;port:fd;" : listeners herites de l'ancien binaire
+# define LC_MAX_WAKEUPS		1024	// boucles d'evenements reveillables par les signaux (une par Server)
+
+// evenements de vie du process, remontes par les signaux
+# define LC_UPGRADE		1	// SIGUSR2 : exec du nouveau binaire, puis drain
+# define LC_DRAIN		2	// SIGQUIT : arret propre, on finit les requetes en cours
+# define LC_RELOAD		4	// SIGHUP : relecture de la config
+
+// signaux -> self-pipes : le handler pose un drapeau et ecrit un octet dans le pipe de
+// chaque Server enregistre ; chaque boucle lit le sien et traite la demande hors du handler
+void	saveProgramArgs(int argc, char** argv);
+void	installLifecycleSignals(bool canUpgrade);
+int		registerLifecycleWakeup(void);
+void	unregisterLifecycleWakeup(int readFd);
+void	consumeLifecycleWakeup(int readFd);
+int		pendingLifecycle(void);
+bool	claimUpgrade(void);
+bool	claimReload(void);
+void	requestDrain(void);
+void	wakeLifecycleLoops(void);
+
+// remplacement du binaire : fork + exec du meme chemin avec les memes arguments,
+// les sockets d'ecoute (port, fd) passent par LISTEN_FDS_ENV
+pid_t	execNewBinary(const std::vector<std::pair<int, int> >& listeners);
+int		inheritedListenFd(int port);
+void	closeInheritedListeners(void);
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef MASTER_HPP
+# define MASTER_HPP
+
+# include "../webserv.hpp"
+# include <sys/types.h>
+# include <ctime>
+
+# define RESPAWN_DELAY	1	// secondes mini entre deux lancements d'un meme worker (evite une boucle de fork)
+
+// mode master/worker : le master ne sert aucune requete, il fork N workers qui ouvrent
+// chacun leurs sockets d'ecoute en SO_REUSEPORT, puis les surveille et relance ceux qui meurent.
+// SIGUSR2 : lance le nouveau binaire (ses workers se lient aux memes ports) puis vide les anciens ;
+// SIGQUIT : vide les workers (requetes en cours terminees) et sort ;
+// SIGHUP : relit la config (refusee si invalide) et la fait relire a chaque worker
+class Master
+{
+private:
+    GlobalConfig*           _config;
+    std::string             _backend;
+    int                     _nbWorkers;
+    std::map<pid_t, int>    _workers;//pid -> numero du worker
+    std::vector<time_t>     _lastSpawn;//dernier lancement de chaque worker
+
+    Master(const Master& cpy);
+    Master& operator=(const Master& src);
+
+    pid_t   spawnWorker(int slot);
+    void    stopWorkers(void);
+    void    drainWorkers(void);
+
+public:
+    Master(GlobalConfig* config, const std::string& backend);
+    ~Master();
+
+    void    run(void);
+    int     getNbWorkers(void) const;
+};
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef OUTPUTQUEUE_HPP
+# define OUTPUTQUEUE_HPP
+
+# include <deque>
+# include <string>
+# include <vector>
+# include <sys/types.h>
+
+# define OUTQ_IOV_MAX	64	// segments memoire envoyes par un seul writev
+
+// resultat d'un flush
+# define FLUSH_DONE		0	// file vide, tout est parti
+# define FLUSH_AGAIN	1	// socket plein (EAGAIN) : attendre EV_WRITE
+# define FLUSH_ERROR	-1	// erreur d'ecriture : fermer la connexion
+
+// un morceau de reponse : soit en memoire (en-tetes, corps), soit une plage de fichier
+struct OutSegment {
+	std::string			text;	// bloc d'en-tetes (repris par swap)
+	std::vector<char>	bytes;	// corps deja en memoire (repris par swap)
+	int					fd;		// -1 : segment memoire ; sinon fichier possede par le segment
+	off_t				offset;	// debut de la plage dans le fichier
+	size_t				length;	// taille du segment
+
+	OutSegment() : fd(-1), offset(0), length(0) {}
+};
+
+// file de sortie d'une connexion : les segments sont envoyes dans l'ordre, le curseur
+// dit ou on en est dans le premier ; une ecriture partielle avance juste le curseur
+class OutputQueue {
+	private:
+		std::deque<OutSegment>	_segs;
+		size_t					_cursor;	// octets deja ecrits du segment de tete
+		size_t					_pending;	// octets restant a ecrire dans toute la file
+
+		OutputQueue(const OutputQueue& cpy);
+		OutputQueue& operator=(const OutputQueue& src);
+
+		void	advance(size_t n);
+		void	popFront(void);
+		ssize_t	sendFileRange(int sockfd, OutSegment& seg);
+
+	public:
+		OutputQueue();
+		~OutputQueue();
+
+		void	pushText(std::string& text);
+		void	pushBytes(std::vector<char>& bytes);
+		void	pushFile(int fd, off_t offset, size_t length);
+
+		int		flush(int sockfd);
+		void	clear(void);
+		bool	empty(void) const;
+		size_t	pending(void) const;
+};
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef RATELIMITER_HPP
+# define RATELIMITER_HPP
+
+# include <string>
+# include <vector>
+# include <stdint.h>
+
+# define RATE_TABLE_BITS	14
+# define RATE_TABLE_SIZE	(1 << RATE_TABLE_BITS)	// 16384 couples (ip, location) suivis, memoire fixe
+# define RATE_PROBE_LIMIT	8						// cases examinees par recherche (adressage ouvert)
+# define RATE_TOKEN			1000					// un jeton = une requete, en millijetons
+
+// seau a jetons d'un client pour une location
+struct RateEntry {
+	uint32_t		ip;
+	uint32_t		zone;	// location (port + chemin) : ses limites sont independantes
+	long			tokens;	// millijetons disponibles
+	unsigned long	lastMs;	// dernier remplissage
+	unsigned char	ref;	// bit de l'horloge : utilise depuis le dernier passage de l'aiguille
+	bool			used;
+
+	RateEntry() : ip(0), zone(0), tokens(0), lastMs(0), ref(0), used(false) {}
+};
+
+// limit_req : table de hachage a adressage ouvert, taille fixe quel que soit le nombre de clients.
+// Une recherche regarde RATE_PROBE_LIMIT cases ; si aucune n'est libre, l'algorithme de l'horloge
+// (seconde chance) y choisit une victime. Une table par reacteur (membre du Server), sans verrou :
+// la limite s'applique par reacteur, comme elle s'applique deja par worker. Un client dont les
+// connexions tombent sur N reacteurs peut donc obtenir jusqu'a N fois rate
+class RateLimiter {
+	private:
+		std::vector<RateEntry>	_entries;//RATE_TABLE_SIZE cases, hors de la pile du thread
+		unsigned long			_evictions;
+
+		RateLimiter(const RateLimiter& cpy);
+		RateLimiter& operator=(const RateLimiter& src);
+
+		RateEntry*	findOrEvict(uint32_t ip, uint32_t zone, bool& fresh);
+
+	public:
+		RateLimiter();
+		~RateLimiter();
+
+		unsigned long	check(uint32_t ip, uint32_t zone, int rate, int burst, unsigned long nowMs);
+		unsigned long	evictions(void) const;
+
+		static uint32_t	zoneId(int port, const std::string& path);
+};
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef REACTORPOOL_HPP
+# define REACTORPOOL_HPP
+
+# include "../webserv.hpp"
+# include <pthread.h>
+
+// mode threads : N reacteurs dans le meme process, chacun avec son propre Server
+// (boucle d'evenements, table de connexions, buffers, sockets d'ecoute SO_REUSEPORT).
+// Rien n'est partage en ecriture : la GlobalConfig est lue seulement, donc aucun verrou
+// sur le chemin d'une requete ; le noyau repartit les connexions entre les threads.
+class ReactorPool
+{
+private:
+    GlobalConfig*           _config;
+    std::string             _backend;
+    int                     _nbThreads;
+    std::vector<pthread_t>  _threads;
+
+    ReactorPool(const ReactorPool& cpy);
+    ReactorPool& operator=(const ReactorPool& src);
+
+    static void*    reactorMain(void* arg);
+
+public:
+    ReactorPool(GlobalConfig* config, const std::string& backend);
+    ~ReactorPool();
+
+    void    run(void);
+    int     getNbThreads(void) const;
+};
+
+#endif
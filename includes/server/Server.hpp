@@ -3,43 +3,75 @@
 
 # include "../webserv.hpp"
 # include "Socket.hpp"
+# include "Connection.hpp"
+# include "EventLoop.hpp"
+# include "TimerWheel.hpp"
+# include "ConnectionTable.hpp"
+# include "BufferPool.hpp"
+# include "Lifecycle.hpp"
+# include "ConfigSnapshot.hpp"
+# include "../http/RequestDispatcher.hpp"
+# include <ctime>
 
 class Server
 {
 private://ne doit pas etre lancé sans parametre
 
     std::vector<Socket*>         _listenSockets;
-	Socket				        _listenSocket;
-	struct addrinfo		        _hints;
-	struct addrinfo*	        _servinfo;
-	int					        _fd_n;
-	int					        _fd_max;
-	struct pollfd   	    	*_pfds;
-	ServerConfig*						_config;
-    std::map<int, Connection*>  _connections;
-
-
-
-
+    ConfigSnapshot*             _snapshot;//config courante (reference comptee), remplacee au SIGHUP
+	GlobalConfig*				_config;//= &_snapshot->config
+    EventLoop*                  _loop;//epoll ou poll, meme interface
+    ConnectionTable             _table;//fd -> listener/connexion, proprietaire des connexions (slab)
+    std::vector<IoEvent>        _events;
+    BufferPool                  _rxPool;//blocs de reception, pretes aux connexions le temps d'une lecture
+    TimerWheel                  _timers;//delais des connexions (en-tete, corps, keep-alive)
+    std::vector<void*>          _expired;
+    bool                        _reusePort;//listeners propres au thread/worker : rien a transmettre a l'upgrade
+    bool                        _draining;//n'accepte plus, sort de run() quand la derniere connexion ferme
+    int                         _wakeFd;//self-pipe des signaux (upgrade, drain), -1 si indisponible
+    Socket*                     _wakeSock;//sa case dans la table
+    AdmissionStats              _admission;//worker_connections / max_pending_requests, et leurs compteurs
+    AdmissionStats              _lastReport;//compteurs a la derniere ligne de log
+    RateLimiter                 _rateLimiter;//limit_req, propre au reacteur : aucun verrou sur la requete
+    unsigned long               _wakeups;//retours de wait() dans la seconde en cours
+    unsigned long               _wakeupsPerSec;//valeur de la derniere seconde complete
+    time_t                      _wakeupsSec;
 
+    Server(const Server& cpy);
+    Server& operator=(const Server& src);
 
 public:
-    Server(ServerConfig *config);
+    Server(GlobalConfig *config, const std::string& backend = "epoll", bool reusePort = false);
     virtual ~Server();
 
     //methode principale
     void run();
 
     //methodes associees
-    void	closeConect(int i);
-    Socket*    checkListen(int fd);
+    void	closeConect(Connection* conn);
     void	makeNewConect(Socket* listenSock);
-    void	readConect(int i);
-    void    manageRespond(int i);
-    void	addConect(int newfd, Connection* new_conn);
+    bool	readConect(Connection* conn, bool peerClosed);
+    bool    manageRespond(Connection* conn);
+    bool    lingerConect(Connection* conn);
+    bool    drainLingering(Connection* conn);
+    bool	addConect(int newfd, Connection* new_conn);
+    void    updateInterest(Connection* conn);
+    void    updateTimer(Connection* conn);
+    void    expireTimers(void);
+    void    countWakeup(void);
+    void    handleLifecycle(void);
+    void    startDrain(void);
+    void    syncListeners(bool initial);
+    void    syncPending(Connection* conn);
+    void    refuseConnection(int fd);
+    void    reportAdmission(void);
+    const AdmissionStats&   getAdmissionStats(void) const;
+    void    adoptConfig(void);
+    bool    rebindConfig(Connection* conn);
+    unsigned long   getWakeupsPerSecond(void) const;
     void*	get_in_addr(struct sockaddr *sa);
 };
 
 
 
-#endif
\ No newline at end of file
+#endif
@@ -2,7 +2,7 @@
 # define SOCKET_HPP
 
 # include "divers.hpp"
-# include "ServerStructures.hpp"
+# include "../config/ServerStructures.hpp"
 
 class Socket {
 	private:
@@ -10,7 +10,8 @@ class Socket {
 		socklen_t				_sin_size;
 		struct sockaddr_storage	_addr;
         std::string             _port;
-        ServerStruct*            _server_block;
+        ServerConfig*           _server_block;
+        bool                    _listening;
 
 	public:
 		// Constructors
@@ -20,21 +21,24 @@ class Socket {
 		Socket& operator=(const Socket& src);
 
 		// Methods
-		void	createSocket(int ai_family, int ai_socktype, int ai_protocol);
+		void	createSocket(int ai_family, int ai_socktype, int ai_protocol, bool reusePort = false);
 		void	bindSocket(struct sockaddr* ai_addr, socklen_t ai_addrlen);
 		void	listenOnSocket(void);
 		void	acceptConnection(int listenSock);
 		void	printConnection(void);
-		void	initListenSocket(const char* port);
+		void	initListenSocket(const char* port, bool reusePort = false);
+		void	adoptListenSocket(int fd);
         void    closeSocket(void);
+        void    setNonBlocking(void);
 
 		int		        getSocketFD(void);
         int             getPort(void);
-        ServerStruct*    getServerBlock(void);
+        ServerConfig*   getServerBlock(void);
+        bool            isListener(void) const;
 
         void    setSocketFD(int fd);
         void    setPortFD(std::string port);
-        void    setServerBlock(ServerStruct* sb);
+        void    setServerBlock(ServerConfig* sb);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,54 @@
+#ifndef TIMERWHEEL_HPP
+# define TIMERWHEEL_HPP
+
+# include <vector>
+# include <cstddef>
+
+# define TIMER_TICK_MS		100	// resolution de la roue
+# define TIMER_LEVELS		4	// 4 niveaux de 64 cases : 64^4 ticks, ~19 jours a 100 ms
+# define TIMER_SLOT_BITS	6
+# define TIMER_SLOTS		(1 << TIMER_SLOT_BITS)
+# define TIMER_SLOT_MASK	(TIMER_SLOTS - 1)
+
+// noeud intrusif : vit dans l'objet surveille (Connection), aucune allocation par timer
+struct TimerNode {
+	TimerNode*		prev;
+	TimerNode*		next;
+	unsigned long	expires;	// tick d'expiration
+	void*			owner;		// rendu a l'expiration
+
+	TimerNode() : prev(NULL), next(NULL), expires(0), owner(NULL) {}
+	bool	pending(void) const { return (next != NULL); }
+};
+
+// roue hierarchique : niveau 0 = un tick par case, chaque niveau suivant couvre 64x plus.
+// ajout/retrait en O(1) ; un tick vide une case du niveau 0 et, tous les 64 ticks,
+// redescend une case du niveau du dessus (cascade) : cout independant du nombre de timers
+class TimerWheel {
+	private:
+		TimerNode		_slots[TIMER_LEVELS][TIMER_SLOTS];	// sentinelles des listes circulaires
+		unsigned long	_tickMs;
+		unsigned long	_current;	// prochain tick a traiter
+		size_t			_count;
+
+		TimerWheel(const TimerWheel& cpy);
+		TimerWheel& operator=(const TimerWheel& src);
+
+		void	insert(TimerNode* node);
+		void	cascade(int level, int index);
+		void	runTick(std::vector<void*>& expired);
+
+	public:
+		TimerWheel(unsigned long tickMs = TIMER_TICK_MS);
+		~TimerWheel();
+
+		void	schedule(TimerNode* node, unsigned long delayMs, void* owner);
+		void	cancel(TimerNode* node);
+		void	advance(unsigned long nowMs, std::vector<void*>& expired);
+		int		nextTimeoutMs(unsigned long nowMs) const;
+		size_t	size(void) const;
+
+		static unsigned long	nowMs(void);
+};
+
+#endif
@@ -2,12 +2,22 @@
 # define DIVERS_HPP
 
 # define MAXEVENTS 25
-# define BUFF_SIZE 2000
 # define OK 200
-# define BACKLOG 25 
+# define BACKLOG 511 
+# define DEFAULT_CONF "configs/basic.conf"
 
 # include <typeinfo>
 # include <poll.h>
 # include <iostream>
+# include <string>
+# include <vector>
+# include <map>
+# include <cstring>
+# include <cerrno>
+# include <unistd.h>
+# include <fcntl.h>
+# include <netdb.h>
+# include <arpa/inet.h>
+# include <sys/socket.h>
 
-#endif
\ No newline at end of file
+#endif
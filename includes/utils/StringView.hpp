@@ -0,0 +1,45 @@
+#ifndef STRING_VIEW_HPP
+# define STRING_VIEW_HPP
+
+#include <cstddef>
+#include <string>
+#include <ostream>
+
+// Read-only (pointer, length) view on bytes owned by someone else: no copy, no allocation.
+// The view is only valid as long as the bytes it points to; str() makes an owning copy.
+class StringView {
+private:
+    const char* _data;
+    size_t      _size;
+
+public:
+    static const size_t npos = static_cast<size_t>(-1);
+
+    StringView();
+    StringView(const char* data, size_t size);
+    StringView(const char* cstr);           // implicit: view == "GET"
+    StringView(const std::string& str);     // implicit: view == someString
+
+    const char* data() const;
+    size_t size() const;
+    bool empty() const;
+    char operator[](size_t i) const;
+
+    // Owning copy, for values that must outlive the viewed bytes
+    std::string str() const;
+
+    bool equals(const StringView& other) const;
+    // Case-insensitive comparison (ASCII), as header names require
+    bool iequals(const StringView& other) const;
+    bool startsWith(const StringView& prefix) const;
+
+    size_t find(char c, size_t pos = 0) const;
+    size_t rfind(char c) const;
+    StringView substr(size_t pos, size_t n = npos) const;
+};
+
+bool operator==(const StringView& a, const StringView& b);
+bool operator!=(const StringView& a, const StringView& b);
+std::ostream& operator<<(std::ostream& os, const StringView& view);
+
+#endif // STRING_VIEW_HPP
@@ -4,13 +4,16 @@
 # include <iostream>
 
 // Classes
-# include "Config.hpp"
-# include "server/Server.hpp"
+# include "config/ServerStructures.hpp"
 # include "server/divers.hpp"
-# include "Request.hpp"
-# include "Response.hpp"
+# include "server/EventLoop.hpp"
 # include "server/Uri.hpp"
 # include "server/Socket.hpp"
-# include "Connection.hpp"
+# include "server/Connection.hpp"
+# include "server/Server.hpp"
+# include "server/Master.hpp"
+# include "server/Lifecycle.hpp"
+# include "server/ConfigSnapshot.hpp"
+# include "server/ReactorPool.hpp"
 
-#endif
\ No newline at end of file
+#endif
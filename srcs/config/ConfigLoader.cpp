@@ -22,11 +22,25 @@ ConfigLoader::~ConfigLoader() {}
 
 /**
  * @brief Main function to load the entire server configuration from the AST.
- * @param astNodes A vector of ASTnode pointers, expected to contain only BlockNode representing 'server' blocks.
+ * @param astNodes A vector of ASTnode pointers, expected to contain 'server' blocks and global directives.
  * @return A vector of ServerConfig objects, each representing a fully loaded server configuration.
  * @throws ConfigLoadError if any semantic errors are found in the configuration.
  */
 std::vector<ServerConfig>   ConfigLoader::loadConfig(const std::vector<ASTnode *> & astNodes)
+{
+	GlobalConfig    globalConfig;
+
+	loadConfig(astNodes, globalConfig);
+	return globalConfig.servers;
+}
+
+/**
+ * @brief Loads the server blocks and the global (main context) directives from the AST.
+ * @param astNodes A vector of ASTnode pointers: 'server' blocks and global directives.
+ * @param globalConfig The GlobalConfig object to fill.
+ * @throws ConfigLoadError if any semantic errors are found in the configuration.
+ */
+void    ConfigLoader::loadConfig(const std::vector<ASTnode *> & astNodes, GlobalConfig& globalConfig)
 {
 	std::vector<ServerConfig>   loadedServers;
 
@@ -44,9 +58,8 @@ std::vector<ServerConfig>   ConfigLoader::loadConfig(const std::vector<ASTnode *
 		} else {
 			DirectiveNode* directiveNode = dynamic_cast<DirectiveNode *>(node);
 
-			if (directiveNode) { // check if it's a wrong directive node
-				 error("Unexpected directive '" + directiveNode->name + "' at top level. Expected 'server' block.",
-					   directiveNode->line, directiveNode->column);
+			if (directiveNode) { // global directive, rejected by processDirective if it is not one
+				processDirective(directiveNode, globalConfig);
 			} else { // should never happen
 				 error("Unknown AST node type encountered at top level.", node->line, node->column);
 			}
@@ -58,7 +71,7 @@ std::vector<ServerConfig>   ConfigLoader::loadConfig(const std::vector<ASTnode *
 	// but it's a final safeguard.
 		error("No valid server blocks found in configuration.", 0, 0); // Line/col 0 for general error
 	}
-	return loadedServers;
+	globalConfig.servers = loadedServers;
 }
 
 // --- Private Helper Functions for Parsing Blocks ---
@@ -126,6 +139,7 @@ LocationConfig    ConfigLoader::parseLocationBlock(const BlockNode * locationBlo
 	locationConf.autoindex = parentServerDefaults.autoindex;
 	locationConf.errorPages = parentServerDefaults.errorPages;
 	locationConf.clientMaxBodySize = parentServerDefaults.clientMaxBodySize;
+	locationConf.clientBodyBufferSize = parentServerDefaults.clientBodyBufferSize;
 
 	// --- Step 2: Load the location block's own arguments (path and matchType) ---
 	if (locationBlockNode->args.empty()) {
@@ -211,12 +225,15 @@ LocationConfig    ConfigLoader::parseLocationBlock(const BlockNode * locationBlo
 	locationConf.autoindex = parentLocationDefaults.autoindex;
 	locationConf.errorPages = parentLocationDefaults.errorPages;
 	locationConf.clientMaxBodySize = parentLocationDefaults.clientMaxBodySize;
+	locationConf.clientBodyBufferSize = parentLocationDefaults.clientBodyBufferSize;
 	locationConf.allowedMethods = parentLocationDefaults.allowedMethods; // Location-specific methods also inherit.
 	locationConf.uploadEnabled = parentLocationDefaults.uploadEnabled;
 	locationConf.uploadStore = parentLocationDefaults.uploadStore;
 	locationConf.cgiExecutables = parentLocationDefaults.cgiExecutables; // Inherit CGI settings
 	locationConf.returnCode = parentLocationDefaults.returnCode;
 	locationConf.returnUrlOrText = parentLocationDefaults.returnUrlOrText;
+	locationConf.limitReqRate = parentLocationDefaults.limitReqRate;
+	locationConf.limitReqBurst = parentLocationDefaults.limitReqBurst;
 
 	// --- Step 2: Load the location block's own arguments (path and matchType) ---
 	// This logic is identical to the other overload as it's about the block's own definition.
@@ -288,6 +305,31 @@ LocationConfig    ConfigLoader::parseLocationBlock(const BlockNode * locationBlo
 
 // --- Private Dispatcher Functions for Directives ---
 
+/**
+ * @brief Dispatches a top-level DirectiveNode to the appropriate handler for GlobalConfig.
+ * @param directive The DirectiveNode to process.
+ * @param globalConfig The GlobalConfig object to modify.
+ * @throws ConfigLoadError if the directive is not allowed at top level.
+ */
+void ConfigLoader::processDirective(const DirectiveNode* directive, GlobalConfig& globalConfig) {
+	const std::string& name = directive->name;
+
+	if (name == "worker_processes") {
+		handleWorkerProcessesDirective(directive, globalConfig);
+	} else if (name == "worker_threads") {
+		handleWorkerThreadsDirective(directive, globalConfig);
+	} else if (name == "accept_batch") {
+		handleAcceptBatchDirective(directive, globalConfig);
+	} else if (name == "worker_connections") {
+		handleWorkerConnectionsDirective(directive, globalConfig);
+	} else if (name == "max_pending_requests") {
+		handleMaxPendingRequestsDirective(directive, globalConfig);
+	} else {
+		error("Unexpected directive '" + name + "' at top level. Expected 'server' block or a global directive.",
+			  directive->line, directive->column);
+	}
+}
+
 /**
  * @brief Dispatches a DirectiveNode to the appropriate handler for ServerConfig.
  * @param directive The DirectiveNode to process.
@@ -304,6 +346,16 @@ void ConfigLoader::processDirective(const DirectiveNode* directive, ServerConfig
 		handleServerNameDirective(directive, serverConfig);
 	} else if (name == "error_log") {
 		handleErrorLogDirective(directive, serverConfig);
+	} else if (name == "keepalive_timeout") {
+		handleKeepaliveTimeoutDirective(directive, serverConfig);
+	} else if (name == "keepalive_requests") {
+		handleKeepaliveRequestsDirective(directive, serverConfig);
+	} else if (name == "client_header_timeout") {
+		handleClientHeaderTimeoutDirective(directive, serverConfig);
+	} else if (name == "client_body_timeout") {
+		handleClientBodyTimeoutDirective(directive, serverConfig);
+	} else if (name == "large_client_header_buffers") {
+		handleLargeClientHeaderBuffersDirective(directive, serverConfig);
 	} 
 	// Directives common to both Server and Location contexts
 	else if (name == "root") {
@@ -316,6 +368,8 @@ void ConfigLoader::processDirective(const DirectiveNode* directive, ServerConfig
 		handleErrorPageDirective(directive, serverConfig);
 	} else if (name == "client_max_body_size") {
 		handleClientMaxBodySizeDirective(directive, serverConfig);
+	} else if (name == "client_body_buffer_size") {
+		handleClientBodyBufferSizeDirective(directive, serverConfig);
 	}
 	// If a directive name is recognized by the parser but not handled here, or
 	// if it's a directive specifically for location blocks, it's an error.
@@ -345,6 +399,8 @@ void ConfigLoader::processDirective(const DirectiveNode* directive, LocationConf
 		handleErrorPageDirective(directive, locationConfig);
 	} else if (name == "client_max_body_size") {
 		handleClientMaxBodySizeDirective(directive, locationConfig);
+	} else if (name == "client_body_buffer_size") {
+		handleClientBodyBufferSizeDirective(directive, locationConfig);
 	}
 	// Location-specific directives
 	else if (name == "allowed_methods") {
@@ -359,6 +415,8 @@ void ConfigLoader::processDirective(const DirectiveNode* directive, LocationConf
 		handleCgiPathDirective(directive, locationConfig);
 	} else if (name == "return") {
 		handleReturnDirective(directive, locationConfig);
+	} else if (name == "limit_req") {
+		handleLimitReqDirective(directive, locationConfig);
 	}
 	// If a directive name is recognized by the parser but not handled here, or
 	// if it's a directive specifically for server blocks, it's an error.
@@ -371,6 +429,58 @@ void ConfigLoader::processDirective(const DirectiveNode* directive, LocationConf
 
 // --- Private Helper Functions for Directive Processing (Detailed Implementations) ---
 
+// --- Global Handlers ---
+
+/**
+ * @brief Handles the 'worker_processes' directive for the GlobalConfig.
+ * @param directive The 'worker_processes' DirectiveNode.
+ * @param globalConfig The GlobalConfig object to update.
+ * @throws ConfigLoadError if the argument is not a positive number or 'auto'.
+ */
+void ConfigLoader::handleWorkerProcessesDirective(const DirectiveNode* directive, GlobalConfig& globalConfig) {
+	globalConfig.workerProcesses = parseWorkerCount(directive);
+}
+
+/**
+ * @brief Handles the 'worker_threads' directive for the GlobalConfig.
+ * @param directive The 'worker_threads' DirectiveNode.
+ * @param globalConfig The GlobalConfig object to update.
+ * @throws ConfigLoadError if the argument is not a positive number or 'auto'.
+ */
+void ConfigLoader::handleWorkerThreadsDirective(const DirectiveNode* directive, GlobalConfig& globalConfig) {
+	globalConfig.workerThreads = parseWorkerCount(directive);
+}
+
+/**
+ * @brief Handles the 'accept_batch' directive for the GlobalConfig.
+ * @param directive The 'accept_batch' DirectiveNode.
+ * @param globalConfig The GlobalConfig object to update.
+ * @throws ConfigLoadError if the argument is not a number in 1-65536.
+ */
+void ConfigLoader::handleAcceptBatchDirective(const DirectiveNode* directive, GlobalConfig& globalConfig) {
+	globalConfig.acceptBatch = static_cast<int>(parseCountArgument(directive, 1, 65536));
+}
+
+/**
+ * @brief Handles the 'worker_connections' directive for the GlobalConfig.
+ * @param directive The 'worker_connections' DirectiveNode.
+ * @param globalConfig The GlobalConfig object to update.
+ * @throws ConfigLoadError if the argument is not a number in 1-1048576.
+ */
+void ConfigLoader::handleWorkerConnectionsDirective(const DirectiveNode* directive, GlobalConfig& globalConfig) {
+	globalConfig.workerConnections = static_cast<int>(parseCountArgument(directive, 1, 1048576));
+}
+
+/**
+ * @brief Handles the 'max_pending_requests' directive for the GlobalConfig.
+ * @param directive The 'max_pending_requests' DirectiveNode.
+ * @param globalConfig The GlobalConfig object to update.
+ * @throws ConfigLoadError if the argument is not a number in 0-1048576 (0 = unlimited).
+ */
+void ConfigLoader::handleMaxPendingRequestsDirective(const DirectiveNode* directive, GlobalConfig& globalConfig) {
+	globalConfig.maxPendingRequests = static_cast<int>(parseCountArgument(directive, 0, 1048576));
+}
+
 // --- Server-Specific Handlers ---
 
 /**
@@ -503,6 +613,105 @@ void ConfigLoader::handleErrorLogDirective(const DirectiveNode* directive, Serve
 	// If only one argument, errorLogLevel remains its default value (DEFAULT_LOG from constructor).
 }
 
+/**
+ * @brief Handles the 'keepalive_timeout' directive for a ServerConfig.
+ * @param directive The 'keepalive_timeout' DirectiveNode.
+ * @param serverConfig The ServerConfig object to update.
+ * @throws ConfigLoadError if the time is invalid.
+ */
+void ConfigLoader::handleKeepaliveTimeoutDirective(const DirectiveNode* directive, ServerConfig& serverConfig) {
+	serverConfig.keepaliveTimeout = parseTimeDirective(directive); // 0 disables keep-alive.
+}
+
+/**
+ * @brief Handles the 'keepalive_requests' directive for a ServerConfig.
+ * @param directive The 'keepalive_requests' DirectiveNode.
+ * @param serverConfig The ServerConfig object to update.
+ * @throws ConfigLoadError if the argument is not a positive number.
+ */
+void ConfigLoader::handleKeepaliveRequestsDirective(const DirectiveNode* directive, ServerConfig& serverConfig) {
+	const std::vector<std::string>& args = directive->args;
+
+	if (args.size() != 1) {
+		error("Directive 'keepalive_requests' requires exactly one argument (number of requests).",
+			  directive->line, directive->column);
+	}
+	try {
+		if (!StringUtils::isDigits(args[0])) {
+			throw std::invalid_argument("Argument must be a number.");
+		}
+		long requests = StringUtils::stringToLong(args[0]);
+		if (requests < 1) {
+			throw std::out_of_range("Number of requests must be at least 1.");
+		}
+		serverConfig.keepaliveRequests = requests;
+	} catch (const std::invalid_argument& e) {
+		error("Invalid keepalive_requests value. " + std::string(e.what()), directive->line, directive->column);
+	} catch (const std::out_of_range& e) {
+		error("keepalive_requests directive: " + std::string(e.what()), directive->line, directive->column);
+	}
+}
+
+/**
+ * @brief Handles the 'client_header_timeout' directive for a ServerConfig.
+ * @param directive The 'client_header_timeout' DirectiveNode.
+ * @param serverConfig The ServerConfig object to update.
+ * @throws ConfigLoadError if the time is invalid or zero.
+ */
+void ConfigLoader::handleClientHeaderTimeoutDirective(const DirectiveNode* directive, ServerConfig& serverConfig) {
+	serverConfig.clientHeaderTimeout = parseTimeDirective(directive);
+	if (serverConfig.clientHeaderTimeout == 0) {
+		error("Directive 'client_header_timeout' cannot be 0.", directive->line, directive->column);
+	}
+}
+
+/**
+ * @brief Handles the 'client_body_timeout' directive for a ServerConfig.
+ * @param directive The 'client_body_timeout' DirectiveNode.
+ * @param serverConfig The ServerConfig object to update.
+ * @throws ConfigLoadError if the time is invalid or zero.
+ */
+void ConfigLoader::handleClientBodyTimeoutDirective(const DirectiveNode* directive, ServerConfig& serverConfig) {
+	serverConfig.clientBodyTimeout = parseTimeDirective(directive);
+	if (serverConfig.clientBodyTimeout == 0) {
+		error("Directive 'client_body_timeout' cannot be 0.", directive->line, directive->column);
+	}
+}
+
+/**
+ * @brief Handles the 'large_client_header_buffers' directive for a ServerConfig.
+ * @param directive The 'large_client_header_buffers' DirectiveNode (number, then size with optional unit).
+ * @param serverConfig The ServerConfig object to update.
+ * @throws ConfigLoadError if the number is not in 1-1024 or the size not in 1k-1m.
+ */
+void ConfigLoader::handleLargeClientHeaderBuffersDirective(const DirectiveNode* directive, ServerConfig& serverConfig) {
+	const std::vector<std::string>& args = directive->args;
+
+	if (args.size() != 2) {
+		error("Directive 'large_client_header_buffers' requires exactly two arguments (number and size).",
+			  directive->line, directive->column);
+	}
+	try {
+		if (!StringUtils::isDigits(args[0])) {
+			throw std::invalid_argument("Number of buffers must be a number.");
+		}
+		long count = StringUtils::stringToLong(args[0]);
+		long size = parseSizeToBytes(args[1]);
+		if (count < 1 || count > 1024) {
+			throw std::out_of_range("Number of buffers must be between 1 and 1024.");
+		}
+		if (size < 1024 || size > 1024 * 1024) {
+			throw std::out_of_range("Buffer size must be between 1k and 1m.");
+		}
+		serverConfig.largeHeaderBuffers = count;
+		serverConfig.largeHeaderBufferSize = size;
+	} catch (const std::invalid_argument& e) {
+		error("Invalid large_client_header_buffers value. " + std::string(e.what()), directive->line, directive->column);
+	} catch (const std::out_of_range& e) {
+		error("large_client_header_buffers directive: " + std::string(e.what()), directive->line, directive->column);
+	}
+}
+
 // --- Common Directives (Overloaded Handlers) ---
 
 /**
@@ -763,6 +972,54 @@ void ConfigLoader::handleClientMaxBodySizeDirective(const DirectiveNode* directi
 	}
 }
 
+/**
+ * @brief Handles the 'client_body_buffer_size' directive for a ServerConfig.
+ * @param directive The 'client_body_buffer_size' DirectiveNode.
+ * @param serverConfig The ServerConfig object to update.
+ * @throws ConfigLoadError if arguments are invalid.
+ */
+void ConfigLoader::handleClientBodyBufferSizeDirective(const DirectiveNode* directive, ServerConfig& serverConfig) {
+	const std::vector<std::string>& args = directive->args;
+
+	if (args.size() != 1) {
+		error("Directive 'client_body_buffer_size' requires exactly one argument (size with optional units).",
+			  directive->line, directive->column);
+	}
+	try {
+		serverConfig.clientBodyBufferSize = parseSizeToBytes(args[0]);
+	} catch (const std::invalid_argument& e) {
+		error("Invalid client_body_buffer_size format: " + std::string(e.what()),
+			  directive->line, directive->column);
+	} catch (const std::out_of_range& e) {
+		error("Client_body_buffer_size value " + std::string(e.what()),
+			  directive->line, directive->column);
+	}
+}
+
+/**
+ * @brief Handles the 'client_body_buffer_size' directive for a LocationConfig.
+ * @param directive The 'client_body_buffer_size' DirectiveNode.
+ * @param locationConfig The LocationConfig object to update.
+ * @throws ConfigLoadError if arguments are invalid.
+ */
+void ConfigLoader::handleClientBodyBufferSizeDirective(const DirectiveNode* directive, LocationConfig& locationConfig) {
+	const std::vector<std::string>& args = directive->args;
+
+	if (args.size() != 1) {
+		error("Directive 'client_body_buffer_size' requires exactly one argument (size with optional units).",
+			  directive->line, directive->column);
+	}
+	try {
+		locationConfig.clientBodyBufferSize = parseSizeToBytes(args[0]); // Overrides inherited value.
+	} catch (const std::invalid_argument& e) {
+		error("Invalid client_body_buffer_size format: " + std::string(e.what()),
+			  directive->line, directive->column);
+	} catch (const std::out_of_range& e) {
+		error("Client_body_buffer_size value " + std::string(e.what()),
+			  directive->line, directive->column);
+	}
+}
+
 // --- Location-Specific Handlers ---
 
 /**
@@ -1061,6 +1318,166 @@ long ConfigLoader::parseSizeToBytes(const std::string& sizeStr) const {
 	return value * multiplier;
 }
 
+/**
+ * @brief Parses the argument of 'worker_processes' / 'worker_threads'.
+ * @param directive The DirectiveNode holding a single count or 'auto'.
+ * @return The count (1-1024), or 0 for 'auto' (resolved to the number of online CPUs at startup).
+ * @throws ConfigLoadError if the argument is not a positive number or 'auto'.
+ */
+int ConfigLoader::parseWorkerCount(const DirectiveNode* directive) const {
+	const std::vector<std::string>& args = directive->args;
+
+	if (args.size() != 1) {
+		error("Directive '" + directive->name + "' requires exactly one argument.", directive->line, directive->column);
+	}
+	if (args[0] == "auto") {
+		return 0;
+	}
+	try {
+		if (!StringUtils::isDigits(args[0])) {
+			throw std::invalid_argument("Argument must be a number or 'auto'.");
+		}
+		long count = StringUtils::stringToLong(args[0]);
+		if (count < 1 || count > 1024) {
+			throw std::out_of_range("Value out of valid range (1-1024).");
+		}
+		return static_cast<int>(count);
+	} catch (const std::invalid_argument& e) {
+		error("Invalid " + directive->name + " value. " + std::string(e.what()), directive->line, directive->column);
+	} catch (const std::out_of_range& e) {
+		error(directive->name + " directive: " + std::string(e.what()), directive->line, directive->column);
+	}
+	return 1; // Not reached: error() throws.
+}
+
+/**
+ * @brief Handles the 'limit_req' directive for a LocationConfig.
+ * Syntax: limit_req <rate> [burst]; -> <rate> requests per second per client address,
+ * with up to [burst] extra requests accepted at once (token bucket of size burst + 1).
+ * The limit is applied per reactor: each thread or worker process keeps its own table.
+ * @param directive The 'limit_req' DirectiveNode.
+ * @param locationConfig The LocationConfig object to update.
+ * @throws ConfigLoadError if the rate or the burst is not a number in range.
+ */
+void ConfigLoader::handleLimitReqDirective(const DirectiveNode* directive, LocationConfig& locationConfig) {
+	const std::vector<std::string>& args = directive->args;
+
+	if (args.empty() || args.size() > 2) {
+		error("Directive 'limit_req' requires a rate (requests per second) and an optional burst.",
+			  directive->line, directive->column);
+	}
+	try {
+		for (size_t i = 0; i < args.size(); ++i) {
+			if (!StringUtils::isDigits(args[i])) {
+				throw std::invalid_argument("Arguments must be numbers.");
+			}
+		}
+		long rate = StringUtils::stringToLong(args[0]);
+		long burst = (args.size() == 2) ? StringUtils::stringToLong(args[1]) : 0;
+		if (rate < 1 || rate > 100000 || burst < 0 || burst > 100000) {
+			throw std::out_of_range("Rate must be in 1-100000 and burst in 0-100000.");
+		}
+		locationConfig.limitReqRate = static_cast<int>(rate);
+		locationConfig.limitReqBurst = static_cast<int>(burst);
+	} catch (const std::invalid_argument& e) {
+		error("Invalid limit_req value. " + std::string(e.what()), directive->line, directive->column);
+	} catch (const std::out_of_range& e) {
+		error("limit_req directive: " + std::string(e.what()), directive->line, directive->column);
+	}
+}
+
+/**
+ * @brief Parses the single numeric argument of a counter directive (accept_batch, worker_connections...).
+ * @param directive The DirectiveNode holding one unsigned number.
+ * @param minValue Smallest accepted value.
+ * @param maxValue Largest accepted value.
+ * @return The parsed value.
+ * @throws ConfigLoadError if the argument is missing, not a number or out of range.
+ */
+long ConfigLoader::parseCountArgument(const DirectiveNode* directive, long minValue, long maxValue) const {
+	const std::vector<std::string>& args = directive->args;
+
+	if (args.size() != 1) {
+		error("Directive '" + directive->name + "' requires exactly one argument.", directive->line, directive->column);
+	}
+	try {
+		if (!StringUtils::isDigits(args[0])) {
+			throw std::invalid_argument("Argument must be a number.");
+		}
+		long value = StringUtils::stringToLong(args[0]);
+		if (value < minValue || value > maxValue) {
+			throw std::out_of_range("Value out of valid range (" + StringUtils::longToString(minValue) + "-"
+				+ StringUtils::longToString(maxValue) + ").");
+		}
+		return value;
+	} catch (const std::invalid_argument& e) {
+		error("Invalid " + directive->name + " value. " + std::string(e.what()), directive->line, directive->column);
+	} catch (const std::out_of_range& e) {
+		error(directive->name + " directive: " + std::string(e.what()), directive->line, directive->column);
+	}
+	return minValue; // Not reached: error() throws.
+}
+
+/**
+ * @brief Parses a time string (e.g., "75s", "500ms", "1m", "60") into milliseconds.
+ * A number without unit is in seconds, as in Nginx.
+ * @param timeStr The string representation of the time.
+ * @return The time in milliseconds.
+ * @throws std::invalid_argument if the time string format is invalid.
+ * @throws std::out_of_range if the value overflows long.
+ */
+long ConfigLoader::parseTimeToMs(const std::string& timeStr) const {
+	size_t i = 0;
+	while (i < timeStr.length() && std::isdigit(static_cast<unsigned char>(timeStr[i]))) {
+		i++;
+	}
+	if (i == 0) {
+		throw std::invalid_argument("Time must start with a number: '" + timeStr + "'.");
+	}
+
+	long value = StringUtils::stringToLong(timeStr.substr(0, i));
+	std::string unit = timeStr.substr(i);
+	long multiplier;
+	if (unit == "ms") {
+		multiplier = 1;
+	} else if (unit.empty() || unit == "s") {
+		multiplier = 1000;
+	} else if (unit == "m") {
+		multiplier = 60 * 1000;
+	} else if (unit == "h") {
+		multiplier = 60 * 60 * 1000;
+	} else {
+		throw std::invalid_argument("Unknown time unit '" + unit + "'. Expected 'ms', 's', 'm' or 'h'.");
+	}
+	if (value > std::numeric_limits<long>::max() / multiplier) {
+		throw std::out_of_range("Time value overflows: " + timeStr);
+	}
+	return value * multiplier;
+}
+
+/**
+ * @brief Parses the single time argument of a timeout directive.
+ * @param directive The DirectiveNode holding one time value.
+ * @return The time in milliseconds.
+ * @throws ConfigLoadError if the argument count or the time format is invalid.
+ */
+long ConfigLoader::parseTimeDirective(const DirectiveNode* directive) const {
+	const std::vector<std::string>& args = directive->args;
+
+	if (args.size() != 1) {
+		error("Directive '" + directive->name + "' requires exactly one argument (time).",
+			  directive->line, directive->column);
+	}
+	try {
+		return parseTimeToMs(args[0]);
+	} catch (const std::invalid_argument& e) {
+		error("Invalid " + directive->name + " value. " + std::string(e.what()), directive->line, directive->column);
+	} catch (const std::out_of_range& e) {
+		error(directive->name + " directive: " + std::string(e.what()), directive->line, directive->column);
+	}
+	return 0; // Not reached: error() throws.
+}
+
 // --- ConfigLoadError Helper ---
 
 /**
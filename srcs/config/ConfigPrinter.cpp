@@ -73,6 +73,11 @@ namespace ConfigPrinter {
         os << "]\n";
 
         os << indent << "    Upload Enabled: " << (loc.uploadEnabled ? "on" : "off") << "\n";
+        if (loc.limitReqRate > 0) {
+            os << indent << "    Limit Req: " << loc.limitReqRate << " r/s, burst " << loc.limitReqBurst << "\n";
+        } else {
+            os << indent << "    Limit Req: off\n";
+        }
         os << indent << "    Upload Store: '" << loc.uploadStore << "'\n";
 
         os << indent << "    CGI Executables:\n";
@@ -106,6 +111,7 @@ namespace ConfigPrinter {
         }
 
         os << indent << "    Client Max Body Size: " << loc.clientMaxBodySize << " bytes\n";
+        os << indent << "    Client Body Buffer Size: " << loc.clientBodyBufferSize << " bytes\n";
 
         // Recursively print nested locations
         if (!loc.nestedLocations.empty()) {
@@ -151,8 +157,15 @@ namespace ConfigPrinter {
         }
 
         os << indent << "    Client Max Body Size: " << server.clientMaxBodySize << " bytes\n";
+        os << indent << "    Client Body Buffer Size: " << server.clientBodyBufferSize << " bytes\n";
         os << indent << "    Error Log Path: '" << server.errorLogPath << "'\n";
         os << indent << "    Error Log Level: " << logLevelToString(server.errorLogLevel) << "\n";
+        os << indent << "    Keepalive Timeout: " << server.keepaliveTimeout << " ms\n";
+        os << indent << "    Keepalive Requests: " << server.keepaliveRequests << "\n";
+        os << indent << "    Client Header Timeout: " << server.clientHeaderTimeout << " ms\n";
+        os << indent << "    Client Body Timeout: " << server.clientBodyTimeout << " ms\n";
+        os << indent << "    Large Client Header Buffers: " << server.largeHeaderBuffers << " x "
+           << server.largeHeaderBufferSize << " bytes\n";
 
         // Print locations within this server
         if (!server.locations.empty()) {
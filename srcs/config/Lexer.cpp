@@ -14,7 +14,7 @@
 
 bool    readFile(const std::string &fileName, std::string &out)
 {
-    std::ifstream   file(fileName);
+    std::ifstream   file(fileName.c_str());
     std::string     buffer;
 
     if (!file)
@@ -170,9 +170,11 @@ token   Lexer::tokeniseNumber()
         if (std::isdigit(c) || c == '.' || c == ':') {
             buffer += get();
         } else {
-            char lower_c = std::tolower(c); // case-insensitive units 'k', 'm', 'g'
-            if (lower_c == 'k' || lower_c == 'm' || lower_c == 'g') {
+            char lower_c = std::tolower(c); // case-insensitive units 'k', 'm', 'g' (sizes), 'ms', 's', 'm', 'h' (times)
+            if (lower_c == 'k' || lower_c == 'm' || lower_c == 'g' || lower_c == 's' || lower_c == 'h') {
                 buffer += get(); // Consume the unit character
+                if (lower_c == 'm' && !isAtEnd() && peek() == 's')
+                    buffer += get(); // "ms" is the only two-character unit
                 break; // Stop after unit
             } else {
                 break; // Stop if not a digit, dot, colon, or unit
@@ -208,6 +210,18 @@ token Lexer::tokeniseIdentifier()
     if (buffer == "upload_store")           return (token(T_UPLOAD_STORE, buffer, startLn, startCol));
     if (buffer == "location")               return (token(T_LOCATION, buffer, startLn, startCol));
     if (buffer == "error_log")              return (token(T_ERROR_LOG, buffer, startLn, startCol));
+    if (buffer == "keepalive_timeout")      return (token(T_KEEPALIVE_TIMEOUT, buffer, startLn, startCol));
+    if (buffer == "keepalive_requests")     return (token(T_KEEPALIVE_REQUESTS, buffer, startLn, startCol));
+    if (buffer == "client_header_timeout")  return (token(T_CLIENT_HEADER_TIMEOUT, buffer, startLn, startCol));
+    if (buffer == "client_body_timeout")    return (token(T_CLIENT_BODY_TIMEOUT, buffer, startLn, startCol));
+    if (buffer == "worker_processes")       return (token(T_WORKER_PROCESSES, buffer, startLn, startCol));
+    if (buffer == "worker_threads")         return (token(T_WORKER_THREADS, buffer, startLn, startCol));
+    if (buffer == "accept_batch")           return (token(T_ACCEPT_BATCH, buffer, startLn, startCol));
+    if (buffer == "worker_connections")     return (token(T_WORKER_CONNECTIONS, buffer, startLn, startCol));
+    if (buffer == "max_pending_requests")   return (token(T_MAX_PENDING_REQUESTS, buffer, startLn, startCol));
+    if (buffer == "limit_req")              return (token(T_LIMIT_REQ, buffer, startLn, startCol));
+    if (buffer == "large_client_header_buffers") return (token(T_LARGE_CLIENT_HEADER_BUFFERS, buffer, startLn, startCol));
+    if (buffer == "client_body_buffer_size") return (token(T_CLIENT_BODY_BUFFER_SIZE, buffer, startLn, startCol));
 
     // Other generic values
     return (token(T_IDENTIFIER, buffer, startLn, startCol));
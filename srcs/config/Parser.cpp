@@ -11,6 +11,7 @@
 /* ************************************************************************** */
 
 #include "../../includes/config/Parser.hpp"
+#include <cstdlib> // For std::atoi, std::atol
 
 // ParseError
     // constructor
@@ -86,11 +87,15 @@ std::vector<ASTnode *>  Parser::parseConfig()
 
         if (checkCurrentType(T_SERVER)) {
             astNodes.push_back(parseServerBlock());
+        } else if (checkCurrentType(T_WORKER_PROCESSES) || checkCurrentType(T_WORKER_THREADS) ||
+                   checkCurrentType(T_ACCEPT_BATCH) || checkCurrentType(T_WORKER_CONNECTIONS) ||
+                   checkCurrentType(T_MAX_PENDING_REQUESTS)) { // global (main context) directives
+            astNodes.push_back(parseDirective());
         } else {
             std::stringstream oss;
             oss << "Unexpected token '" << current.value
                 << "' (type: " << tokenTypeToString(current.type)
-                << ") at top level. Expected 'server' block or end of file.";
+                << ") at top level. Expected 'server' block, a global directive or end of file.";
             error(oss.str());
         }
     }
@@ -117,7 +122,10 @@ BlockNode * Parser::parseServerBlock()
         } else if (checkCurrentType(T_LISTEN) || checkCurrentType(T_SERVER_NAME) ||
                     checkCurrentType(T_ERROR_PAGE) || checkCurrentType(T_CLIENT_MAX_BODY) ||
                     checkCurrentType(T_INDEX) || checkCurrentType(T_ERROR_LOG) ||
-                    checkCurrentType(T_ROOT) || checkCurrentType(T_AUTOINDEX)) { // Added ROOT, AUTOINDEX
+                    checkCurrentType(T_ROOT) || checkCurrentType(T_AUTOINDEX) || // Added ROOT, AUTOINDEX
+                    checkCurrentType(T_KEEPALIVE_TIMEOUT) || checkCurrentType(T_KEEPALIVE_REQUESTS) ||
+                    checkCurrentType(T_CLIENT_HEADER_TIMEOUT) || checkCurrentType(T_CLIENT_BODY_TIMEOUT) ||
+                    checkCurrentType(T_LARGE_CLIENT_HEADER_BUFFERS) || checkCurrentType(T_CLIENT_BODY_BUFFER_SIZE)) {
             serverBlock->children.push_back(parseDirective());
         } else {
             std::ostringstream oss;
@@ -170,7 +178,8 @@ BlockNode * Parser::parseLocationBlock()
         } else if (checkCurrentType(T_ALLOWED_METHODS) || checkCurrentType(T_ROOT) || checkCurrentType(T_INDEX)
                     || checkCurrentType(T_AUTOINDEX) || checkCurrentType(T_UPLOAD_ENABLED) || checkCurrentType(T_UPLOAD_STORE)
                     || checkCurrentType(T_CGI_EXTENSION) || checkCurrentType(T_CGI_PATH) || checkCurrentType(T_RETURN)
-                    || checkCurrentType(T_ERROR_PAGE) || checkCurrentType(T_CLIENT_MAX_BODY) || checkCurrentType(T_ERROR_LOG)) { // Added ERROR_LOG
+                    || checkCurrentType(T_ERROR_PAGE) || checkCurrentType(T_CLIENT_MAX_BODY) || checkCurrentType(T_ERROR_LOG) // Added ERROR_LOG
+                    || checkCurrentType(T_LIMIT_REQ) || checkCurrentType(T_CLIENT_BODY_BUFFER_SIZE)) {
             locationBlock->children.push_back(parseDirective());
         } else {
             std::ostringstream oss;
@@ -233,17 +242,26 @@ std::vector<std::string>    Parser::parseArgs()
 
 bool    Parser::isValidDirective(const std::string& name, const std::string& context) const
 {
+    if (context == "main") {
+        return (name == "worker_processes" || name == "worker_threads" || name == "accept_batch" ||
+                name == "worker_connections" || name == "max_pending_requests");
+    }
+
     if (context == "server") {
         return (name == "listen" || name == "server_name" || name == "error_page" ||
                 name == "client_max_body_size" || name == "index" || name == "error_log" ||
-                name == "root" || name == "autoindex"); // Added root, autoindex for server context
+                name == "root" || name == "autoindex" || // Added root, autoindex for server context
+                name == "keepalive_timeout" || name == "keepalive_requests" ||
+                name == "client_header_timeout" || name == "client_body_timeout" ||
+                name == "large_client_header_buffers" || name == "client_body_buffer_size");
     }
 
     if (context == "location") {
         return (name == "allowed_methods" || name == "root" || name == "index" ||
                 name == "autoindex" || name == "upload_enabled" || name == "upload_store" ||
                 name == "cgi_extension" || name == "cgi_path" || name == "return" ||
-                name == "error_page" || name == "client_max_body_size" || name == "error_log"); // Added error_page, client_max_body_size, error_log for location context
+                name == "error_page" || name == "client_max_body_size" || name == "error_log" || // Added error_page, client_max_body_size, error_log for location context
+                name == "limit_req" || name == "client_body_buffer_size");
     }
 
     return (false);
@@ -328,6 +346,88 @@ void Parser::validateDirectiveArguments(DirectiveNode* directive) const {
             error(oss.str());
         }
 
+    } else if (name == "worker_processes" || name == "worker_threads") {
+        if (args.size() != 1) {
+            oss << "Directive '" << name << "' requires exactly one argument (number of workers or 'auto').";
+            error(oss.str());
+        }
+        if (args[0] != "auto") {
+            for (size_t i = 0; i < args[0].length(); ++i) {
+                if (!std::isdigit(args[0][i])) {
+                    oss << "Argument for '" << name << "' must be a number or 'auto', but got '" << args[0] << "'.";
+                    error(oss.str());
+                }
+            }
+            int workers = std::atoi(args[0].c_str());
+            if (workers < 1 || workers > 1024) {
+                oss << "Directive '" << name << "' out of valid range (1-1024).";
+                error(oss.str());
+            }
+        }
+    } else if (name == "accept_batch" || name == "worker_connections" || name == "max_pending_requests") {
+        long minValue = (name == "max_pending_requests") ? 0 : 1; // 0 = unlimited
+        long maxValue = (name == "accept_batch") ? 65536 : 1048576;
+        if (args.size() != 1) {
+            oss << "Directive '" << name << "' requires exactly one numeric argument.";
+            error(oss.str());
+        }
+        for (size_t i = 0; i < args[0].length(); ++i) {
+            if (!std::isdigit(args[0][i])) {
+                oss << "Argument for '" << name << "' must be a number, but got '" << args[0] << "'.";
+                error(oss.str());
+            }
+        }
+        long value = std::atol(args[0].c_str());
+        if (args[0].empty() || args[0].length() > 7 || value < minValue || value > maxValue) {
+            oss << "Directive '" << name << "' out of valid range (" << minValue << "-" << maxValue << ").";
+            error(oss.str());
+        }
+    } else if (name == "keepalive_timeout" || name == "client_header_timeout" || name == "client_body_timeout") {
+        if (args.size() != 1) {
+            oss << "Directive '" << name << "' requires exactly one argument (time with optional unit ms, s, m or h).";
+            error(oss.str());
+        }
+        const std::string& time_str = args[0];
+        size_t i = 0;
+        while (i < time_str.length() && std::isdigit(time_str[i])) {
+            i++;
+        }
+        std::string unit = time_str.substr(i);
+        if (i == 0 || !(unit.empty() || unit == "ms" || unit == "s" || unit == "m" || unit == "h")) {
+            oss << "Invalid time for '" << name << "': '" << time_str << "'. Expected a number with optional unit ms, s, m or h.";
+            error(oss.str());
+        }
+    } else if (name == "keepalive_requests") {
+        if (args.size() != 1) {
+            oss << "Directive 'keepalive_requests' requires exactly one argument (number of requests).";
+            error(oss.str());
+        }
+        for (size_t i = 0; i < args[0].length(); ++i) {
+            if (!std::isdigit(args[0][i])) {
+                oss << "Argument for 'keepalive_requests' must be a number, but got '" << args[0] << "'.";
+                error(oss.str());
+            }
+        }
+    } else if (name == "large_client_header_buffers") {
+        if (args.size() != 2) {
+            oss << "Directive 'large_client_header_buffers' requires exactly two arguments (number and size).";
+            error(oss.str());
+        }
+        for (size_t j = 0; j < args[0].length(); ++j) {
+            if (!std::isdigit(args[0][j])) {
+                oss << "Number of buffers for 'large_client_header_buffers' must be a number, but got '" << args[0] << "'.";
+                error(oss.str());
+            }
+        }
+        size_t i = 0;
+        while (i < args[1].length() && std::isdigit(args[1][i])) {
+            i++;
+        }
+        std::string unit = args[1].substr(i);
+        if (i == 0 || !(unit.empty() || unit == "k" || unit == "m")) {
+            oss << "Invalid buffer size for 'large_client_header_buffers': '" << args[1] << "'. Expected a number with optional unit k or m.";
+            error(oss.str());
+        }
     } else if (name == "server_name") {
         if (args.empty()) {
             oss << "Directive 'server_name' requires at least one argument (hostname).";
@@ -358,14 +458,14 @@ void Parser::validateDirectiveArguments(DirectiveNode* directive) const {
             }
         }
         // The last argument (URI) is not validated here beyond being a string/identifier.
-    } else if (name == "client_max_body_size") {
+    } else if (name == "client_max_body_size" || name == "client_body_buffer_size") {
         if (args.size() != 1) {
-            oss << "Directive 'client_max_body_size' requires exactly one argument (size with optional units).";
+            oss << "Directive '" << name << "' requires exactly one argument (size with optional units).";
             error(oss.str());
         }
         std::string size_str = args[0];
         if (size_str.empty()) {
-             oss << "Directive 'client_max_body_size' argument cannot be empty.";
+             oss << "Directive '" << name << "' argument cannot be empty.";
              error(oss.str());
         }
         size_t i = 0;
@@ -373,14 +473,14 @@ void Parser::validateDirectiveArguments(DirectiveNode* directive) const {
             i++;
         }
         if (i == 0 && !size_str.empty()) { // Not starting with digit
-             oss << "Directive 'client_max_body_size' argument must start with a number.";
+             oss << "Directive '" << name << "' argument must start with a number.";
              error(oss.str());
         }
         if (i < size_str.length()) { // Has units
             char unit = std::tolower(size_str[i]);
             // MODIFIED: Corrected unit validation to ensure no extra characters after unit
             if (! (unit == 'k' || unit == 'm' || unit == 'g') || (i + 1 < size_str.length())) {
-                oss << "Invalid unit or extra characters for 'client_max_body_size' argument: '" << size_str << "'. Expected 'k', 'm', or 'g'.";
+                oss << "Invalid unit or extra characters for '" << name << "' argument: '" << size_str << "'. Expected 'k', 'm', or 'g'.";
                 error(oss.str());
             }
         }
@@ -420,6 +520,25 @@ void Parser::validateDirectiveArguments(DirectiveNode* directive) const {
                 error(oss.str());
             }
         }
+    } else if (name == "limit_req") {
+        if (args.empty() || args.size() > 2) {
+            oss << "Directive 'limit_req' requires a rate (requests per second) and an optional burst.";
+            error(oss.str());
+        }
+        for (size_t a = 0; a < args.size(); ++a) {
+            for (size_t i = 0; i < args[a].length(); ++i) {
+                if (!std::isdigit(args[a][i])) {
+                    oss << "Arguments for 'limit_req' must be numbers, but got '" << args[a] << "'.";
+                    error(oss.str());
+                }
+            }
+            long value = std::atol(args[a].c_str());
+            if (args[a].empty() || args[a].length() > 6 || value < (a == 0 ? 1 : 0) || value > 100000) {
+                oss << "Directive 'limit_req' " << (a == 0 ? "rate" : "burst") << " out of valid range ("
+                    << (a == 0 ? 1 : 0) << "-100000).";
+                error(oss.str());
+            }
+        }
     } else if (name == "return") {
         if (args.empty() || args.size() > 2) {
             oss << "Directive 'return' requires one or two arguments: a status code and optional URL/text.";
@@ -47,6 +47,18 @@ const std::string       tokenTypeToString(tokenType type)
 		case T_UPLOAD_STORE: return "T_UPLOAD_STORE";
 		case T_LOCATION: return "T_LOCATION";
 		case T_ERROR_LOG: return "T_ERROR_LOG";
+		case T_KEEPALIVE_TIMEOUT: return "T_KEEPALIVE_TIMEOUT";
+		case T_KEEPALIVE_REQUESTS: return "T_KEEPALIVE_REQUESTS";
+		case T_CLIENT_HEADER_TIMEOUT: return "T_CLIENT_HEADER_TIMEOUT";
+		case T_CLIENT_BODY_TIMEOUT: return "T_CLIENT_BODY_TIMEOUT";
+		case T_WORKER_PROCESSES: return "T_WORKER_PROCESSES";
+		case T_WORKER_THREADS: return "T_WORKER_THREADS";
+		case T_ACCEPT_BATCH: return "T_ACCEPT_BATCH";
+		case T_WORKER_CONNECTIONS: return "T_WORKER_CONNECTIONS";
+		case T_MAX_PENDING_REQUESTS: return "T_MAX_PENDING_REQUESTS";
+		case T_LIMIT_REQ: return "T_LIMIT_REQ";
+		case T_LARGE_CLIENT_HEADER_BUFFERS: return "T_LARGE_CLIENT_HEADER_BUFFERS";
+		case T_CLIENT_BODY_BUFFER_SIZE: return "T_CLIENT_BODY_BUFFER_SIZE";
 
 		// Other values
 		case T_IDENTIFIER: return "T_IDENTIFIER";
@@ -0,0 +1,150 @@
+#include "../../includes/http/BodySpool.hpp"
+
+#include <iostream>
+#include <cerrno>
+#include <cstdio>  // For snprintf
+#include <cstdlib> // For mkstemp
+#include <cstring> // For strerror
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+BodySpool::BodySpool(std::vector<char>& memory)
+    : _memory(memory), _threshold(0), _fd(-1), _size(0), _failed(false) {
+}
+
+BodySpool::~BodySpool() {
+    closeFile();
+}
+
+void BodySpool::reset() {
+    closeFile();
+    _dir.clear();
+    _threshold = 0;
+    _size = 0;
+    _failed = false;
+}
+
+void BodySpool::spoolTo(const std::string& dir, size_t threshold) {
+    _dir = dir;
+    _threshold = threshold;
+}
+
+// Anonymous file in the spool directory; a hidden named one where O_TMPFILE is missing
+// (not Linux, or a file system without support)
+bool BodySpool::openFile() {
+#ifdef O_TMPFILE
+    _fd = ::open(_dir.c_str(), O_TMPFILE | O_WRONLY | O_CLOEXEC, 0644);
+    if (_fd >= 0) {
+        return true;
+    }
+#endif
+    std::string templ = _dir;
+
+    if (templ.empty() || templ[templ.length() - 1] != '/') {
+        templ += "/";
+    }
+    templ += ".body-XXXXXX";
+
+    std::vector<char> name(templ.begin(), templ.end());
+    name.push_back('\0');
+    _fd = mkstemp(&name[0]);
+    if (_fd < 0) {
+        std::cerr << "ERROR: Cannot spool request body to " << _dir << ": " << strerror(errno)
+                  << ". Keeping it in memory.\n";
+        return false;
+    }
+    fcntl(_fd, F_SETFD, FD_CLOEXEC);
+    fchmod(_fd, 0644);
+    _tempPath = &name[0];
+    return true;
+}
+
+void BodySpool::writeFile(const char* data, size_t len) {
+    while (len > 0 && !_failed) {
+        ssize_t n = ::write(_fd, data, len);
+
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            std::cerr << "ERROR: Writing spooled request body failed: " << strerror(errno) << "\n";
+            _failed = true; // the body is dropped, the request still has to be read to its end
+            return;
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+}
+
+// An unpublished O_TMPFILE file disappears with its descriptor; a named temp file is removed
+void BodySpool::closeFile() {
+    if (_fd >= 0) {
+        ::close(_fd);
+        _fd = -1;
+    }
+    if (!_tempPath.empty()) {
+        ::unlink(_tempPath.c_str());
+        _tempPath.clear();
+    }
+}
+
+// Once over the threshold, the body received so far moves to the file and its memory is given back
+void BodySpool::write(const char* data, size_t len) {
+    _size += len;
+    if (_fd < 0 && !_dir.empty() && _size > _threshold) {
+        if (openFile()) {
+            if (!_memory.empty()) {
+                writeFile(&_memory[0], _memory.size());
+            }
+            std::vector<char>().swap(_memory);
+        } else {
+            _dir.clear(); // not retried for every write
+        }
+    }
+    if (_fd >= 0) {
+        writeFile(data, len);
+    } else {
+        _memory.insert(_memory.end(), data, data + len);
+    }
+}
+
+// Body length known up front (Content-Length): a body bound for the file skips memory entirely
+bool BodySpool::expect(size_t length) {
+    if (_fd < 0 && !_dir.empty() && length > _threshold && !openFile()) {
+        _dir.clear();
+    }
+    return _fd >= 0;
+}
+
+size_t BodySpool::size() const {
+    return _size;
+}
+
+bool BodySpool::inFile() const {
+    return _fd >= 0;
+}
+
+bool BodySpool::failed() const {
+    return _failed;
+}
+
+// linkat through /proc gives the anonymous file a name (AT_EMPTY_PATH would need CAP_DAC_READ_SEARCH).
+// Like link(), it never replaces an existing file
+bool BodySpool::publish(const std::string& path) {
+    if (_fd < 0 || _failed) {
+        return false;
+    }
+    if (_tempPath.empty()) {
+        char procPath[64];
+
+        snprintf(procPath, sizeof(procPath), "/proc/self/fd/%d", _fd);
+        if (linkat(AT_FDCWD, procPath, AT_FDCWD, path.c_str(), AT_SYMLINK_FOLLOW) != 0) {
+            return false;
+        }
+    } else if (::link(_tempPath.c_str(), path.c_str()) != 0) {
+        return false;
+    }
+    closeFile(); // the file now lives under 'path'
+    return true;
+}
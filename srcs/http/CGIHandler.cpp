@@ -56,13 +56,14 @@ CGIHandler::CGIHandler(const HttpRequest& request,
         }
 
         // Extract the file extension from the request path
-        size_t dot_pos = _request.path.rfind('.');
+        std::string requestPath = _request.path().str();
+        size_t dot_pos = requestPath.rfind('.');
         if (dot_pos == std::string::npos) {
-            std::cerr << "ERROR: CGIHandler: No file extension found in URI for CGI: " << _request.path << std::endl;
+            std::cerr << "ERROR: CGIHandler: No file extension found in URI for CGI: " << requestPath << std::endl;
             _state = CGIState::CGI_PROCESS_ERROR;
             return;
         }
-        std::string file_extension = _request.path.substr(dot_pos);
+        std::string file_extension = requestPath.substr(dot_pos);
         
         // Find the CGI executable mapped to this extension
         std::map<std::string, std::string>::const_iterator cgi_it = _locationConfig->cgiExecutables.find(file_extension);
@@ -75,7 +76,7 @@ CGIHandler::CGIHandler(const HttpRequest& request,
 
         // --- Corrected Logic for _cgi_script_path (retains previous good fix) ---
         // Combines location's root with the full URI path portion that maps to the script.
-        std::string requestPathNormalized = _request.path;
+        std::string requestPathNormalized = requestPath;
         if (requestPathNormalized.empty() || requestPathNormalized[0] != '/') {
              requestPathNormalized = "/" + requestPathNormalized;
         }
@@ -185,8 +186,8 @@ char** CGIHandler::_createCGIEnvironment() const {
     std::vector<std::string> env_vars_vec;
 
     // Mandatory CGI variables
-    env_vars_vec.push_back("REQUEST_METHOD=" + _request.method);
-    env_vars_vec.push_back("SERVER_PROTOCOL=" + _request.protocolVersion);
+    env_vars_vec.push_back("REQUEST_METHOD=" + _request.method().str());
+    env_vars_vec.push_back("SERVER_PROTOCOL=" + _request.protocolVersion().str());
 
     // Add REDIRECT_STATUS to satisfy php-cgi's security check
     env_vars_vec.push_back("REDIRECT_STATUS=200"); // Common value used by Apache for internal redirects
@@ -208,7 +209,7 @@ char** CGIHandler::_createCGIEnvironment() const {
     env_vars_vec.push_back("SCRIPT_FILENAME=" + _cgi_script_path); 
 
     // SCRIPT_NAME: The URI path to the script itself.
-    env_vars_vec.push_back("SCRIPT_NAME=" + _request.path); 
+    env_vars_vec.push_back("SCRIPT_NAME=" + _request.path().str()); 
 
     // PATH_INFO: Additional path information from the URI beyond the script name.
     // For test.php, PATH_INFO would typically be empty if request is /php/test.php
@@ -217,28 +218,19 @@ char** CGIHandler::_createCGIEnvironment() const {
     env_vars_vec.push_back("PATH_INFO="); 
 
     // REQUEST_URI: The full original request URI (including query string).
-    env_vars_vec.push_back("REQUEST_URI=" + _request.uri); 
+    env_vars_vec.push_back("REQUEST_URI=" + _request.uri().str()); 
 
     // QUERY_STRING for GET requests
-    size_t query_pos = _request.uri.find('?');
-    if (query_pos != std::string::npos) {
-        env_vars_vec.push_back("QUERY_STRING=" + _request.uri.substr(query_pos + 1));
-    } else {
-        env_vars_vec.push_back("QUERY_STRING=");
-    }
+    env_vars_vec.push_back("QUERY_STRING=" + _request.queryString().str());
 
     // CONTENT_TYPE and CONTENT_LENGTH for POST requests
-    if (_request.method == "POST") {
-        std::map<std::string, std::string>::const_iterator it_type = _request.headers.find("content-type");
-        if (it_type != _request.headers.end()) {
-            env_vars_vec.push_back("CONTENT_TYPE=" + it_type->second);
-        } else {
-            env_vars_vec.push_back("CONTENT_TYPE="); // Default empty
-        }
+    if (_request.methodId() == HTTP_POST) {
+        env_vars_vec.push_back("CONTENT_TYPE=" + _request.header(HEADER_CONTENT_TYPE).str()); // Default empty
 
-        std::map<std::string, std::string>::const_iterator it_len = _request.headers.find("content-length");
-        if (it_len != _request.headers.end()) {
-            env_vars_vec.push_back("CONTENT_LENGTH=" + it_len->second);
+        if (_request.hasHeader(HEADER_CONTENT_LENGTH)) {
+            env_vars_vec.push_back("CONTENT_LENGTH=" + _request.header(HEADER_CONTENT_LENGTH).str());
+        } else if (_request.hasHeader(HEADER_TRANSFER_ENCODING)) { // chunked: the script gets the decoded body
+            env_vars_vec.push_back("CONTENT_LENGTH=" + StringUtils::longToString(static_cast<long>(_request.body.size())));
         } else {
             env_vars_vec.push_back("CONTENT_LENGTH=0"); // Default 0
         }
@@ -262,19 +254,25 @@ char** CGIHandler::_createCGIEnvironment() const {
 
 
     // Other HTTP headers (prefixed with HTTP_ and converted to uppercase with _ instead of -)
-    for (std::map<std::string, std::string>::const_iterator it = _request.headers.begin(); it != _request.headers.end(); ++it) {
-        std::string header_name = it->first;
-        // Skip Content-Type and Content-Length as they are handled explicitly above
-        if (StringUtils::ciCompare(header_name, "content-type") || StringUtils::ciCompare(header_name, "content-length")) {
+    for (size_t h = 0; h < _request.headerCount(); ++h) {
+        HeaderId id = _request.headerId(h);
+        // Skip Content-Type and Content-Length as they are handled explicitly above,
+        // and Transfer-Encoding: the script reads the body already decoded
+        if (id == HEADER_CONTENT_TYPE || id == HEADER_CONTENT_LENGTH || id == HEADER_TRANSFER_ENCODING) {
+            continue;
+        }
+        // A repeated header is passed once, with its last value (as HttpRequest::header() does)
+        if (_request.isOverridden(h)) {
             continue;
         }
+        std::string header_name = _request.headerName(h).str();
         std::transform(header_name.begin(), header_name.end(), header_name.begin(), static_cast<int(*)(int)>(std::toupper));
         for (size_t i = 0; i < header_name.length(); ++i) {
             if (header_name[i] == '-') {
                 header_name[i] = '_';
             }
         }
-        env_vars_vec.push_back("HTTP_" + header_name + "=" + it->second);
+        env_vars_vec.push_back("HTTP_" + header_name + "=" + _request.headerValue(h).str());
     }
     
     // REMOTE_ADDR and REMOTE_PORT (assuming these can be derived from request's client connection)
@@ -421,7 +419,7 @@ bool CGIHandler::start() {
         close(_fd_stdout[1]);
 
         // Initial state: If POST, need to write body; otherwise, just read output.
-        if (_request.method == "POST" && _request_body_ptr && !_request_body_ptr->empty()) {
+        if (_request.methodId() == HTTP_POST && _request_body_ptr && !_request_body_ptr->empty()) {
             _state = CGIState::WRITING_INPUT;
         } else {
             _state = CGIState::READING_OUTPUT;
@@ -0,0 +1,177 @@
+#include "../../includes/http/ChunkedDecoder.hpp"
+
+#define CHUNK_SIZE_DIGITS_MAX (sizeof(size_t) * 2) // hex digits of the largest size_t
+
+ChunkedDecoder::ChunkedDecoder() : _limit(0) {
+    reset();
+}
+
+// Back to the start of a body; the limit is kept
+void ChunkedDecoder::reset() {
+    _state = CHUNK_SIZE;
+    _chunkSize = 0;
+    _digits = 0;
+    _skipped = 0;
+    _decoded = 0;
+    _errorStatus = 400;
+    _errorMessage = NULL;
+}
+
+void ChunkedDecoder::setLimit(size_t maxBody) {
+    _limit = maxBody;
+}
+
+void ChunkedDecoder::fail(const char* msg, int status) {
+    _state = CHUNK_ERROR;
+    _errorMessage = msg;
+    _errorStatus = status;
+}
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// One byte at a time for the framing, whole runs for the chunk data
+size_t ChunkedDecoder::decode(const char* data, size_t len, BodySink& sink) {
+    size_t i = 0;
+
+    while (i < len && _state != CHUNK_DONE && _state != CHUNK_ERROR) {
+        char c = data[i];
+
+        switch (_state) {
+            case CHUNK_SIZE: {
+                int v = hexValue(c);
+
+                if (v >= 0) {
+                    if (++_digits > CHUNK_SIZE_DIGITS_MAX) {
+                        fail("Chunk size too large.");
+                        break;
+                    }
+                    _chunkSize = _chunkSize * 16 + v;
+                } else if (_digits == 0) {
+                    fail("Chunk size expected.");
+                    break;
+                } else if (c == ';' || c == ' ' || c == '\t') {
+                    _state = CHUNK_EXT;
+                    _skipped = 0;
+                } else if (c == '\r') {
+                    _state = CHUNK_SIZE_LF;
+                } else {
+                    fail("Invalid character in chunk size.");
+                    break;
+                }
+                ++i;
+                break;
+            }
+            case CHUNK_EXT:
+                if (c == '\r') {
+                    _state = CHUNK_SIZE_LF;
+                } else if (c == '\n' || ++_skipped > CHUNK_EXT_MAX) {
+                    fail("Malformed chunk extension.");
+                    break;
+                }
+                ++i;
+                break;
+            case CHUNK_SIZE_LF:
+                if (c != '\n') {
+                    fail("Chunk size line must end with CRLF.");
+                    break;
+                }
+                ++i;
+                if (_chunkSize == 0) {
+                    _state = CHUNK_TRAILER;
+                    _skipped = 0;
+                } else if (_limit && _chunkSize > _limit - _decoded) { // refused before the data is sent
+                    fail("Chunked body larger than client_max_body_size.", 413);
+                } else {
+                    _state = CHUNK_DATA;
+                }
+                break;
+            case CHUNK_DATA: {
+                size_t n = (len - i < _chunkSize) ? len - i : _chunkSize;
+
+                sink.write(data + i, n);
+                _decoded += n;
+                _chunkSize -= n;
+                i += n;
+                if (_chunkSize == 0) {
+                    _state = CHUNK_DATA_CR;
+                }
+                break;
+            }
+            case CHUNK_DATA_CR:
+                if (c != '\r') {
+                    fail("Chunk data must be followed by CRLF.");
+                    break;
+                }
+                _state = CHUNK_DATA_LF;
+                ++i;
+                break;
+            case CHUNK_DATA_LF:
+                if (c != '\n') {
+                    fail("Chunk data must be followed by CRLF.");
+                    break;
+                }
+                _state = CHUNK_SIZE;
+                _digits = 0;
+                ++i;
+                break;
+            case CHUNK_TRAILER:
+                if (c == '\n') {
+                    fail("Trailer lines must end with CRLF.");
+                    break;
+                }
+                _state = (c == '\r') ? CHUNK_FINAL_LF : CHUNK_TRAILER_LINE;
+                ++_skipped;
+                ++i;
+                break;
+            case CHUNK_TRAILER_LINE:
+                if (c == '\r') {
+                    _state = CHUNK_TRAILER_LF;
+                } else if (c == '\n') {
+                    fail("Trailer lines must end with CRLF.");
+                    break;
+                }
+                ++i;
+                if (++_skipped > CHUNK_TRAILER_MAX) {
+                    fail("Trailer section too large.");
+                }
+                break;
+            case CHUNK_TRAILER_LF:
+            case CHUNK_FINAL_LF:
+                if (c != '\n') {
+                    fail("Trailer lines must end with CRLF.");
+                    break;
+                }
+                _state = (_state == CHUNK_FINAL_LF) ? CHUNK_DONE : CHUNK_TRAILER;
+                ++i;
+                break;
+            default:
+                break;
+        }
+    }
+    return i;
+}
+
+bool ChunkedDecoder::isDone() const {
+    return _state == CHUNK_DONE;
+}
+
+bool ChunkedDecoder::hasError() const {
+    return _state == CHUNK_ERROR;
+}
+
+int ChunkedDecoder::getErrorStatus() const {
+    return _errorStatus;
+}
+
+const char* ChunkedDecoder::getErrorMessage() const {
+    return _errorMessage ? _errorMessage : "";
+}
+
+size_t ChunkedDecoder::decodedSize() const {
+    return _decoded;
+}
@@ -0,0 +1,217 @@
+#include "../../includes/http/HeadScanner.hpp"
+
+#include <cstring> // For std::memcpy
+#include <stdint.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__) && defined(__GNUC__)
+# define HEAD_SCANNER_X86 1
+# include <emmintrin.h>
+# include <immintrin.h>
+#endif
+
+#define SCAN_BLOCK 64 // bytes turned into one 64-bit mask
+
+HeadLayout::HeadLayout() {
+    clear();
+}
+
+void HeadLayout::clear() {
+    lineEnd = std::string::npos;
+    firstSpace = std::string::npos;
+    secondSpace = std::string::npos;
+    headers.clear();
+    headEnd = 0;
+    malformed = false;
+    scanned = 0;
+    lineStart = 0;
+    colon = std::string::npos;
+    inRequestLine = true;
+}
+
+// One bit per byte of the block: set for CR, LF, ':' and SP
+typedef uint64_t (*BlockMaskFn)(const char* block);
+
+static inline bool isDelimiter(char c) {
+    return c == '\r' || c == '\n' || c == ':' || c == ' ';
+}
+
+static uint64_t blockMaskScalar(const char* block) {
+    uint64_t mask = 0;
+
+    for (int i = 0; i < SCAN_BLOCK; ++i) {
+        if (isDelimiter(block[i])) {
+            mask |= static_cast<uint64_t>(1) << i;
+        }
+    }
+    return mask;
+}
+
+#ifdef HEAD_SCANNER_X86
+
+// SSE2 is part of x86-64 itself: always available on this path
+static uint64_t blockMaskSse2(const char* block) {
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i colon = _mm_set1_epi8(':');
+    const __m128i sp = _mm_set1_epi8(' ');
+    uint64_t mask = 0;
+
+    for (int i = 0; i < SCAN_BLOCK / 16; ++i) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * i));
+        __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, cr), _mm_cmpeq_epi8(v, lf)),
+                                   _mm_or_si128(_mm_cmpeq_epi8(v, colon), _mm_cmpeq_epi8(v, sp)));
+        mask |= static_cast<uint64_t>(static_cast<unsigned int>(_mm_movemask_epi8(hit))) << (16 * i);
+    }
+    return mask;
+}
+
+// Compiled for AVX2 whatever the global flags: only called once CPUID said it is there
+__attribute__((target("avx2")))
+static uint64_t blockMaskAvx2(const char* block) {
+    const __m256i cr = _mm256_set1_epi8('\r');
+    const __m256i lf = _mm256_set1_epi8('\n');
+    const __m256i colon = _mm256_set1_epi8(':');
+    const __m256i sp = _mm256_set1_epi8(' ');
+    uint64_t mask = 0;
+
+    for (int i = 0; i < SCAN_BLOCK / 32; ++i) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32 * i));
+        __m256i hit = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, cr), _mm256_cmpeq_epi8(v, lf)),
+                                      _mm256_or_si256(_mm256_cmpeq_epi8(v, colon), _mm256_cmpeq_epi8(v, sp)));
+        mask |= static_cast<uint64_t>(static_cast<unsigned int>(_mm256_movemask_epi8(hit))) << (32 * i);
+    }
+    return mask;
+}
+
+#endif // HEAD_SCANNER_X86
+
+static HeadScanner::Level detectLevel() {
+#ifdef HEAD_SCANNER_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) { // also checks that the OS saves the YMM registers
+        return HeadScanner::LEVEL_AVX2;
+    }
+    return HeadScanner::LEVEL_SSE2;
+#else
+    return HeadScanner::LEVEL_SCALAR;
+#endif
+}
+
+static BlockMaskFn maskFor(HeadScanner::Level lvl) {
+#ifdef HEAD_SCANNER_X86
+    if (lvl == HeadScanner::LEVEL_AVX2) {
+        return blockMaskAvx2;
+    }
+    if (lvl == HeadScanner::LEVEL_SSE2) {
+        return blockMaskSse2;
+    }
+#endif
+    (void)lvl;
+    return blockMaskScalar;
+}
+
+// Picked once before main(): the scan itself is a plain indirect call
+static const HeadScanner::Level g_detected = detectLevel();
+static HeadScanner::Level g_level = g_detected;
+static BlockMaskFn g_blockMask = maskFor(g_detected);
+
+HeadScanner::Level HeadScanner::detectedLevel() {
+    return g_detected;
+}
+
+HeadScanner::Level HeadScanner::level() {
+    return g_level;
+}
+
+void HeadScanner::forceLevel(Level lvl) {
+    g_level = (lvl > g_detected) ? g_detected : lvl;
+    g_blockMask = maskFor(g_level);
+}
+
+const char* HeadScanner::levelName(Level lvl) {
+    switch (lvl) {
+        case LEVEL_AVX2: return "avx2";
+        case LEVEL_SSE2: return "sse2";
+        default: return "scalar";
+    }
+}
+
+// Walks the delimiter bits block by block, from where the previous call stopped: each byte is
+// examined once however the head is split across reads. Only CRLF ends a line: a bare CR or LF
+// marks the head as malformed. SP only matters in the request line, ':' only the first one of a header line.
+void HeadScanner::scan(const char* data, size_t len, HeadLayout& out) {
+    const size_t npos = std::string::npos;
+    size_t skipLf = npos;   // LF of the CRLF just handled
+    char tail[SCAN_BLOCK];
+
+    if (out.headEnd || out.malformed) {
+        return;
+    }
+    for (size_t base = out.scanned; base < len; base += SCAN_BLOCK) {
+        uint64_t mask;
+
+        if (len - base >= SCAN_BLOCK) {
+            mask = g_blockMask(data + base);
+        } else { // last partial block: padded copy, the padding is not a delimiter
+            size_t n = len - base;
+
+            std::memset(tail, 'x', sizeof(tail));
+            std::memcpy(tail, data + base, n);
+            mask = g_blockMask(tail) & ((static_cast<uint64_t>(1) << n) - 1);
+        }
+        while (mask) {
+            size_t i = base + __builtin_ctzll(mask);
+            char c = data[i];
+
+            mask &= mask - 1;
+            if (c == ' ') {
+                if (out.inRequestLine && out.firstSpace == npos) {
+                    out.firstSpace = i;
+                } else if (out.inRequestLine && out.secondSpace == npos) {
+                    out.secondSpace = i;
+                }
+                continue;
+            }
+            if (c == ':') {
+                if (!out.inRequestLine && out.colon == npos) {
+                    out.colon = i;
+                }
+                continue;
+            }
+            if (c == '\n') {
+                if (i != skipLf) {
+                    out.malformed = true;
+                    return;
+                }
+                continue;
+            }
+            // CR: must be followed by LF
+            if (i + 1 >= len) {
+                out.scanned = i; // wait for the LF, this CR is examined again
+                return;
+            }
+            if (data[i + 1] != '\n') {
+                out.malformed = true;
+                return;
+            }
+            if (out.inRequestLine) {
+                out.lineEnd = i;
+                out.inRequestLine = false;
+            } else if (i == out.lineStart) { // empty line: end of the head
+                out.headEnd = i + 2;
+                out.scanned = out.headEnd;
+                return;
+            } else {
+                HeadLine line;
+                line.start = out.lineStart;
+                line.end = i;
+                line.colon = out.colon;
+                out.headers.push_back(line);
+            }
+            out.lineStart = i + 2;
+            out.colon = npos;
+            skipLf = i + 1;
+        }
+    }
+    out.scanned = len;
+}
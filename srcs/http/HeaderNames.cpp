@@ -0,0 +1,136 @@
+#include "../../includes/http/HeaderNames.hpp"
+
+#include <cstring> // For std::memcmp, std::strlen, std::memset
+#include <stdint.h>
+
+#define HEADER_TABLE_BITS 9 // 512 slots for ~70 names: a seed without collision is found in a few tries
+#define HEADER_TABLE_SIZE (1u << HEADER_TABLE_BITS)
+
+// Same order as enum HeaderId
+static const char* const g_names[] = {
+    "accept",
+    "accept-charset",
+    "accept-encoding",
+    "accept-language",
+    "accept-ranges",
+    "access-control-request-headers",
+    "access-control-request-method",
+    "age",
+    "allow",
+    "authorization",
+    "cache-control",
+    "connection",
+    "content-disposition",
+    "content-encoding",
+    "content-language",
+    "content-length",
+    "content-location",
+    "content-range",
+    "content-type",
+    "cookie",
+    "date",
+    "dnt",
+    "etag",
+    "expect",
+    "expires",
+    "forwarded",
+    "from",
+    "host",
+    "if-match",
+    "if-modified-since",
+    "if-none-match",
+    "if-range",
+    "if-unmodified-since",
+    "keep-alive",
+    "last-modified",
+    "link",
+    "location",
+    "max-forwards",
+    "origin",
+    "pragma",
+    "proxy-authorization",
+    "range",
+    "referer",
+    "retry-after",
+    "sec-ch-ua",
+    "sec-ch-ua-mobile",
+    "sec-ch-ua-platform",
+    "sec-fetch-dest",
+    "sec-fetch-mode",
+    "sec-fetch-site",
+    "sec-fetch-user",
+    "server",
+    "set-cookie",
+    "te",
+    "trailer",
+    "transfer-encoding",
+    "upgrade",
+    "upgrade-insecure-requests",
+    "user-agent",
+    "via",
+    "warning",
+    "www-authenticate",
+    "x-forwarded-for",
+    "x-forwarded-host",
+    "x-forwarded-proto",
+    "x-real-ip",
+    "x-requested-with"
+};
+
+// Fails to compile if the table and the enum drift apart
+typedef char header_names_match_enum[(sizeof(g_names) / sizeof(g_names[0]) == HEADER_ID_COUNT) ? 1 : -1];
+
+// FNV-1a, seeded
+static inline uint32_t hashName(const char* name, size_t len, uint32_t seed) {
+    uint32_t h = 2166136261u ^ seed;
+
+    for (size_t i = 0; i < len; ++i) {
+        h ^= static_cast<unsigned char>(name[i]);
+        h *= 16777619u;
+    }
+    return h ^ (h >> 16);
+}
+
+struct HeaderTable {
+    uint32_t        seed;
+    unsigned char   slots[HEADER_TABLE_SIZE];   // HeaderId, HEADER_UNKNOWN for an empty slot
+    unsigned char   lengths[HEADER_ID_COUNT];   // rejects most misses before the memcmp
+};
+
+// Tries seeds until every known name lands in its own slot
+static HeaderTable buildTable() {
+    HeaderTable t;
+
+    for (size_t i = 0; i < HEADER_ID_COUNT; ++i) {
+        t.lengths[i] = static_cast<unsigned char>(std::strlen(g_names[i]));
+    }
+    for (t.seed = 0; ; ++t.seed) {
+        bool collision = false;
+
+        std::memset(t.slots, HEADER_UNKNOWN, sizeof(t.slots));
+        for (size_t i = 0; i < HEADER_ID_COUNT && !collision; ++i) {
+            uint32_t slot = hashName(g_names[i], t.lengths[i], t.seed) & (HEADER_TABLE_SIZE - 1);
+
+            collision = (t.slots[slot] != HEADER_UNKNOWN);
+            t.slots[slot] = static_cast<unsigned char>(i);
+        }
+        if (!collision) {
+            return t;
+        }
+    }
+}
+
+static const HeaderTable g_table = buildTable();
+
+HeaderId HeaderNames::lookup(const char* name, size_t len) {
+    unsigned char id = g_table.slots[hashName(name, len, g_table.seed) & (HEADER_TABLE_SIZE - 1)];
+
+    if (id == HEADER_UNKNOWN || g_table.lengths[id] != len || std::memcmp(g_names[id], name, len) != 0) {
+        return HEADER_UNKNOWN;
+    }
+    return static_cast<HeaderId>(id);
+}
+
+const char* HeaderNames::name(HeaderId id) {
+    return (id < HEADER_ID_COUNT) ? g_names[id] : NULL;
+}
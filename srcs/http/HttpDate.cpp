@@ -0,0 +1,33 @@
+#include "../../includes/http/HttpDate.hpp"
+
+#include <ctime>
+
+// Per thread: reactors in thread mode each have their own clock, no locking
+static __thread time_t t_second = -1;       // second t_text was formatted for
+static __thread bool t_driven = false;      // an event loop ticks this clock
+static __thread char t_text[HttpDate::LENGTH + 1];
+
+static void refresh() {
+    time_t current = time(NULL);
+    struct tm gmtm;
+
+    if (current == t_second) {
+        return;
+    }
+    t_second = current;
+    gmtime_r(&current, &gmtm);
+    // RFC 1123: "Wdy, DD Mon YYYY HH:MM:SS GMT"
+    strftime(t_text, sizeof(t_text), "%a, %d %b %Y %H:%M:%S GMT", &gmtm);
+}
+
+void HttpDate::tick() {
+    t_driven = true;
+    refresh();
+}
+
+const char* HttpDate::now() {
+    if (!t_driven) {
+        refresh();
+    }
+    return t_text;
+}
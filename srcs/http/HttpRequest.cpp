@@ -11,39 +11,316 @@
 /* ************************************************************************** */
 
 #include "../../includes/http/HttpRequest.hpp"
+#include "../../includes/http/BodySpool.hpp"
 // CHANGE: Include <cctype> for static_cast<unsigned char> with isprint (and potentially isspace/tolower if not in StringUtils)
 #include <cctype> // For std::isprint for safe character printing
+#include <cstring> // For std::memset
 
-HttpRequest::HttpRequest() : expectedBodyLength(0), currentState(RECV_REQUEST_LINE)
-{}
+HttpRequest::HttpRequest() : expectedBodyLength(0), spool(NULL), currentState(RECV_REQUEST_LINE), _source(NULL),
+	_rawBegin(0), _rawEnd(0), _methodId(HTTP_UNKNOWN), _fieldCount(0)
+{
+	std::memset(_known, 0, sizeof(_known));
+}
+
+static HttpMethod methodFromView(const StringView& method)
+{
+	if (method == "GET") {
+		return (HTTP_GET);
+	}
+	if (method == "POST") {
+		return (HTTP_POST);
+	}
+	if (method == "DELETE") {
+		return (HTTP_DELETE);
+	}
+	return (HTTP_UNKNOWN);
+}
+
+const char* HttpRequest::bytes() const
+{
+	const std::vector<char>& raw = _source ? *_source : _owned;
+
+	return (raw.empty() ? NULL : &raw[0]);
+}
+
+// Resolved on each call: the parser buffer may have been reallocated since the slice was taken
+StringView HttpRequest::view(const Slice& slice) const
+{
+	if (slice.length == 0) {
+		return (StringView());
+	}
+	return (StringView(bytes() + slice.offset, slice.length));
+}
+
+const HttpRequest::HeaderField& HttpRequest::field(size_t i) const
+{
+	if (i < REQUEST_INLINE_FIELDS) {
+		return (_fields[i]);
+	}
+	return (_extraFields[i - REQUEST_INLINE_FIELDS]);
+}
+
+size_t HttpRequest::findField(HeaderId id) const
+{
+	if (id >= HEADER_ID_COUNT || _known[id] == 0) {
+		return (_fieldCount);
+	}
+	return (_known[id] - 1);
+}
+
+// Known names go through the id index; only fields without an id are compared by name
+size_t HttpRequest::findField(const StringView& name) const
+{
+	char lower[32];
+	HeaderId id = HEADER_UNKNOWN;
+
+	if (name.size() <= sizeof(lower)) { // longer than any known name otherwise
+		for (size_t i = 0; i < name.size(); ++i) {
+			lower[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(name[i])));
+		}
+		id = HeaderNames::lookup(lower, name.size());
+	}
+	if (id != HEADER_UNKNOWN) {
+		return (findField(id));
+	}
+	for (size_t i = _fieldCount; i > 0; --i) {
+		const HeaderField& f = field(i - 1);
+		if (f.id == HEADER_UNKNOWN && view(f.name).iequals(name)) {
+			return (i - 1);
+		}
+	}
+	return (_fieldCount);
+}
+
+StringView HttpRequest::method() const
+{
+	return (view(_method));
+}
+
+HttpMethod HttpRequest::methodId() const
+{
+	return (_methodId);
+}
+
+StringView HttpRequest::uri() const
+{
+	return (view(_uri));
+}
+
+StringView HttpRequest::protocolVersion() const
+{
+	return (view(_version));
+}
+
+StringView HttpRequest::path() const
+{
+	return (view(_path));
+}
+
+StringView HttpRequest::queryString() const
+{
+	return (view(_query));
+}
+
+// Walks the key=value pairs (delimited by '&') of the query string; the last occurrence of the key wins
+StringView HttpRequest::queryParam(const StringView& key) const
+{
+	StringView query = queryString();
+	StringView found;
+	size_t pos = 0;
+
+	while (pos < query.size()) {
+		size_t amp_pos = query.find('&', pos);
+		if (amp_pos == StringView::npos) {
+			amp_pos = query.size();
+		}
+		size_t eq_pos = query.find('=', pos);
+		if (eq_pos == StringView::npos || eq_pos > amp_pos) { // lonely key
+			eq_pos = amp_pos;
+		}
+		if (query.substr(pos, eq_pos - pos) == key) {
+			found = (eq_pos < amp_pos) ? query.substr(eq_pos + 1, amp_pos - (eq_pos + 1)) : StringView("");
+		}
+		pos = amp_pos + 1;
+	}
+	return (found);
+}
+
+bool HttpRequest::hasQueryParam(const StringView& key) const
+{
+	return (queryParam(key).data() != NULL);
+}
+
+StringView HttpRequest::header(HeaderId id) const
+{
+	size_t i = findField(id);
 
-std::string HttpRequest::getHeader(const std::string& name) const
+	return (i < _fieldCount ? view(field(i).value) : StringView());
+}
+
+bool HttpRequest::hasHeader(HeaderId id) const
+{
+	return (findField(id) < _fieldCount);
+}
+
+StringView HttpRequest::header(const StringView& name) const
+{
+	size_t i = findField(name);
+
+	return (i < _fieldCount ? view(field(i).value) : StringView());
+}
+
+bool HttpRequest::hasHeader(const StringView& name) const
+{
+	return (findField(name) < _fieldCount);
+}
+
+size_t HttpRequest::headerCount() const
+{
+	return (_fieldCount);
+}
+
+StringView HttpRequest::headerName(size_t i) const
+{
+	return (view(field(i).name));
+}
+
+StringView HttpRequest::headerValue(size_t i) const
+{
+	return (view(field(i).value));
+}
+
+HeaderId HttpRequest::headerId(size_t i) const
+{
+	return (field(i).id);
+}
+
+bool HttpRequest::isOverridden(size_t i) const
+{
+	const HeaderField& f = field(i);
+
+	return ((f.id != HEADER_UNKNOWN ? findField(f.id) : findField(view(f.name))) != i);
+}
+
+size_t HttpRequest::bodySize() const
+{
+	return (spool ? spool->size() : body.size());
+}
+
+void HttpRequest::bindSource(const std::vector<char>* source, size_t begin, size_t end)
+{
+	_source = source;
+	_rawBegin = begin;
+	_rawEnd = end;
+}
+
+// Path and query string are sub-slices of the URI: nothing is copied
+void HttpRequest::setRequestLineSlices(const Slice& method, const Slice& uri, const Slice& version)
+{
+	_method = method;
+	_uri = uri;
+	_version = version;
+	_methodId = methodFromView(view(_method));
+
+	size_t query_pos = view(_uri).find('?');
+	if (query_pos != StringView::npos) {
+		_path = Slice(_uri.offset, query_pos);
+		_query = Slice(_uri.offset + query_pos + 1, _uri.length - (query_pos + 1));
+	} else {
+		_path = _uri;
+		_query = Slice();
+	}
+}
+
+void HttpRequest::addField(const Slice& name, const Slice& value, HeaderId id)
+{
+	HeaderField f;
+
+	f.name = name;
+	f.value = value;
+	f.id = id;
+	if (id < HEADER_ID_COUNT) {
+		_known[id] = static_cast<unsigned int>(_fieldCount + 1);
+	}
+	if (_fieldCount < REQUEST_INLINE_FIELDS) {
+		_fields[_fieldCount] = f;
+	} else {
+		_extraFields.push_back(f);
+	}
+	++_fieldCount;
+}
+
+HttpRequest::Slice HttpRequest::appendOwned(const std::string& str, bool lowercase)
+{
+	Slice slice(_owned.size(), str.size());
+
+	for (size_t i = 0; i < str.size(); ++i) {
+		_owned.push_back(lowercase ? static_cast<char>(std::tolower(static_cast<unsigned char>(str[i]))) : str[i]);
+	}
+	return (slice);
+}
+
+void HttpRequest::setRequestLine(const std::string& method, const std::string& uri, const std::string& version)
+{
+	retain();
+	Slice m = appendOwned(method, false);
+	Slice u = appendOwned(uri, false);
+	Slice v = appendOwned(version, false);
+	setRequestLineSlices(m, u, v);
+}
+
+// The new field comes last, so it overrides any previous one of the same name
+void HttpRequest::setHeader(const std::string& name, const std::string& value)
+{
+	retain();
+	Slice n = appendOwned(name, true);
+	Slice v = appendOwned(value, false);
+	addField(n, v, n.length ? HeaderNames::lookup(&_owned[n.offset], n.length) : HEADER_UNKNOWN);
+}
+
+// Empty slices are never resolved: their offset may be anything
+static void rebase(HttpRequest::Slice& slice, size_t base)
+{
+	slice.offset = slice.length ? slice.offset - base : 0;
+}
+
+// Copies [_rawBegin, _rawEnd) of the parser buffer and rebases every slice on the copy
+void HttpRequest::retain()
 {
-	std::string lowerName = name;
-	for (size_t i = 0; i < lowerName.length(); ++i) {
-		lowerName[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(lowerName[i])));
+	if (!_source) {
+		return;
 	}
-	std::map<std::string, std::string>::const_iterator it = headers.find(lowerName);
-	if (it != headers.end()) {
-		return (it->second);
+	const char* raw = bytes();
+	size_t base = _rawBegin;
+
+	_owned.assign(raw ? raw + _rawBegin : raw, raw ? raw + _rawEnd : raw);
+	_source = NULL;
+	_rawBegin = 0;
+	_rawEnd = _owned.size();
+
+	rebase(_method, base);
+	rebase(_uri, base);
+	rebase(_version, base);
+	rebase(_path, base);
+	rebase(_query, base);
+	for (size_t i = 0; i < _fieldCount; ++i) {
+		HeaderField& f = (i < REQUEST_INLINE_FIELDS) ? _fields[i] : _extraFields[i - REQUEST_INLINE_FIELDS];
+		rebase(f.name, base);
+		rebase(f.value, base);
 	}
-	return (""); // Return empty string if header not found
 }
 
 void HttpRequest::print() const
 {
 	std::cout << "--- HTTP Request ---\n";
-	std::cout << "Method: " << method << "\n";
-	std::cout << "URI: " << uri << "\n";
-	std::cout << "Path: " << path << "\n";
-	std::cout << "Protocol Version: " << protocolVersion << "\n";
-	std::cout << "Query Parameters:\n";
-	for (std::map<std::string, std::string>::const_iterator it = queryParams.begin(); it != queryParams.end(); ++it) {
-		std::cout << "  " << it->first << " = " << it->second << "\n";
-	}
+	std::cout << "Method: " << method() << "\n";
+	std::cout << "URI: " << uri() << "\n";
+	std::cout << "Path: " << path() << "\n";
+	std::cout << "Protocol Version: " << protocolVersion() << "\n";
+	std::cout << "Query String: " << queryString() << "\n";
 	std::cout << "Headers:\n";
-	for (std::map<std::string, std::string>::const_iterator it = headers.begin(); it != headers.end(); ++it) {
-		std::cout << "  " << it->first << ": " << it->second << "\n";
+	for (size_t i = 0; i < headerCount(); ++i) {
+		std::cout << "  " << headerName(i) << ": " << headerValue(i) << "\n";
 	}
 	std::cout << "Body Length: " << body.size() << " bytes (Expected: " << expectedBodyLength << ")\n";
 	// CHANGE: Add raw body byte dump for debugging
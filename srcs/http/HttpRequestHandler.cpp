@@ -12,6 +12,7 @@
 
 #include "../../includes/http/HttpRequestHandler.hpp" // Include its own header
 #include "../../includes/utils/StringUtils.hpp" // For StringUtils::trim, StringUtils::startsWith, StringUtils::endsWith, etc.
+#include "../../includes/http/BodySpool.hpp" // For publishing a body spooled to the upload store
 
 #include <iostream>    // For debug output
 #include <sstream>     // For string manipulation
@@ -51,6 +52,22 @@ bool HttpRequestHandler::_fileExists(const std::string& path) const {
     return stat(path.c_str(), &fileStat) == 0;
 }
 
+// Builds a 200 response whose body is the file itself, sent as a file range by the connection
+// (no read into memory here). The caller has already checked the file is regular and readable.
+HttpResponse HttpRequestHandler::_serveFile(const std::string& path) const {
+    struct stat fileStat;
+    HttpResponse response;
+
+    response.setStatus(200);
+    if (stat(path.c_str(), &fileStat) == 0) {
+        response.setBodyFile(path, static_cast<size_t>(fileStat.st_size));
+    } else {
+        response.setBody("");
+    }
+    response.addHeader("Content-Type", _getMimeType(path));
+    return response;
+}
+
 // Checks if a file/directory has read permissions
 bool HttpRequestHandler::_canRead(const std::string& path) const {
     return access(path.c_str(), R_OK) == 0;
@@ -285,8 +302,8 @@ HttpResponse HttpRequestHandler::_handleGet(const HttpRequest& request,
         return _generateErrorResponse(500, NULL, NULL); // Should not happen after dispatcher
     }
 
-    std::string fullPath = _resolvePath(request.path, serverConfig, locationConfig);
-    std::cout << "DEBUG: Attempting to serve GET for URI: " << request.uri << " from resolved path: " << fullPath << "\n";
+    std::string fullPath = _resolvePath(request.path().str(), serverConfig, locationConfig);
+    std::cout << "DEBUG: Attempting to serve GET for URI: " << request.uri() << " from resolved path: " << fullPath << "\n";
 
     if (fullPath.empty()) {
         return _generateErrorResponse(500, serverConfig, locationConfig); // Path resolution failed
@@ -317,16 +334,7 @@ HttpResponse HttpRequestHandler::_handleGet(const HttpRequest& request,
             
             std::cout << "DEBUG: Trying index file: " << indexPath << "\n";
             if (_isRegularFile(indexPath) && _canRead(indexPath)) {
-                std::ifstream file(indexPath.c_str(), std::ios::in | std::ios::binary);
-                if (file.is_open()) {
-                    HttpResponse response;
-                    response.setStatus(200);
-                    std::vector<char> fileContent((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-                    response.setBody(fileContent);
-                    response.addHeader("Content-Type", _getMimeType(indexPath));
-                    file.close();
-                    return response;
-                }
+                return _serveFile(indexPath);
             }
         }
         
@@ -343,7 +351,7 @@ HttpResponse HttpRequestHandler::_handleGet(const HttpRequest& request,
             HttpResponse response;
             response.setStatus(200);
             response.addHeader("Content-Type", "text/html");
-            response.setBody(_generateAutoindexPage(fullPath, request.path));
+            response.setBody(_generateAutoindexPage(fullPath, request.path().str()));
             return response;
         } else {
             std::cerr << "ERROR: Autoindex off and no index file for directory: " << fullPath << "\n";
@@ -357,20 +365,7 @@ HttpResponse HttpRequestHandler::_handleGet(const HttpRequest& request,
             return _generateErrorResponse(403, serverConfig, locationConfig); // Forbidden
         }
         
-        std::ifstream file(fullPath.c_str(), std::ios::in | std::ios::binary);
-        if (file.is_open()) {
-            HttpResponse response;
-            response.setStatus(200);
-            std::vector<char> fileContent((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-            response.setBody(fileContent);
-            response.addHeader("Content-Type", _getMimeType(fullPath));
-            file.close();
-            return response;
-        } else {
-            // Should be caught by _canRead or _isRegularFile, but defensive.
-            std::cerr << "ERROR: Failed to open file: " << fullPath << "\n";
-            return _generateErrorResponse(500, serverConfig, locationConfig); // Internal Server Error
-        }
+        return _serveFile(fullPath);
     }
     // --- Case 3: Path does not exist or is not a regular file/directory ---
     else {
@@ -394,7 +389,7 @@ HttpResponse HttpRequestHandler::_handlePost(const HttpRequest& request,
 
     // 2. Validate upload directory and permissions
     if (uploadStore.empty()) {
-        std::cerr << "ERROR: POST request to " << request.uri << " failed: No upload_store configured for matched location.\n";
+        std::cerr << "ERROR: POST request to " << request.uri() << " failed: No upload_store configured for matched location.\n";
         return _generateErrorResponse(500, serverConfig, locationConfig); // Server misconfiguration
     }
     
@@ -403,47 +398,50 @@ HttpResponse HttpRequestHandler::_handlePost(const HttpRequest& request,
         // Permissions 0755: rwxr-xr-x (owner can read/write/execute, group/others can read/execute)
         // This is a common default for directories that need to be web-writable.
         if (mkdir(uploadStore.c_str(), S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH) != 0) {
-            std::cerr << "ERROR: POST request to " << request.uri << " failed: Upload store path is not a directory or cannot be created: " << uploadStore << ". Errno: " << strerror(errno) << "\n";
+            std::cerr << "ERROR: POST request to " << request.uri() << " failed: Upload store path is not a directory or cannot be created: " << uploadStore << ". Errno: " << strerror(errno) << "\n";
             return _generateErrorResponse(500, serverConfig, locationConfig); // Internal Server Error
         }
         std::cout << "INFO: Created upload directory: " << uploadStore << "\n";
     } else if (!_isDirectory(uploadStore)) {
-        std::cerr << "ERROR: POST request to " << request.uri << " failed: Upload store path exists but is not a directory: " << uploadStore << "\n";
+        std::cerr << "ERROR: POST request to " << request.uri() << " failed: Upload store path exists but is not a directory: " << uploadStore << "\n";
         return _generateErrorResponse(500, serverConfig, locationConfig); // Internal Server Error
     }
 
     if (!_canWrite(uploadStore)) {
-        std::cerr << "ERROR: POST request to " << request.uri << " failed: Upload store directory not writable: " << uploadStore << "\n";
+        std::cerr << "ERROR: POST request to " << request.uri() << " failed: Upload store directory not writable: " << uploadStore << "\n";
         return _generateErrorResponse(403, serverConfig, locationConfig); // Forbidden
     }
 
     // 3. Check Content-Length against client_max_body_size
-    std::string contentLengthStr = request.getHeader("content-length");
+    std::string contentLengthStr = request.header(HEADER_CONTENT_LENGTH).str();
     long contentLength = 0;
     if (!contentLengthStr.empty()) {
         try {
             contentLength = StringUtils::stringToLong(contentLengthStr);
         } catch (const std::exception& e) {
-            std::cerr << "ERROR: POST request to " << request.uri << " failed: Invalid Content-Length header: " << contentLengthStr << ". " << e.what() << "\n";
+            std::cerr << "ERROR: POST request to " << request.uri() << " failed: Invalid Content-Length header: " << contentLengthStr << ". " << e.what() << "\n";
             return _generateErrorResponse(400, serverConfig, locationConfig); // Bad Request
         }
+    } else if (request.hasHeader(HEADER_TRANSFER_ENCODING)) {
+        // Chunked body (the parser only accepts "chunked"): its size is known once decoded
+        contentLength = static_cast<long>(request.bodySize());
     } else {
-        // If no Content-Length, but there's a body, it's a protocol error (unless chunked, which we don't handle yet)
-        if (!request.body.empty()) {
-            std::cerr << "ERROR: POST request to " << request.uri << " failed: Missing Content-Length header with non-empty body.\n";
+        // If no Content-Length, but there's a body, it's a protocol error
+        if (request.bodySize() > 0) {
+            std::cerr << "ERROR: POST request to " << request.uri() << " failed: Missing Content-Length header with non-empty body.\n";
             return _generateErrorResponse(411, serverConfig, locationConfig); // Length Required
         }
     }
     
     // If request body size exceeds maxBodySize, return 413
     if (contentLength > maxBodySize) {
-        std::cerr << "ERROR: POST request to " << request.uri << " failed: Payload too large (" << contentLength << " bytes > " << maxBodySize << " bytes).\n";
+        std::cerr << "ERROR: POST request to " << request.uri() << " failed: Payload too large (" << contentLength << " bytes > " << maxBodySize << " bytes).\n";
         return _generateErrorResponse(413, serverConfig, locationConfig); // Payload Too Large
     }
 
     // 4. Generate a unique filename
     std::string originalFilename = "uploaded_file"; // Default if no filename provided
-    std::string contentDisposition = request.getHeader("content-disposition");
+    std::string contentDisposition = request.header(HEADER_CONTENT_DISPOSITION).str();
     // This is a basic attempt to parse filename from Content-Disposition header (e.g., for multipart/form-data)
     size_t filenamePos = contentDisposition.find("filename=");
     if (filenamePos != std::string::npos) {
@@ -492,22 +490,30 @@ HttpResponse HttpRequestHandler::_handlePost(const HttpRequest& request,
     fullUploadPath += uniqueFilename;
 
     // 5. Write the request body to the file
-    // Using std::ios::trunc to create/overwrite the file.
-    std::ofstream outputFile(fullUploadPath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
-    if (!outputFile.is_open()) {
-        std::cerr << "ERROR: POST request to " << request.uri << " failed: Could not open file for writing: " << fullUploadPath << ". Errno: " << strerror(errno) << "\n";
-        return _generateErrorResponse(500, serverConfig, locationConfig); // Internal Server Error
-    }
+    // A body spooled to disk while it was received is already in the upload store: it only gets its name
+    if (request.spool) {
+        if (!request.spool->publish(fullUploadPath)) {
+            std::cerr << "ERROR: POST request to " << request.uri() << " failed: Could not publish spooled body to: " << fullUploadPath << ". Errno: " << strerror(errno) << "\n";
+            return _generateErrorResponse(500, serverConfig, locationConfig); // Internal Server Error
+        }
+    } else {
+        // Using std::ios::trunc to create/overwrite the file.
+        std::ofstream outputFile(fullUploadPath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!outputFile.is_open()) {
+            std::cerr << "ERROR: POST request to " << request.uri() << " failed: Could not open file for writing: " << fullUploadPath << ". Errno: " << strerror(errno) << "\n";
+            return _generateErrorResponse(500, serverConfig, locationConfig); // Internal Server Error
+        }
 
-    // Write the raw body content. request.body is a std::vector<char>
-    if (!request.body.empty()) {
-        outputFile.write(request.body.data(), request.body.size());
-    }
-    outputFile.close();
+        // Write the raw body content. request.body is a std::vector<char>
+        if (!request.body.empty()) {
+            outputFile.write(request.body.data(), request.body.size());
+        }
+        outputFile.close();
 
-    if (outputFile.fail()) { // Check for errors after closing
-        std::cerr << "ERROR: POST request to " << request.uri << " failed: Error writing to file: " << fullUploadPath << ". Errno: " << strerror(errno) << "\n";
-        return _generateErrorResponse(500, serverConfig, locationConfig); // Internal Server Error
+        if (outputFile.fail()) { // Check for errors after closing
+            std::cerr << "ERROR: POST request to " << request.uri() << " failed: Error writing to file: " << fullUploadPath << ". Errno: " << strerror(errno) << "\n";
+            return _generateErrorResponse(500, serverConfig, locationConfig); // Internal Server Error
+        }
     }
 
     std::cout << "INFO: Successfully uploaded file to: " << fullUploadPath << "\n";
@@ -517,7 +523,7 @@ HttpResponse HttpRequestHandler::_handlePost(const HttpRequest& request,
     response.setStatus(201); // 201 Created
     
     // Construct the Location header: /upload/original_filename (without timestamp for TC12)
-    std::string locationHeaderUri = request.uri;
+    std::string locationHeaderUri = request.uri().str();
     if (!StringUtils::endsWith(locationHeaderUri, "/")) {
         locationHeaderUri += "/"; // Ensure trailing slash for directory upload URI
     }
@@ -543,10 +549,10 @@ HttpResponse HttpRequestHandler::_handleDelete(const HttpRequest& request,
     // Determine the full path for deletion based on whether it's within an upload_store location
     // This is crucial: if a location block for /uploads exists and has an upload_store,
     // DELETE requests to /uploads/filename.txt should delete from upload_store/filename.txt
-    if (locationConfig && !locationConfig->uploadStore.empty() && StringUtils::startsWith(request.path, locationConfig->path)) {
-        // Example: locationConfig->path = "/uploads", request.path = "/uploads/my_file.txt"
+    if (locationConfig && !locationConfig->uploadStore.empty() && request.path().startsWith(locationConfig->path)) {
+        // Example: locationConfig->path = "/uploads", request.path() = "/uploads/my_file.txt"
         // relativePath will be "my_file.txt"
-        std::string relativePath = request.path.substr(locationConfig->path.length());
+        std::string relativePath = request.path().substr(locationConfig->path.length()).str();
         
         // Ensure the uploadStore path has a trailing slash for consistent concatenation
         std::string baseUploadPath = locationConfig->uploadStore;
@@ -556,7 +562,7 @@ HttpResponse HttpRequestHandler::_handleDelete(const HttpRequest& request,
 
         // Handle leading slash in relativePath correctly to avoid double slashes.
         // If relativePath is "/my_file.txt", remove the leading '/'.
-        // If relativePath is "", it means request.path was exactly locationConfig->path.
+        // If relativePath is "", it means request.path() was exactly locationConfig->path.
         if (!relativePath.empty() && relativePath[0] == '/') {
             relativePath = relativePath.substr(1);
         }
@@ -565,25 +571,25 @@ HttpResponse HttpRequestHandler::_handleDelete(const HttpRequest& request,
     } else {
         // Otherwise, use the standard root-based path resolution for deletion.
         // This handles cases where DELETE might be allowed on other static files.
-        fullPath = _resolvePath(request.path, serverConfig, locationConfig);
+        fullPath = _resolvePath(request.path().str(), serverConfig, locationConfig);
     }
 
-    std::cout << "DEBUG: Attempting to DELETE URI: " << request.uri << " from resolved path: " << fullPath << "\n";
+    std::cout << "DEBUG: Attempting to DELETE URI: " << request.uri() << " from resolved path: " << fullPath << "\n";
 
     if (fullPath.empty()) {
-        std::cerr << "ERROR: DELETE request for " << request.uri << " failed: Path resolution returned empty.\n";
+        std::cerr << "ERROR: DELETE request for " << request.uri() << " failed: Path resolution returned empty.\n";
         return _generateErrorResponse(500, serverConfig, locationConfig); // Path resolution failed
     }
 
     // 2. Check if the file exists
     if (!_fileExists(fullPath)) {
-        std::cerr << "ERROR: DELETE request for " << request.uri << " failed: File not found at " << fullPath << "\n";
+        std::cerr << "ERROR: DELETE request for " << request.uri() << " failed: File not found at " << fullPath << "\n";
         return _generateErrorResponse(404, serverConfig, locationConfig); // Not Found
     }
 
     // 3. Ensure it's a regular file and not a directory (we only delete files)
     if (!_isRegularFile(fullPath)) {
-        std::cerr << "ERROR: DELETE request for " << request.uri << " failed: Path is not a regular file (e.g., it's a directory): " << fullPath << "\n";
+        std::cerr << "ERROR: DELETE request for " << request.uri() << " failed: Path is not a regular file (e.g., it's a directory): " << fullPath << "\n";
         // It's generally a 403 Forbidden to try to delete a directory with DELETE, or 409 Conflict.
         // For now, 403 is acceptable per common server behavior for this type of misrequest.
         return _generateErrorResponse(403, serverConfig, locationConfig);
@@ -606,21 +612,21 @@ HttpResponse HttpRequestHandler::_handleDelete(const HttpRequest& request,
     }
 
     if (!_canWrite(parentDir)) {
-        std::cerr << "ERROR: DELETE request for " << request.uri << " failed: No write permissions on parent directory " << parentDir << " for file " << fullPath << ". Errno: " << strerror(errno) << "\n";
+        std::cerr << "ERROR: DELETE request for " << request.uri() << " failed: No write permissions on parent directory " << parentDir << " for file " << fullPath << ". Errno: " << strerror(errno) << "\n";
         return _generateErrorResponse(403, serverConfig, locationConfig); // Forbidden
     }
     
     // As a defensive measure, explicitly check write permission on the file itself.
     // If the file is not writable, even if the parent directory is, we should return 403.
     if (!_canWrite(fullPath)) {
-        std::cerr << "ERROR: DELETE request for " << request.uri << " failed: No write permissions on file " << fullPath << ". Errno: " << strerror(errno) << "\n";
+        std::cerr << "ERROR: DELETE request for " << request.uri() << " failed: No write permissions on file " << fullPath << ". Errno: " << strerror(errno) << "\n";
         return _generateErrorResponse(403, serverConfig, locationConfig); // Forbidden
     }
 
 
     // 5. Attempt to delete the file
     if (std::remove(fullPath.c_str()) != 0) {
-        std::cerr << "ERROR: DELETE request for " << request.uri << " failed: Error deleting file " << fullPath << ". Errno: " << strerror(errno) << "\n";
+        std::cerr << "ERROR: DELETE request for " << request.uri() << " failed: Error deleting file " << fullPath << ". Errno: " << strerror(errno) << "\n";
         // Provide more specific error codes if `errno` indicates known issues
         if (errno == EACCES) { // Permission denied (e.g., parent dir not writable, or file is immutable)
             return _generateErrorResponse(403, serverConfig, locationConfig);
@@ -721,14 +727,45 @@ HttpResponse HttpRequestHandler::handleRequest(const HttpRequest& request, const
     // If no specific location matches, the locationConfig will be NULL.
     // The handler must be prepared to use server-level defaults.
 
+    // --- 1. Redirection, allowed methods, announced body size: settled from the head ---
+    HttpResponse headResponse;
+    if (answerFromHead(request, matchedConfig, headResponse)) {
+        return headResponse;
+    }
+    HttpMethod reqMethodEnum = request.methodId(); // HTTP_UNKNOWN for methods unsupported by the server
+
+    // --- 2. Handle Request Method ---
+    if (reqMethodEnum == HTTP_GET) {
+        return _handleGet(request, serverConfig, locationConfig);
+    } else if (reqMethodEnum == HTTP_POST) {
+        return _handlePost(request, serverConfig, locationConfig);
+    } else if (reqMethodEnum == HTTP_DELETE) {
+        return _handleDelete(request, serverConfig, locationConfig);
+    } else {
+        // Unknown or unsupported method by server
+        std::cerr << "ERROR: Unsupported method: " << request.method() << "\n";
+        return _generateErrorResponse(501, serverConfig, locationConfig); // Not Implemented
+    }
+}
+
+// Checks needing only the head: run by the connection as soon as the head is complete
+// (before the body is read or a 100 Continue is sent), and by handleRequest
+bool HttpRequestHandler::answerFromHead(const HttpRequest& request, const MatchedConfig& matchedConfig, HttpResponse& response) {
+    const ServerConfig* serverConfig = matchedConfig.server_config;
+    const LocationConfig* locationConfig = matchedConfig.location_config;
+
+    if (!serverConfig) {
+        return false; // handleRequest answers 500
+    }
+
     // --- 1. Handle Redirections (if configured) ---
     if (locationConfig && locationConfig->returnCode != 0) {
-        HttpResponse response;
+        response = HttpResponse();
         response.setStatus(locationConfig->returnCode);
         response.addHeader("Location", locationConfig->returnUrlOrText);
         response.setBody("Redirecting to " + locationConfig->returnUrlOrText); // Simple body
-        std::cout << "DEBUG: Redirecting " << request.uri << " to " << locationConfig->returnUrlOrText << " with status " << locationConfig->returnCode << "\n";
-        return response;
+        std::cout << "DEBUG: Redirecting " << request.uri() << " to " << locationConfig->returnUrlOrText << " with status " << locationConfig->returnCode << "\n";
+        return true;
     }
 
     // --- 2. Check Allowed Methods ---
@@ -746,12 +783,7 @@ HttpResponse HttpRequestHandler::handleRequest(const HttpRequest& request, const
     }
 
     bool methodAllowed = false;
-    HttpMethod reqMethodEnum;
-    // Convert request.method string to enum for comparison
-    if (request.method == "GET") reqMethodEnum = HTTP_GET;
-    else if (request.method == "POST") reqMethodEnum = HTTP_POST;
-    else if (request.method == "DELETE") reqMethodEnum = HTTP_DELETE;
-    else reqMethodEnum = HTTP_UNKNOWN; // For unsupported methods by your server
+    HttpMethod reqMethodEnum = request.methodId(); // HTTP_UNKNOWN for methods unsupported by the server
 
     for (size_t i = 0; i < allowedMethods.size(); ++i) {
         if (allowedMethods[i] == reqMethodEnum) {
@@ -761,8 +793,8 @@ HttpResponse HttpRequestHandler::handleRequest(const HttpRequest& request, const
     }
 
     if (!methodAllowed) {
-        std::cerr << "ERROR: Method " << request.method << " not allowed for path " << request.path << "\n";
-        HttpResponse response = _generateErrorResponse(405, serverConfig, locationConfig); // Method Not Allowed
+        std::cerr << "ERROR: Method " << request.method() << " not allowed for path " << request.path() << "\n";
+        response = _generateErrorResponse(405, serverConfig, locationConfig); // Method Not Allowed
         // Build the Allow header string for 405 response
         std::string allowHeaderValue;
         for (size_t i = 0; i < allowedMethods.size(); ++i) {
@@ -773,20 +805,16 @@ HttpResponse HttpRequestHandler::handleRequest(const HttpRequest& request, const
             else if (allowedMethods[i] == HTTP_DELETE) allowHeaderValue += "DELETE";
         }
         response.addHeader("Allow", allowHeaderValue);
-        return response;
+        return true;
     }
 
-
-    // --- 3. Handle Request Method ---
-    if (request.method == "GET") {
-        return _handleGet(request, serverConfig, locationConfig);
-    } else if (request.method == "POST") {
-        return _handlePost(request, serverConfig, locationConfig);
-    } else if (request.method == "DELETE") {
-        return _handleDelete(request, serverConfig, locationConfig);
-    } else {
-        // Unknown or unsupported method by server
-        std::cerr << "ERROR: Unsupported method: " << request.method << "\n";
-        return _generateErrorResponse(501, serverConfig, locationConfig); // Not Implemented
+    // --- 3. Announced body size, whatever the method (a chunked body is checked as it is decoded) ---
+    long maxBodySize = _getEffectiveClientMaxBodySize(serverConfig, locationConfig);
+    if (maxBodySize > 0 && !request.hasHeader(HEADER_TRANSFER_ENCODING)
+        && request.expectedBodyLength > static_cast<size_t>(maxBodySize)) {
+        std::cerr << "ERROR: " << request.method() << " request to " << request.uri() << " refused: Payload too large (" << request.expectedBodyLength << " bytes > " << maxBodySize << " bytes).\n";
+        response = _generateErrorResponse(413, serverConfig, locationConfig); // Payload Too Large
+        return true;
     }
+    return false;
 }
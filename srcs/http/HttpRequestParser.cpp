@@ -14,7 +14,6 @@
 #include "../../includes/utils/StringUtils.hpp" // For trim, isDigits, stringToLong
 
 #include <iostream>
-#include <sstream> // For std::istringstream
 #include <cctype>  // For std::tolower, std::isspace (used in StringUtils if not already there)
 
 // Implementation of httpMethodToString (for debugging/printing, optional but good practice)
@@ -29,7 +28,9 @@ std::string httpMethodToString(HttpMethod method) {
 }
 
 // Default constructor
-HttpRequestParser::HttpRequestParser() : _request() {
+HttpRequestParser::HttpRequestParser() : _request(), _readPos(0), _maxLine(DEFAULT_MAX_HEADER_LINE),
+    _maxHead(DEFAULT_MAX_HEAD), _errorStatus(400), _maxBody(0), _isChunked(false),
+    _spool(_request.body), _router(NULL) {
     _request.currentState = HttpRequest::RECV_REQUEST_LINE;
 }
 
@@ -37,246 +38,317 @@ HttpRequestParser::HttpRequestParser() : _request() {
 HttpRequestParser::~HttpRequestParser() {
 }
 
-// Appends new raw data to the internal buffer
+// Appends new raw data. While a body is expected and nothing else is pending, the bytes go straight
+// to the body spool (through the chunked decoder if needed): no stay in the buffer, no second copy.
+// The rest goes to the buffer, which is
+// compacted here only when the consumed part outweighs the unread one (amortized, never per request).
+// Once the request line is parsed the request holds slices into the buffer: nothing moves until reset().
 void HttpRequestParser::appendData(const char* data, size_t len) {
-    if (data && len > 0) {
-        _buffer.insert(_buffer.end(), data, data + len);
+    if (!data || len == 0) {
+        return;
+    }
+    if (_request.currentState == HttpRequest::RECV_BODY && unreadSize() == 0) {
+        size_t n;
+
+        if (_isChunked) {
+            n = _chunked.decode(data, len, _spool); // stops at the end of the body, or on an error
+        } else {
+            size_t missing = _request.expectedBodyLength - _spool.size();
+
+            n = (len < missing) ? len : missing;
+            _spool.write(data, n);
+        }
+        data += n;
+        len -= n;
+        if (len == 0) {
+            return;
+        }
+    }
+    if (_request.currentState != HttpRequest::RECV_REQUEST_LINE) {
+        // head pinned: append only (a reallocation keeps the offsets)
+    } else if (_readPos == _buffer.size()) {
+        _buffer.clear(); // everything consumed: restart at the front, no byte to move
+        _readPos = 0;
+    } else if (_readPos > 0 && _readPos >= _buffer.size() - _readPos) {
+        _buffer.erase(_buffer.begin(), _buffer.begin() + _readPos); // moves fewer bytes than were consumed
+        _readPos = 0;
+    }
+    _buffer.insert(_buffer.end(), data, data + len);
+}
+
+const char* HttpRequestParser::unreadData() const {
+    return _buffer.empty() ? NULL : &_buffer[0] + _readPos;
+}
+
+size_t HttpRequestParser::unreadSize() const {
+    return _buffer.size() - _readPos;
+}
+
+// Scan the buffered head: request line end and spaces, every header line and its colon, end of the head.
+// The head stays in the buffer until it is complete, so the offsets remain valid and the scan resumes
+// where it stopped: a head received one byte at a time costs the same as a head received at once.
+void HttpRequestParser::scanHead() {
+    if (unreadSize() == 0) {
+        return;
     }
+    HeadScanner::scan(unreadData(), unreadSize(), _head);
+    if (_head.malformed) {
+        setError("Malformed line ending: lines must end with CRLF.");
+        return;
+    }
+    checkHeadLimits();
 }
 
-// Helper to find a substring (pattern) within a std::vector<char> same as std::string::find but for vectors
-size_t HttpRequestParser::findInVector(const std::string& pattern) {
-    if (_buffer.empty() || pattern.empty() || pattern.length() > _buffer.size()) {
-        return std::string::npos;
+// Limits are checked on what is received so far, so an oversized head is refused before it is complete
+bool HttpRequestParser::checkHeadLimits() {
+    size_t received = _head.headEnd ? _head.headEnd : unreadSize();
+
+    if (_head.lineEnd == std::string::npos ? received > _maxLine : _head.lineEnd > _maxLine) {
+        setError("Request line too long.", 414);
+        return false;
     }
-    for (size_t i = 0; i <= _buffer.size() - pattern.length(); ++i) {
-        bool match = true;
-        for (size_t j = 0; j < pattern.length(); ++j) {
-            if (_buffer[i+j] != pattern[j]) {
-                match = false;
-                break;
-            }
-        }
-        if (match) {
-            return i;
+    if (received > _maxHead) {
+        setError("Request header block too large.", 431);
+        return false;
+    }
+    if (!_head.headEnd && !_head.inRequestLine && received - _head.lineStart > _maxLine) {
+        setError("Request header line too long.", 431);
+        return false;
+    }
+    for (size_t i = 0; _head.headEnd && i < _head.headers.size(); ++i) { // once, when the head is complete
+        if (_head.headers[i].end - _head.headers[i].start > _maxLine) {
+            setError("Request header line too long.", 431);
+            return false;
         }
     }
-    return std::string::npos;
+    return true;
 }
 
-// remove parsed data from the beginning of _buffer that have already been parsed and processed
+// mark parsed data at the read cursor as consumed: only the cursor moves, the bytes stay until
+// appendData or reset() compacts the buffer (the request may still point into them)
 void HttpRequestParser::consumeBuffer(size_t count) {
-    if (count > _buffer.size()) { // guard against count > buffer : should never happen
-        _buffer.clear();
-    } else {
-        _buffer.erase(_buffer.begin(), _buffer.begin() + count); // normal way to remove the beginning of _buffer
-    }
+    _readPos += (count < unreadSize()) ? count : unreadSize();
 }
 
 // set the error state and potentially log a message
-void HttpRequestParser::setError(const std::string& msg) {
+void HttpRequestParser::setError(const std::string& msg, int status) {
     _request.currentState = HttpRequest::ERROR;
+    _errorStatus = status;
     std::cerr << "HTTP Parsing Error: " << msg << std::endl;
 }
 
 // parsing the request line, first of 3-part request (request line, headers, body)
 void HttpRequestParser::parseRequestLine() {
-    // 1 - find the end of the request line : reached at the first crlf
-    size_t crlf_pos = findInVector(CRLF);
-
-    if (crlf_pos == std::string::npos) { 
+    // 1 - find the end of the request line : the scanner also finds the header lines in the same pass
+    scanHead();
+    if (hasError()) {
+        return;
+    }
+    if (_head.lineEnd == std::string::npos) {
         return; // not enough data yet, wait for more
     }
 
-    // 2 - extract the request line up to crlf_pos
-    std::string requestLine( _buffer.begin(), _buffer.begin() + crlf_pos );
-    
-    // 3 - parse the method : should be the first word
-    size_t first_space = requestLine.find(' ');
+    // 2 - the request line is [0, lineEnd), its two spaces are already located.
+    // Its components are slices of the buffer: offsets from the buffer start, which stays pinned
+    size_t base = _readPos;
+    size_t first_space = _head.firstSpace;
+    size_t second_space = _head.secondSpace;
+
+    // 3 - the method should be the first word
     if (first_space == std::string::npos) {
         setError("Malformed request line: Missing method or URI.");
         return;
     }
-    _request.method = requestLine.substr(0, first_space); // Store raw string method
 
-    // 4 - parse the URI : should be the second word
-    size_t second_space = requestLine.find(' ', first_space + 1);
+    // 4 - the URI should be the second word
     if (second_space == std::string::npos) {
         setError("Malformed request line: Missing URI or protocol version.");
         return;
     }
-    _request.uri = requestLine.substr(first_space + 1, second_space - (first_space + 1));
 
-    // 5 - parse the protocol version : should be the last word
-    _request.protocolVersion = requestLine.substr(second_space + 1);
+    // 5 - the protocol version should be the last word. Path and query parameters are known from the URI
+    _request.bindSource(&_buffer, base, base + _head.lineEnd);
+    _request.setRequestLineSlices(HttpRequest::Slice(base, first_space),
+                                  HttpRequest::Slice(base + first_space + 1, second_space - (first_space + 1)),
+                                  HttpRequest::Slice(base + second_space + 1, _head.lineEnd - (second_space + 1)));
 
     // 6 - basic validation
-    if (_request.method.empty() || _request.uri.empty() || _request.protocolVersion.empty()) {
+    if (_request.method().empty() || _request.uri().empty() || _request.protocolVersion().empty()) {
         setError("Malformed request line: Empty component.");
         return;
     }
-    if (_request.protocolVersion != "HTTP/1.1") {
+    if (_request.protocolVersion() != "HTTP/1.1") {
         setError("Unsupported protocol version. Only HTTP/1.1 is supported.");
         return;
     }
     // Note: Validation if method is GET/POST/DELETE occurs in later logic.
-    // Here, we just store the string and ensure basic format.
-
-    // 7 - consume and advance
-    consumeBuffer(crlf_pos + CRLF.length());
-
-    // Decompose URI here, as path and query parameters are known after the request line
-    decomposeURI(); 
+    // Here, we just store the slice and ensure basic format.
 
+    // 7 - advance : the request line stays in the buffer until the request is done
     _request.currentState = HttpRequest::RECV_HEADERS;
 }
 
 // parsing headers, second of 3-part request
 void HttpRequestParser::parseHeaders() {
-    // FIX: Handle the special case where headers are empty.
-    // If the buffer contains exactly "\r\n" after the request line, it means the entire
-    // request was "Request-Line\r\n\r\n", signifying no headers and end of request.
-    if (_buffer.size() == CRLF.length() && _buffer[0] == '\r' && _buffer[1] == '\n') {
-        consumeBuffer(CRLF.length()); // Consume the final CRLF that signifies empty headers
-        _request.currentState = HttpRequest::COMPLETE;
-        // No extraneous data check needed here, as we specifically matched exact content.
-        return;
+    // Rescan only if more data arrived since the request line was parsed
+    if (_head.headEnd == 0) {
+        scanHead();
+        if (hasError()) {
+            return;
+        }
     }
-    
-    // Normal header parsing: Look for the DOUBLE_CRLF (end of header block)
-    size_t double_crlf_pos = findInVector(DOUBLE_CRLF);
-
-    if (double_crlf_pos == std::string::npos) {
+    if (_head.headEnd == 0) {
         return; // Not enough data for the full headers block, wait for more.
     }
 
-    // Extract and parse actual headers (if any)
-    std::string allHeaders( _buffer.begin(), _buffer.begin() + double_crlf_pos );
-    std::istringstream iss(allHeaders);
-    std::string line;
+    // Every header line is already delimited: [start, colon) is the name, (colon, end) the value.
+    // The fields are slices of the buffer; names are lowercased in place, then resolved to a HeaderId
+    size_t base = _readPos;
+    char* data = &_buffer[base];
 
-    while (std::getline(iss, line, '\r')) {
-        if (!line.empty() && line[0] == '\n') {
-            line = line.substr(1);
-        }
-        if (line.empty()) continue; // Skip actual empty lines within headers
+    for (size_t i = 0; i < _head.headers.size(); ++i) {
+        const HeadLine& line = _head.headers[i];
 
-        size_t colon_pos = line.find(':');
-        if (colon_pos == std::string::npos) {
+        if (line.colon == std::string::npos) {
             setError("Malformed header line: Missing colon.");
             return;
         }
 
-        std::string name = line.substr(0, colon_pos);
-        std::string value = line.substr(colon_pos + 1);
+        // Trim on the offsets, nothing is copied
+        size_t nameStart = line.start;
+        size_t nameEnd = line.colon;
+        size_t valueStart = line.colon + 1;
+        size_t valueEnd = line.end;
+
+        while (nameStart < nameEnd && std::isspace(static_cast<unsigned char>(data[nameStart]))) ++nameStart;
+        while (nameEnd > nameStart && std::isspace(static_cast<unsigned char>(data[nameEnd - 1]))) --nameEnd;
+        while (valueStart < valueEnd && std::isspace(static_cast<unsigned char>(data[valueStart]))) ++valueStart;
+        while (valueEnd > valueStart && std::isspace(static_cast<unsigned char>(data[valueEnd - 1]))) --valueEnd;
 
-        StringUtils::trim(name);
-        StringUtils::trim(value);
-        
-        std::string canonicalName = name;
-        for (size_t i = 0; i < canonicalName.length(); ++i) {
-            canonicalName[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(canonicalName[i])));
+        for (size_t j = nameStart; j < nameEnd; ++j) {
+            data[j] = static_cast<char>(std::tolower(static_cast<unsigned char>(data[j])));
+        }
+        _request.addField(HttpRequest::Slice(base + nameStart, nameEnd - nameStart),
+                          HttpRequest::Slice(base + valueStart, valueEnd - valueStart),
+                          HeaderNames::lookup(data + nameStart, nameEnd - nameStart));
+    }
+    _request.bindSource(&_buffer, base, base + _head.headEnd);
+
+    // Process Transfer-Encoding header: only "chunked" is supported, and it cannot come with a Content-Length
+    _isChunked = _request.hasHeader(HEADER_TRANSFER_ENCODING);
+    if (_isChunked) {
+        if (!_request.header(HEADER_TRANSFER_ENCODING).iequals("chunked")) {
+            setError("Unsupported Transfer-Encoding: " + _request.header(HEADER_TRANSFER_ENCODING).str(), 501);
+            return;
+        }
+        if (_request.hasHeader(HEADER_CONTENT_LENGTH)) {
+            setError("Both Content-Length and Transfer-Encoding headers present.");
+            return;
         }
-        _request.headers[canonicalName] = value;
     }
 
     // Process Content-Length header
-    std::string contentLengthStr = _request.getHeader("content-length");
-    if (!contentLengthStr.empty()) {
+    StringView contentLength = _request.header(HEADER_CONTENT_LENGTH);
+    if (!contentLength.empty()) {
+        long length;
+
         try {
-            _request.expectedBodyLength = StringUtils::stringToLong(contentLengthStr);
+            length = StringUtils::stringToLong(contentLength.str());
         } catch (const std::exception& e) {
             setError("Invalid Content-Length header: " + std::string(e.what()));
             return;
         }
+        if (length < 0 || contentLength[0] == '+') { // only digits (RFC 9110, 8.6)
+            setError("Invalid Content-Length header: " + contentLength.str());
+            return;
+        }
+        _request.expectedBodyLength = static_cast<size_t>(length);
     } else {
-        if (_request.method == "POST") {
+        if (_request.methodId() == HTTP_POST && !_isChunked) {
             setError("Content-Length header missing for POST request.");
             return;
         }
     }
     
-    // Consume the parsed headers and the DOUBLE_CRLF from the buffer
-    consumeBuffer(double_crlf_pos + DOUBLE_CRLF.length());
+    // Consume the whole head (request line, headers and the empty line): the bytes stay for the slices
+    consumeBuffer(_head.headEnd);
+    _head.clear();
+
+    // The head is complete, no body byte read yet: route it now. The route sets the body limit,
+    // or answers the request from its head (redirection, method, size...) without its body.
+    // A body announced by any method is part of this request, never the start of the next one
+    bool bodyFollows = _isChunked || _request.expectedBodyLength > 0;
+    int refused = _router ? _router->routeRequest(_request, bodyFollows) : 0;
+
+    if (refused) {
+        setError("Request answered from its head, body not read.", refused);
+        return;
+    }
 
     // Determine the next state
-    if (_request.method == "POST" && _request.expectedBodyLength > 0) {
+    if (_isChunked) { // whatever the method: the body must be read to find the next request
+        _chunked.reset();
+        _chunked.setLimit(_maxBody);
+        _request.currentState = HttpRequest::RECV_BODY;
+    } else if (_request.expectedBodyLength > 0) { // whatever the method, read before the next request
+        if (_maxBody && _request.expectedBodyLength > _maxBody) { // refused before the body is sent
+            setError("Content-Length larger than client_max_body_size.", 413);
+            return;
+        }
         _request.currentState = HttpRequest::RECV_BODY;
     } else {
         _request.currentState = HttpRequest::COMPLETE;
     }
-
-    // Check for extraneous data after request completion
-    if (_request.currentState == HttpRequest::COMPLETE && !_buffer.empty()) {
-        setError("Extraneous data after end of headers for request with no body.");
-        return;
-    }
+    // Bytes left in the buffer belong to the next pipelined request: they stay for reset()
 }
 
 // parsing the request body (optionnal), last part of a request
 void HttpRequestParser::parseBody() {
-    // 1 - non blocking guard : check if the entire body is in the buffer
-    if (_buffer.size() < _request.expectedBodyLength) {
-        return; // not enough data yet, wait for more
+    if (_isChunked) {
+        parseChunkedBody();
+        return;
     }
+    // 1 - body bytes that arrived with the head are still in the buffer: move them once.
+    // Later ones are appended to the body directly by appendData
+    size_t missing = _request.expectedBodyLength - _spool.size();
+    size_t n = (unreadSize() < missing) ? unreadSize() : missing;
 
-    // 2 - copy the buffer into the HttpRequest's body vector
-    _request.body.insert(_request.body.end(), _buffer.begin(), _buffer.begin() + _request.expectedBodyLength);
-    
-    // 3 - consume the parsed body data from the buffer
-    consumeBuffer(_request.expectedBodyLength);
+    if (_spool.size() == 0 && !_spool.expect(_request.expectedBodyLength)) { // memory only for a body kept there
+        _request.body.reserve(_request.expectedBodyLength < BODY_RESERVE_MAX ? _request.expectedBodyLength : BODY_RESERVE_MAX);
+    }
+    if (n > 0) {
+        _spool.write(unreadData(), n);
+        consumeBuffer(n);
+    }
+
+    // 2 - non blocking guard : wait until the entire body is there
+    if (_spool.size() < _request.expectedBodyLength) {
+        return; // not enough data yet, wait for more
+    }
 
-    // 4 - update parsing state
+    // 3 - update parsing state (anything left is the next pipelined request)
+    _request.spool = _spool.inFile() ? &_spool : NULL;
     _request.currentState = HttpRequest::COMPLETE;
+}
 
-    // CHANGE: Check for extraneous data after the body.
-    if (!_buffer.empty()) { // If there's anything left in the buffer after body is consumed
-        setError("Extraneous data after end of body.");
+// chunked body: buffered bytes go through the decoder (later ones are decoded by appendData directly).
+// Only decoded data is kept, never the encoded stream
+void HttpRequestParser::parseChunkedBody() {
+    consumeBuffer(_chunked.decode(unreadData(), unreadSize(), _spool));
+    if (_chunked.hasError()) {
+        setError(_chunked.getErrorMessage(), _chunked.getErrorStatus());
         return;
     }
-}
-
-// Decomposes the URI into path and query parameters (/search?key1=value1&key2=value2&key3=value3)
-void HttpRequestParser::decomposeURI() {
-    // 1 - check for presence of query string
-    size_t query_pos = _request.uri.find('?');
-    if (query_pos != std::string::npos) { // query string found
-        // 2 - extract query path
-        _request.path = _request.uri.substr(0, query_pos);
-
-        // 3 - extract raw query string
-        std::string queryString = _request.uri.substr(query_pos + 1);
-        
-        // 4 - prepare to parse query
-        std::istringstream qss(queryString); // steam to read
-        std::string pair; // temporary string for each pair
-
-        // 5 - loop through each key=value pair (delimited by '&')
-        while (std::getline(qss, pair, '&')) {
-            // 6 - find delimiter separator '='
-            size_t eq_pos = pair.find('=');
-            if (eq_pos != std::string::npos) { // pair found
-                // 7 - extract key/value
-                std::string key = pair.substr(0, eq_pos);
-                std::string value = pair.substr(eq_pos + 1);
-                
-                // 8 - store pair
-                _request.queryParams[key] = value;
-            } else { // key only
-                // 9 - store lonely key with empty string
-                _request.queryParams[pair] = "";
-            }
-        }
-    } else { // no query string
-        // 10 - entire uri is the path
-        _request.path = _request.uri;
+    if (_chunked.isDone()) {
+        _request.spool = _spool.inFile() ? &_spool : NULL;
+        _request.currentState = HttpRequest::COMPLETE; // anything left is the next pipelined request
     }
 }
 
 // Main parsing function: drives the state machine
 // This function ensures progress is made or returns control if more data is needed.
 void HttpRequestParser::parse() {
-    size_t prev_buffer_size;      // Store buffer size before parsing attempt
+    size_t prev_buffer_size;      // Store unread size before parsing attempt
     HttpRequest::ParsingState prev_state; // Store current state before parsing attempt
 
     // The loop continues as long as the request is not complete or in an error state.
@@ -284,7 +356,7 @@ void HttpRequestParser::parse() {
     // If a parsing function returns because it's waiting for more data (no state change, no buffer consumption),
     // then this loop must break to return control to the caller.
     while (_request.currentState != HttpRequest::COMPLETE && _request.currentState != HttpRequest::ERROR) {
-        prev_buffer_size = _buffer.size();      // Capture buffer size at start of iteration
+        prev_buffer_size = unreadSize();        // Capture unread size at start of iteration
         prev_state = _request.currentState;      // Capture state at start of iteration
 
         switch (_request.currentState) {
@@ -306,7 +378,7 @@ void HttpRequestParser::parse() {
         // If the buffer size is the same AND the state hasn't changed,
         // it means the parsing function returned because it's waiting for more data.
         // In this scenario, we MUST break the internal while loop to prevent a hang.
-        if (_buffer.size() == prev_buffer_size && _request.currentState == prev_state) {
+        if (unreadSize() == prev_buffer_size && _request.currentState == prev_state) {
             break; // No progress made, current state needs more data. Exit internal loop.
         }
     }
@@ -320,6 +392,27 @@ bool HttpRequestParser::hasError() const {
     return _request.currentState == HttpRequest::ERROR;
 }
 
+int HttpRequestParser::getErrorStatus() const {
+    return _errorStatus;
+}
+
+void HttpRequestParser::setHeaderLimits(size_t maxLine, size_t maxHead) {
+    _maxLine = maxLine;
+    _maxHead = maxHead;
+}
+
+void HttpRequestParser::setBodyLimit(size_t maxBody) {
+    _maxBody = maxBody;
+}
+
+void HttpRequestParser::setRequestRouter(RequestRouter* router) {
+    _router = router;
+}
+
+void HttpRequestParser::spoolBodyTo(const std::string& dir, size_t threshold) {
+    _spool.spoolTo(dir, threshold);
+}
+
 // Getters
 HttpRequest& HttpRequestParser::getRequest() {
     return _request;
@@ -329,8 +422,33 @@ const HttpRequest& HttpRequestParser::getRequest() const {
     return _request;
 }
 
-// Reset the parser for a new request (e.g., for Keep-Alive)
+bool HttpRequestParser::hasBufferedData() const {
+    return unreadSize() > 0;
+}
+
+// Reset the parser for the next request on the same connection (Keep-Alive).
+// Bytes received past the end of the previous request are kept: with pipelining they are
+// the start of the next one. After an error nothing can be trusted, so the buffer is dropped.
+// The previous request and its slices are gone: the buffer can be compacted again.
 void HttpRequestParser::reset() {
+    if (_request.currentState == HttpRequest::ERROR || unreadSize() == 0) {
+        _buffer.clear(); // keeps the capacity for a request already in the same read; releaseBuffer() frees it
+        _readPos = 0;
+    }
     _request = HttpRequest(); // Re-initialize HttpRequest to default state
-    _buffer.clear(); // Clear any remaining data in the buffer
+    _head.clear();
+    _errorStatus = 400;
+    _isChunked = false;
+    _chunked.reset();
+    _spool.reset(); // an unpublished spool file is deleted
+}
+
+// An idle keep-alive connection holds no receive memory: the capacity reached by a large head
+// or a pipelined burst is given back. Nothing is freed while a request is under way, since its
+// slices point into the buffer, nor while pipelined bytes are waiting in it.
+void HttpRequestParser::releaseBuffer() {
+    if (_request.currentState == HttpRequest::RECV_REQUEST_LINE && unreadSize() == 0) {
+        std::vector<char>().swap(_buffer);
+        _readPos = 0;
+    }
 }
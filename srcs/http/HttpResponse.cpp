@@ -11,32 +11,78 @@
 /* ************************************************************************** */
 
 #include "../../includes/http/HttpResponse.hpp" // Include its own header
-#include <iomanip>  // For std::put_time (if C++11, but we use strftime for C++98)
-#include <cstdio>   // For snprintf, strftime
 #include <vector>   // For std::vector<char>
 #include <algorithm> // For std::transform (for toLower in getMimeType if used here)
+#include <fstream>   // For std::ifstream (file bodies in toString)
+#include <iterator>  // For std::istreambuf_iterator
+
+#include "../../includes/http/HttpDate.hpp"
+
+#define DEFAULT_CONTENT_TYPE_LINE "Content-Type: application/octet-stream\r\n"
+#define SERVER_LINE "Server: Webserv/1.0\r\n" // Identify your server
+#define DATE_PREFIX "Date: "
+
+// Appends the decimal digits of 'value' (status code, Content-Length) without a stream
+static void appendDecimal(std::string& out, size_t value) {
+    char buf[24];
+    size_t pos = sizeof(buf);
+
+    do {
+        buf[--pos] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value);
+    out.append(buf + pos, sizeof(buf) - pos);
+}
 
 
 // --- Helper function implementations (outside the class if generic) ---
 
+// Every status the server sends (handlers, CGI timeout, usual 'return' redirections),
+// with its complete status line: written as is, nothing formatted. Sorted by code.
+#define STATUS_LINE(code, reason) { code, reason, "HTTP/1.1 " #code " " reason "\r\n", sizeof("HTTP/1.1 " #code " " reason "\r\n") - 1 }
+
+static const HttpStatusLine STATUS_LINES[] = {
+    STATUS_LINE(200, "OK"),
+    STATUS_LINE(201, "Created"),
+    STATUS_LINE(204, "No Content"),
+    STATUS_LINE(301, "Moved Permanently"),
+    STATUS_LINE(302, "Found"), // Often used for temporary redirects
+    STATUS_LINE(303, "See Other"),
+    STATUS_LINE(307, "Temporary Redirect"),
+    STATUS_LINE(308, "Permanent Redirect"),
+    STATUS_LINE(400, "Bad Request"),
+    STATUS_LINE(403, "Forbidden"),
+    STATUS_LINE(404, "Not Found"),
+    STATUS_LINE(405, "Method Not Allowed"),
+    STATUS_LINE(411, "Length Required"),
+    STATUS_LINE(413, "Payload Too Large"),
+    STATUS_LINE(414, "URI Too Long"),
+    STATUS_LINE(429, "Too Many Requests"),
+    STATUS_LINE(431, "Request Header Fields Too Large"),
+    STATUS_LINE(500, "Internal Server Error"),
+    STATUS_LINE(501, "Not Implemented"),
+    STATUS_LINE(503, "Service Unavailable"),
+    STATUS_LINE(504, "Gateway Timeout")
+};
+
+#define UNKNOWN_STATUS_REASON "Unknown Status" // Fallback for unhandled codes
+
+const HttpStatusLine* findHttpStatusLine(int statusCode) {
+    size_t count = sizeof(STATUS_LINES) / sizeof(STATUS_LINES[0]);
+
+    for (size_t i = 0; i < count && STATUS_LINES[i].code <= statusCode; ++i) {
+        if (STATUS_LINES[i].code == statusCode) {
+            return &STATUS_LINES[i];
+        }
+    }
+    return NULL;
+}
+
 // Maps HTTP status codes to their standard messages
 std::string getHttpStatusMessage(int statusCode) {
-    switch (statusCode) {
-        case 200: return "OK";
-        case 201: return "Created";
-        case 204: return "No Content";
-        case 301: return "Moved Permanently";
-        case 302: return "Found"; // Often used for temporary redirects
-        case 400: return "Bad Request";
-        case 403: return "Forbidden";
-        case 404: return "Not Found";
-        case 405: return "Method Not Allowed";
-        case 413: return "Payload Too Large";
-        case 500: return "Internal Server Error";
-        case 501: return "Not Implemented";
-        case 503: return "Service Unavailable";
-        default: return "Unknown Status"; // Fallback for unhandled codes
-    }
+    const HttpStatusLine* status = findHttpStatusLine(statusCode);
+
+    return status ? status->reason : UNKNOWN_STATUS_REASON;
 }
 
 // Determines the MIME type based on file extension
@@ -71,18 +117,23 @@ std::string getMimeType(const std::string& filePath) {
 
 // --- HttpResponse Class Implementation ---
 
-// Constructor: Initializes with default HTTP/1.1 protocol and common headers.
-HttpResponse::HttpResponse() : _protocolVersion("HTTP/1.1"), _statusCode(200), _statusMessage("OK") {
-    setDefaultHeaders();
+// Constructor: Initializes with default HTTP/1.1 protocol, status 200.
+// Nothing is formatted here: Server and Date are written when the head is serialized.
+HttpResponse::HttpResponse()
+    : _protocolVersion("HTTP/1.1"), _statusCode(200), _status(findHttpStatusLine(200)), _bodyFileSize(0), _sendDate(true) {
 }
 
 // Destructor
 HttpResponse::~HttpResponse() {}
 
-// Sets the HTTP status code and updates the status message accordingly.
+// Sets the HTTP status code and points at its entry in the status line table.
 void HttpResponse::setStatus(int code) {
     _statusCode = code;
-    _statusMessage = getHttpStatusMessage(code);
+    _status = findHttpStatusLine(code);
+}
+
+const char* HttpResponse::getStatusMessage() const {
+    return _status ? _status->reason : UNKNOWN_STATUS_REASON;
 }
 
 // Adds or updates a header in the response.
@@ -92,77 +143,152 @@ void HttpResponse::addHeader(const std::string& name, const std::string& value)
     _headers[name] = value;
 }
 
+// Removes a header (e.g. a default one that must not be frozen into a cached response).
+void HttpResponse::removeHeader(const std::string& name) {
+    if (name == "Date") {
+        _sendDate = false;
+    }
+    _headers.erase(name);
+}
+
 // Sets the response body from a string and updates Content-Length.
 void HttpResponse::setBody(const std::string& content) {
+    _bodyFile.clear();
     _body.assign(content.begin(), content.end()); // Copy string content to char vector
-    // Convert size_t to string for header value
-    std::ostringstream oss;
-    oss << _body.size();
-    addHeader("Content-Length", oss.str());
+    setContentLength(_body.size());
 }
 
 // Sets the response body from a vector of chars (for binary data) and updates Content-Length.
 void HttpResponse::setBody(const std::vector<char>& content) {
+    _bodyFile.clear();
     _body = content; // Direct copy
-    // Convert size_t to string for header value
-    std::ostringstream oss;
-    oss << _body.size();
-    addHeader("Content-Length", oss.str());
+    setContentLength(_body.size());
 }
 
-// Generates the current GMT date/time string for the "Date" header.
-// Format: "Day, DD Mon YYYY HH:MM:SS GMT" (RFC 1123)
-std::string HttpResponse::getCurrentGmTime() const {
-    char buf[100];
-    time_t rawtime;
-    struct tm *gmtm;
-
-    time(&rawtime);
-    gmtm = gmtime(&rawtime); // Get GMT time
-    
-    // Format according to RFC 1123: "Wdy, DD Mon YYYY HH:MM:SS GMT"
-    // strftime returns the number of characters placed into the array pointed to by buf
-    strftime(buf, sizeof(buf), "%a, %d %b %Y %H:%M:%S GMT", gmtm);
-    return std::string(buf);
+// Sets the body to a file on disk; the content is only read when the response is sent.
+void HttpResponse::setBodyFile(const std::string& path, size_t size) {
+    _body.clear();
+    _bodyFile = path;
+    _bodyFileSize = size;
+    setContentLength(size);
 }
 
-// Sets common default headers that should typically be present in a response.
-void HttpResponse::setDefaultHeaders() {
-    addHeader("Server", "Webserv/1.0"); // Identify your server
-    addHeader("Date", getCurrentGmTime()); // Current date and time
-    // addHeader("Connection", "keep-alive"); // Often implied by HTTP/1.1, but can be explicit
-}
+void HttpResponse::setContentLength(size_t length) {
+    std::string value;
 
-// Generates the complete raw HTTP response string.
-std::string HttpResponse::toString() const {
-    std::ostringstream oss;
+    appendDecimal(value, length);
+    addHeader("Content-Length", value);
+}
 
-    // 1. Status Line
-    oss << _protocolVersion << " " << _statusCode << " " << _statusMessage << "\r\n";
+// Hands the in-memory body over to the caller (swap, no copy).
+void HttpResponse::releaseBody(std::vector<char>& out) {
+    out.clear();
+    out.swap(_body);
+}
 
-    // 2. Headers
-    // Ensure essential headers are present/updated before sending
-    // For Content-Length, it's set by setBody methods.
-    // For Content-Type, it should be set by the handler.
+// Exact size of the head: lets headToString write it into a single allocation.
+size_t HttpResponse::headSize() const {
+    size_t size = 0;
+    std::map<std::string, std::string>::const_iterator it;
 
-    // If Content-Type is not set by handler, provide a default
+    if (hasStatusLine()) {
+        size += _status->length;
+    } else {
+        size += _protocolVersion.size() + 1 + 11 + 1 + sizeof(UNKNOWN_STATUS_REASON) - 1 + 2; // any int
+    }
+    if (_headers.find("Server") == _headers.end()) {
+        size += sizeof(SERVER_LINE) - 1;
+    }
+    if (sendsDefaultDate()) {
+        size += sizeof(DATE_PREFIX) - 1 + HttpDate::LENGTH + 2;
+    }
     if (_headers.find("Content-Type") == _headers.end()) {
-        oss << "Content-Type: application/octet-stream\r\n"; // Default if not specified
+        size += sizeof(DEFAULT_CONTENT_TYPE_LINE) - 1;
+    }
+    for (it = _headers.begin(); it != _headers.end(); ++it) {
+        size += it->first.size() + 2 + it->second.size() + 2; // "Name: value\r\n"
     }
+    return size + 2; // empty line
+}
 
-    // Write all collected headers
+// Appends the status line and the headers, up to and including the empty line.
+// The caller has reserved headSize() bytes: no stream, no reallocation while appending.
+void HttpResponse::appendHead(std::string& head) const {
     std::map<std::string, std::string>::const_iterator it;
+
+    // 1. Status Line, from the table for every status the server uses
+    if (hasStatusLine()) {
+        head.append(_status->line, _status->length);
+    } else {
+        head.append(_protocolVersion);
+        head += ' ';
+        appendDecimal(head, static_cast<size_t>(_statusCode));
+        head += ' ';
+        head.append(getStatusMessage());
+        head.append("\r\n", 2);
+    }
+
+    // 2. Headers
+    // Default headers, unless the handler set its own (or removed Date): the date comes from
+    // the event loop's clock, formatted at most once per second
+    if (_headers.find("Server") == _headers.end()) {
+        head.append(SERVER_LINE, sizeof(SERVER_LINE) - 1);
+    }
+    if (sendsDefaultDate()) {
+        head.append(DATE_PREFIX, sizeof(DATE_PREFIX) - 1);
+        head.append(HttpDate::now(), HttpDate::LENGTH);
+        head.append("\r\n", 2);
+    }
+    // Content-Length is set by the setBody methods, Content-Type by the handler;
+    // if the handler did not set one, provide a default
+    if (_headers.find("Content-Type") == _headers.end()) {
+        head.append(DEFAULT_CONTENT_TYPE_LINE, sizeof(DEFAULT_CONTENT_TYPE_LINE) - 1);
+    }
     for (it = _headers.begin(); it != _headers.end(); ++it) {
-        oss << it->first << ": " << it->second << "\r\n";
+        head.append(it->first);
+        head.append(": ", 2);
+        head.append(it->second);
+        head.append("\r\n", 2);
     }
-    
-    oss << "\r\n"; // End of headers
+
+    head.append("\r\n", 2); // End of headers
+}
+
+// Default Date header: not removed, not replaced by the handler
+bool HttpResponse::sendsDefaultDate() const {
+    return _sendDate && _headers.find("Date") == _headers.end();
+}
+
+// The table's line is only valid for the protocol it was written for
+bool HttpResponse::hasStatusLine() const {
+    return _status && _protocolVersion == "HTTP/1.1";
+}
+
+// The head alone, in one allocation. The body is never part of it:
+// the connection queues it as its own segment.
+std::string HttpResponse::headToString() const {
+    std::string head;
+
+    head.reserve(headSize());
+    appendHead(head);
+    return head;
+}
+
+// Generates the complete raw HTTP response string (cached responses, tests).
+// The server itself sends the head and the body as separate segments, see headToString.
+std::string HttpResponse::toString() const {
+    std::string raw;
+
+    raw.reserve(headSize() + (hasBodyFile() ? _bodyFileSize : _body.size()));
+    appendHead(raw);
 
     // 3. Body
-    // Append body content from the vector<char>
-    for (size_t i = 0; i < _body.size(); ++i) {
-        oss << _body[i];
+    // Append body content from the vector<char>, or from the file body if one was set
+    if (hasBodyFile()) {
+        std::ifstream file(_bodyFile.c_str(), std::ios::in | std::ios::binary);
+        raw.append((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    } else if (!_body.empty()) {
+        raw.append(&_body[0], _body.size());
     }
-
-    return oss.str();
+    return raw;
 }
@@ -33,7 +33,7 @@ const ServerConfig* RequestDispatcher::findMatchingServer(const HttpRequest& req
 	// const ServerConfig* nameMatchServer = NULL; // unused
 
 	// Get the Host header from the request
-	std::string requestHostHeader = request.getHeader("host");
+	std::string requestHostHeader = request.header(HEADER_HOST).str();
 
 	// Remove port from Host header if present (e.g., "example.com:8080" -> "example.com")
 	size_t colonPos = requestHostHeader.find(':');
@@ -100,9 +100,9 @@ const LocationConfig* RequestDispatcher::findMatchingLocation(const HttpRequest&
         const LocationConfig& currentLocation = serverConfig.locations[i];
 
         // Check if the current location's path is a prefix of the request's URI path.
-        // `request.path.rfind(currentLocation.path, 0) == 0` checks if currentLocation.path
-        // is found at the very beginning (index 0) of request.path.
-        if (request.path.rfind(currentLocation.path, 0) == 0) {
+        // `request.path().startsWith(currentLocation.path)` checks if currentLocation.path
+        // is found at the very beginning (index 0) of request.path().
+        if (request.path().startsWith(currentLocation.path)) {
             // If this location matches and its path is longer (more specific)
             // than any previous match, update `bestMatch`.
             if (currentLocation.path.length() > longestMatchLength) {
@@ -113,7 +113,7 @@ const LocationConfig* RequestDispatcher::findMatchingLocation(const HttpRequest&
     }
 
     // After checking all locations, return the location that had the longest matching prefix.
-    // If no location matched (e.g., if request.path was not prefixed by any location,
+    // If no location matched (e.g., if request.path() was not prefixed by any location,
     // and no '/' root location exists), bestMatch will remain NULL.
     return bestMatch;
 }
@@ -63,7 +63,7 @@ bool runCGITest(const std::string& testName,
                 const LocationConfig& locationConfig) {
 
     std::cout << "\n=== Running CGI Test: " << testName << " ===\n";
-    std::cout << "Request: " << request.method << " " << request.uri << std::endl;
+    std::cout << "Request: " << request.method() << " " << request.uri() << std::endl;
 
     try {
         CGIHandler cgiHandler(request, &serverConfig, &locationConfig);
@@ -217,11 +217,8 @@ int main() {
     // Test 1: GET Request to CGI Script
     total_tests++;
     HttpRequest getRequest;
-    getRequest.method = "GET";
-    getRequest.uri = "/php/test.php?name=test&id=123";
-    getRequest.path = "/php/test.php";
-    getRequest.protocolVersion = "HTTP/1.1";
-    getRequest.headers["host"] = "example.com";
+    getRequest.setRequestLine("GET", "/php/test.php?name=test&id=123", "HTTP/1.1");
+    getRequest.setHeader("host", "example.com");
     getRequest.currentState = HttpRequest::COMPLETE;
 
     if (runCGITest("TC1: GET request to CGI", getRequest, mockServer, mockLocation)) {
@@ -231,15 +228,12 @@ int main() {
     // Test 2: POST Request to CGI Script with Body
     total_tests++;
     HttpRequest postRequest;
-    postRequest.method = "POST";
-    postRequest.uri = "/php/test.php";
-    postRequest.path = "/php/test.php";
-    postRequest.protocolVersion = "HTTP/1.1";
-    postRequest.headers["host"] = "example.com";
-    postRequest.headers["content-type"] = "application/x-www-form-urlencoded";
+    postRequest.setRequestLine("POST", "/php/test.php", "HTTP/1.1");
+    postRequest.setHeader("host", "example.com");
+    postRequest.setHeader("content-type", "application/x-www-form-urlencoded");
     std::string postBody = "key1=value1&key2=value2&data=This+is+some+post+data";
     postRequest.body.assign(postBody.begin(), postBody.end());
-    postRequest.headers["content-length"] = StringUtils::longToString(postBody.length());
+    postRequest.setHeader("content-length", StringUtils::longToString(postBody.length()));
     postRequest.currentState = HttpRequest::COMPLETE;
 
     if (runCGITest("TC2: POST request to CGI with body", postRequest, mockServer, mockLocation)) {
@@ -249,15 +243,12 @@ int main() {
     // Test 3: POST Request to CGI Script with large Body (ensure it gets fully sent)
     total_tests++;
     HttpRequest largePostRequest;
-    largePostRequest.method = "POST";
-    largePostRequest.uri = "/php/test.php";
-    largePostRequest.path = "/php/test.php";
-    largePostRequest.protocolVersion = "HTTP/1.1";
-    largePostRequest.headers["host"] = "example.com";
-    largePostRequest.headers["content-type"] = "text/plain";
+    largePostRequest.setRequestLine("POST", "/php/test.php", "HTTP/1.1");
+    largePostRequest.setHeader("host", "example.com");
+    largePostRequest.setHeader("content-type", "text/plain");
     std::string largePostBody(1024 * 10, 'A'); // 10KB of 'A'
     largePostRequest.body.assign(largePostBody.begin(), largePostBody.end());
-    largePostRequest.headers["content-length"] = StringUtils::longToString(largePostBody.length());
+    largePostRequest.setHeader("content-length", StringUtils::longToString(largePostBody.length()));
     largePostRequest.currentState = HttpRequest::COMPLETE;
 
     if (runCGITest("TC3: POST request with large body", largePostRequest, mockServer, mockLocation)) {
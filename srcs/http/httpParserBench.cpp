@@ -0,0 +1,461 @@
+#include "../../includes/http/HttpRequestParser.hpp"
+#include "../../includes/http/HeadScanner.hpp"
+#include "../../includes/utils/StringUtils.hpp"
+
+#include <iostream>
+#include <map>
+#include <new>
+#include <cstdlib>
+#include <sstream>
+#include <sys/time.h>
+
+// Microbenchmark of request head parsing on a realistic ~600 byte browser request.
+// Compares the previous approach (byte-by-byte search for CRLF / CRLFCRLF + istringstream/getline)
+// with HttpRequestParser on top of HeadScanner, then the raw scanner at each SIMD level.
+
+#define BENCH_ITERATIONS 200000
+
+static const char* BROWSER_REQUEST =
+    "GET /images/gallery/2024/summer/index.html?page=2&sort=date HTTP/1.1\r\n"
+    "Host: www.example.com\r\n"
+    "Connection: keep-alive\r\n"
+    "Cache-Control: max-age=0\r\n"
+    "sec-ch-ua: \"Chromium\";v=\"124\", \"Google Chrome\";v=\"124\", \"Not-A.Brand\";v=\"99\"\r\n"
+    "sec-ch-ua-mobile: ?0\r\n"
+    "sec-ch-ua-platform: \"Linux\"\r\n"
+    "Upgrade-Insecure-Requests: 1\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/124.0.0.0 Safari/537.36\r\n"
+    "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,image/webp,*/*;q=0.8\r\n"
+    "Sec-Fetch-Site: same-origin\r\n"
+    "Sec-Fetch-Mode: navigate\r\n"
+    "Referer: https://www.example.com/images/gallery/\r\n"
+    "Accept-Encoding: gzip, deflate, br\r\n"
+    "Accept-Language: en-US,en;q=0.9,fr;q=0.8\r\n"
+    "\r\n";
+
+// Every heap allocation of the program goes through here: the runs count their own
+static size_t g_allocations = 0;
+
+void* operator new(size_t size) throw(std::bad_alloc) {
+    void* p = std::malloc(size ? size : 1);
+
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    g_allocations++;
+    return p;
+}
+
+// Not inlined: at -O2 GCC would otherwise see free() paired with operator new
+__attribute__((noinline))
+void operator delete(void* p) throw() {
+    std::free(p);
+}
+
+static double nowSec() {
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+// --- Previous implementation, kept here as the reference ---
+
+static size_t legacyFind(const std::vector<char>& buffer, const std::string& pattern) {
+    if (buffer.empty() || pattern.length() > buffer.size()) {
+        return std::string::npos;
+    }
+    for (size_t i = 0; i <= buffer.size() - pattern.length(); ++i) {
+        bool match = true;
+        for (size_t j = 0; j < pattern.length(); ++j) {
+            if (buffer[i + j] != pattern[j]) {
+                match = false;
+                break;
+            }
+        }
+        if (match) {
+            return i;
+        }
+    }
+    return std::string::npos;
+}
+
+static size_t legacyParse(std::vector<char>& buffer, const std::string& raw) {
+    std::map<std::string, std::string> headers;
+
+    buffer.assign(raw.begin(), raw.end());
+    size_t crlf_pos = legacyFind(buffer, "\r\n");
+    std::string requestLine(buffer.begin(), buffer.begin() + crlf_pos);
+    size_t first_space = requestLine.find(' ');
+    size_t second_space = requestLine.find(' ', first_space + 1);
+    std::string method = requestLine.substr(0, first_space);
+    std::string uri = requestLine.substr(first_space + 1, second_space - (first_space + 1));
+    std::string version = requestLine.substr(second_space + 1);
+    buffer.erase(buffer.begin(), buffer.begin() + crlf_pos + 2);
+
+    std::map<std::string, std::string> queryParams;
+    size_t query_pos = uri.find('?');
+    if (query_pos != std::string::npos) {
+        std::string path = uri.substr(0, query_pos);
+        std::istringstream qss(uri.substr(query_pos + 1));
+        std::string pair;
+
+        while (std::getline(qss, pair, '&')) {
+            size_t eq_pos = pair.find('=');
+            queryParams[pair.substr(0, eq_pos)] = (eq_pos != std::string::npos) ? pair.substr(eq_pos + 1) : "";
+        }
+    }
+
+    size_t double_crlf_pos = legacyFind(buffer, "\r\n\r\n");
+    std::string allHeaders(buffer.begin(), buffer.begin() + double_crlf_pos);
+    std::istringstream iss(allHeaders);
+    std::string line;
+
+    while (std::getline(iss, line, '\r')) {
+        if (!line.empty() && line[0] == '\n') {
+            line = line.substr(1);
+        }
+        if (line.empty()) continue;
+        size_t colon_pos = line.find(':');
+        std::string name = line.substr(0, colon_pos);
+        std::string value = line.substr(colon_pos + 1);
+        StringUtils::trim(name);
+        StringUtils::trim(value);
+        StringUtils::toLower(name);
+        headers[name] = value;
+    }
+    buffer.erase(buffer.begin(), buffer.begin() + double_crlf_pos + 4);
+    return headers.size() + queryParams.size();
+}
+
+// Delimiter finding only (what HeadScanner replaces): CRLF, CRLFCRLF, one line and one colon at a time
+static size_t legacySplit(std::vector<char>& buffer, const std::string& raw) {
+    size_t found = 0;
+
+    buffer.assign(raw.begin(), raw.end());
+    size_t crlf_pos = legacyFind(buffer, "\r\n");
+    std::string requestLine(buffer.begin(), buffer.begin() + crlf_pos);
+    found += requestLine.find(' ') + requestLine.rfind(' ');
+    buffer.erase(buffer.begin(), buffer.begin() + crlf_pos + 2);
+
+    size_t double_crlf_pos = legacyFind(buffer, "\r\n\r\n");
+    std::istringstream iss(std::string(buffer.begin(), buffer.begin() + double_crlf_pos));
+    std::string line;
+
+    while (std::getline(iss, line, '\r')) {
+        found += line.find(':');
+    }
+    return found;
+}
+
+// Previous body path: every read appended to the buffer, the whole body copied out once complete,
+// then erased from the front of the buffer
+static size_t legacyBody(const std::string& head, const std::vector<char>& chunk, size_t bodyLen) {
+    std::vector<char> buffer;
+    std::vector<char> body;
+    size_t received = 0;
+
+    buffer.insert(buffer.end(), head.begin(), head.end());
+    buffer.erase(buffer.begin(), buffer.begin() + head.size());
+    while (received < bodyLen) {
+        size_t n = (bodyLen - received < chunk.size()) ? bodyLen - received : chunk.size();
+
+        buffer.insert(buffer.end(), chunk.begin(), chunk.begin() + n);
+        received += n;
+        if (buffer.size() >= bodyLen) {
+            body.insert(body.end(), buffer.begin(), buffer.begin() + bodyLen);
+            buffer.erase(buffer.begin(), buffer.begin() + bodyLen);
+        }
+    }
+    return body.size();
+}
+
+// Previous consumption of pipelined requests: each one erased from the front of the buffer
+static size_t legacyPipeline(const std::string& burst, size_t requestLen) {
+    std::vector<char> buffer(burst.begin(), burst.end());
+    size_t served = 0;
+
+    while (!buffer.empty()) {
+        buffer.erase(buffer.begin(), buffer.begin() + requestLen);
+        served++;
+    }
+    return served;
+}
+
+// --- Runs ---
+
+static void report(const char* what, double seconds, size_t bytes) {
+    std::cout << "  " << what << " : " << static_cast<long>(BENCH_ITERATIONS / seconds) << " req/s, "
+              << static_cast<long>(bytes * (double)BENCH_ITERATIONS / seconds / 1e6) << " MB/s" << std::endl;
+}
+
+static bool sameLayout(const HeadLayout& a, const HeadLayout& b) {
+    if (a.lineEnd != b.lineEnd || a.firstSpace != b.firstSpace || a.secondSpace != b.secondSpace
+        || a.headEnd != b.headEnd || a.malformed != b.malformed || a.headers.size() != b.headers.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.headers.size(); ++i) {
+        if (a.headers[i].start != b.headers[i].start || a.headers[i].end != b.headers[i].end
+            || a.headers[i].colon != b.headers[i].colon) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    std::string raw(BROWSER_REQUEST);
+    std::vector<char> buffer;
+    size_t sink = 0;
+    double start, legacyTime, parserTime;
+    bool ok = true;
+
+    std::cout << "--- http parser bench : " << raw.size() << " byte request, "
+              << BENCH_ITERATIONS << " iterations, scanner "
+              << HeadScanner::levelName(HeadScanner::detectedLevel()) << " ---" << std::endl;
+
+    start = nowSec();
+    for (int i = 0; i < BENCH_ITERATIONS; ++i) {
+        sink += legacyParse(buffer, raw);
+    }
+    legacyTime = nowSec() - start;
+
+    size_t legacyAllocs = g_allocations;
+    sink += legacyParse(buffer, raw);
+    legacyAllocs = g_allocations - legacyAllocs;
+
+    // The parser keeps its buffer from one request to the next, as on a keep-alive connection
+    HttpRequestParser parser;
+    size_t parserAllocs = 0;
+    start = nowSec();
+    for (int i = 0; i < BENCH_ITERATIONS; ++i) {
+        if (i == 1) {
+            parserAllocs = g_allocations; // the first request sizes the buffers
+        }
+        parser.appendData(raw.c_str(), raw.size());
+        parser.parse();
+        if (!parser.isComplete()) {
+            ok = false;
+        }
+        const HttpRequest& req = parser.getRequest();
+        sink += req.headerCount() + req.queryParam("page").size() + req.header("user-agent").size();
+        parser.reset();
+    }
+    parserTime = nowSec() - start;
+    parserAllocs = g_allocations - parserAllocs;
+
+    report("legacy parse      ", legacyTime, raw.size());
+    report("HttpRequestParser ", parserTime, raw.size());
+    std::cout << "  speedup : x" << legacyTime / parserTime << std::endl;
+    std::cout << "  heap allocations per request : " << legacyAllocs << " legacy, "
+              << static_cast<double>(parserAllocs) / (BENCH_ITERATIONS - 1) << " HttpRequestParser" << std::endl;
+
+    // Lookups done per request by the dispatcher, keep-alive and POST paths: by name vs by HeaderId
+    {
+        const char* names[] = { "host", "connection", "content-length", "content-disposition" };
+        const HeaderId ids[] = { HEADER_HOST, HEADER_CONNECTION, HEADER_CONTENT_LENGTH, HEADER_CONTENT_DISPOSITION };
+        HttpRequestParser one;
+        double byName, byId;
+
+        one.appendData(raw.c_str(), raw.size());
+        one.parse();
+        const HttpRequest& req = one.getRequest();
+        start = nowSec();
+        for (int i = 0; i < BENCH_ITERATIONS; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                sink += req.header(names[(i + j) & 3]).size();
+            }
+        }
+        byName = nowSec() - start;
+        start = nowSec();
+        for (int i = 0; i < BENCH_ITERATIONS; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                sink += req.header(ids[(i + j) & 3]).size();
+            }
+        }
+        byId = nowSec() - start;
+        std::cout << "  4 header lookups : " << static_cast<long>(byName * 1e9 / BENCH_ITERATIONS) << " ns by name, "
+                  << static_cast<long>(byId * 1e9 / BENCH_ITERATIONS) << " ns by id" << std::endl;
+    }
+
+    // Slow client: a 16 KB head received one byte at a time must cost about the same as in one read
+    std::string bigHead = "GET / HTTP/1.1\r\n";
+    while (bigHead.size() < 16 * 1024) {
+        bigHead += "X-Padding-" + StringUtils::longToString(bigHead.size()) + ": " + std::string(60, 'p') + "\r\n";
+    }
+    bigHead += "\r\n";
+    double oneRead, byteReads;
+    HttpRequestParser slow;
+    slow.setHeaderLimits(DEFAULT_MAX_HEADER_LINE, 64 * 1024);
+    start = nowSec();
+    for (int i = 0; i < 100; ++i) {
+        slow.appendData(bigHead.c_str(), bigHead.size());
+        slow.parse();
+        ok = ok && slow.isComplete();
+        slow.reset();
+    }
+    oneRead = (nowSec() - start) / 100;
+    start = nowSec();
+    for (size_t i = 0; i < bigHead.size(); ++i) {
+        slow.appendData(bigHead.c_str() + i, 1);
+        slow.parse();
+    }
+    ok = ok && slow.isComplete();
+    slow.reset();
+    byteReads = nowSec() - start;
+    std::cout << "  " << bigHead.size() << " byte head : " << static_cast<long>(oneRead * 1e6) << " us in one read, "
+              << static_cast<long>(byteReads * 1e6) << " us one byte at a time" << std::endl;
+
+    // 100 MB POST received in 64 KB reads (the size of a body readv)
+    {
+        const size_t bodyLen = 100 * 1024 * 1024;
+        std::vector<char> chunk(64 * 1024, 'b');
+        std::string postHead = "POST /upload HTTP/1.1\r\nHost: example.com\r\nContent-Length: "
+                               + StringUtils::longToString(bodyLen) + "\r\n\r\n";
+        HttpRequestParser post;
+        double legacyPost, cursorPost;
+        size_t received = 0;
+
+        start = nowSec();
+        sink += legacyBody(postHead, chunk, bodyLen);
+        legacyPost = nowSec() - start;
+        start = nowSec();
+        post.appendData(postHead.c_str(), postHead.size());
+        post.parse();
+        while (received < bodyLen) {
+            size_t n = (bodyLen - received < chunk.size()) ? bodyLen - received : chunk.size();
+
+            post.appendData(&chunk[0], n);
+            post.parse();
+            received += n;
+        }
+        cursorPost = nowSec() - start;
+        ok = ok && post.isComplete() && post.getRequest().body.size() == bodyLen;
+        std::cout << "  100 MB POST : " << static_cast<long>(legacyPost * 1e3) << " ms buffer + copy, "
+                  << static_cast<long>(cursorPost * 1e3) << " ms straight into the body ("
+                  << static_cast<long>(bodyLen / cursorPost / 1e6) << " MB/s)" << std::endl;
+    }
+
+    // The same 100 MB sent chunked (16 KB chunks, as curl does), decoded as the 64 KB reads arrive
+    {
+        const size_t bodyLen = 100 * 1024 * 1024;
+        const size_t chunkLen = 16 * 1024;
+        std::string chunk = "4000\r\n" + std::string(chunkLen, 'c') + "\r\n";
+        std::string encoded;
+        std::string head = "POST /upload HTTP/1.1\r\nHost: example.com\r\nTransfer-Encoding: chunked\r\n\r\n";
+        HttpRequestParser post;
+        double chunkedPost;
+        size_t fed = 0;
+
+        for (size_t i = 0; i < 64; ++i) { // 1 MB pattern, fed again and again
+            encoded += chunk;
+        }
+        start = nowSec();
+        post.appendData(head.c_str(), head.size());
+        post.parse();
+        for (size_t sent = 0; sent < bodyLen; sent += chunkLen * 64) {
+            for (fed = 0; fed < encoded.size(); fed += 64 * 1024) {
+                size_t n = (encoded.size() - fed < 64 * 1024) ? encoded.size() - fed : 64 * 1024;
+
+                post.appendData(encoded.c_str() + fed, n);
+                post.parse();
+            }
+        }
+        post.appendData("0\r\n\r\n", 5);
+        post.parse();
+        chunkedPost = nowSec() - start;
+        ok = ok && post.isComplete() && post.getRequest().body.size() == bodyLen;
+        std::cout << "  100 MB chunked POST : " << static_cast<long>(chunkedPost * 1e3) << " ms decoded into the body ("
+                  << static_cast<long>(bodyLen / chunkedPost / 1e6) << " MB/s)" << std::endl;
+    }
+
+    // Decoder alone, into a sink that drops the data: framing cost per 1 KB chunk
+    {
+        class NullSink : public BodySink {
+        public:
+            size_t bytes;
+            NullSink() : bytes(0) {}
+            virtual void write(const char*, size_t len) { bytes += len; }
+        };
+        std::string small = "400;ext=1\r\n" + std::string(1024, 's') + "\r\n";
+        std::string stream;
+        ChunkedDecoder decoder;
+        NullSink sink;
+
+        for (int i = 0; i < 1024; ++i) {
+            stream += small;
+        }
+        stream += "0\r\n\r\n";
+        start = nowSec();
+        for (int i = 0; i < 100; ++i) {
+            decoder.reset();
+            for (size_t pos = 0; pos < stream.size(); pos += 4096) {
+                decoder.decode(stream.c_str() + pos, (stream.size() - pos < 4096) ? stream.size() - pos : 4096, sink);
+            }
+            ok = ok && decoder.isDone();
+        }
+        double decodeTime = nowSec() - start;
+        std::cout << "  chunked framing alone (1 KB chunks, data not copied) : " << static_cast<long>(100.0 * stream.size() / decodeTime / 1e6)
+                  << " MB/s of encoded stream" << std::endl;
+    }
+
+    // 10000 pipelined requests in one buffer: front erase per request vs read cursor
+    {
+        std::string one = "GET /p HTTP/1.1\r\nHost: example.com\r\n\r\n";
+        std::string burst;
+        HttpRequestParser pipe;
+        double legacyPipe, cursorPipe;
+        size_t served = 0;
+
+        for (int i = 0; i < 10000; ++i) {
+            burst += one;
+        }
+        start = nowSec();
+        sink += legacyPipeline(burst, one.size());
+        legacyPipe = nowSec() - start;
+        start = nowSec();
+        pipe.appendData(burst.c_str(), burst.size());
+        for (pipe.parse(); pipe.isComplete(); pipe.parse()) {
+            served++;
+            pipe.reset();
+        }
+        cursorPipe = nowSec() - start;
+        ok = ok && served == 10000;
+        std::cout << "  10000 pipelined requests : " << static_cast<long>(legacyPipe * 1e3) << " ms of front erases alone, "
+                  << static_cast<long>(cursorPipe * 1e3) << " ms parsed with the read cursor" << std::endl;
+    }
+
+    // Delimiter scanning alone: previous search, then every level up to the one this CPU supports
+    start = nowSec();
+    for (int i = 0; i < BENCH_ITERATIONS; ++i) {
+        sink += legacySplit(buffer, raw);
+    }
+    report("legacy delimiters ", nowSec() - start, raw.size());
+
+    HeadLayout reference;
+    HeadScanner::forceLevel(HeadScanner::LEVEL_SCALAR);
+    HeadScanner::scan(raw.c_str(), raw.size(), reference);
+    for (int lvl = HeadScanner::LEVEL_SCALAR; lvl <= HeadScanner::detectedLevel(); ++lvl) {
+        HeadLayout layout;
+
+        HeadScanner::forceLevel(static_cast<HeadScanner::Level>(lvl));
+        start = nowSec();
+        for (int i = 0; i < BENCH_ITERATIONS; ++i) {
+            layout.clear();
+            HeadScanner::scan(raw.c_str(), raw.size(), layout);
+            sink += layout.headEnd;
+        }
+        std::string label = std::string("scan ") + HeadScanner::levelName(static_cast<HeadScanner::Level>(lvl));
+        label.resize(18, ' ');
+        report(label.c_str(), nowSec() - start, raw.size());
+        if (!sameLayout(reference, layout)) {
+            std::cerr << "  MISMATCH with the scalar scanner at level " << label << std::endl;
+            ok = false;
+        }
+    }
+    HeadScanner::forceLevel(HeadScanner::detectedLevel());
+
+    std::cout << "  headers per request : " << reference.headers.size()
+              << " (checksum " << sink % 1000 << ")" << std::endl;
+    return ok ? 0 : 1;
+}
@@ -11,12 +11,19 @@
 /* ************************************************************************** */
 
 #include "../../includes/http/HttpRequestParser.hpp"
+#include "../../includes/http/HttpRequestHandler.hpp" // For answerFromHead
+#include "../../includes/utils/StringUtils.hpp" // For longToString
 #include <vector>
 #include <iostream>
 #include <string>
 #include <algorithm> // For std::min
 #include <ios>       // For std::unitbuf, std::ios_base::sync_with_stdio
 #include <cstring>   // For strlen for char* literals
+#include <fstream>   // For reading back spooled bodies
+#include <iterator>  // For std::istreambuf_iterator
+#include <cstdlib>   // For mkdtemp
+#include <dirent.h>  // For opendir, readdir
+#include <unistd.h>  // For unlink, rmdir
 
 // Helper function to run a test case
 // Parameters:
@@ -76,12 +83,12 @@ bool runParserTest(const std::string& testName, const std::vector<std::string>&
         // If expectComplete is false AND parser is not complete, it's considered a pass for a partial test
         else {
             // Further validation for expected values (only run if no immediate failure)
-            if (!expectedMethod.empty() && parser.getRequest().method != expectedMethod) {
-                std::cerr << "FAIL: Method mismatch. Expected '" << expectedMethod << "', got '" << parser.getRequest().method << "'.\n" << std::flush;
+            if (!expectedMethod.empty() && parser.getRequest().method() != expectedMethod) {
+                std::cerr << "FAIL: Method mismatch. Expected '" << expectedMethod << "', got '" << parser.getRequest().method() << "'.\n" << std::flush;
                 test_passed = false;
             }
-            if (!expectedPath.empty() && parser.getRequest().path != expectedPath) {
-                std::cerr << "FAIL: Path mismatch. Expected '" << expectedPath << "', got '" << parser.getRequest().path << "'.\n" << std::flush;
+            if (!expectedPath.empty() && parser.getRequest().path() != expectedPath) {
+                std::cerr << "FAIL: Path mismatch. Expected '" << expectedPath << "', got '" << parser.getRequest().path() << "'.\n" << std::flush;
                 test_passed = false;
             }
 
@@ -111,6 +118,124 @@ bool runParserTest(const std::string& testName, const std::vector<std::string>&
 }
 
 
+// Deterministic pseudo-random numbers for the chunked fuzz test (same sequence on every run)
+static unsigned long g_fuzzState = 42;
+
+static size_t fuzzRand(size_t bound) {
+    g_fuzzState = g_fuzzState * 6364136223846793005UL + 1442695040888963407UL;
+    return bound ? static_cast<size_t>((g_fuzzState >> 33) % bound) : 0;
+}
+
+// Encodes 'body' as a chunked stream with random chunk sizes, hex case, leading zeros,
+// extensions and trailers
+static std::string encodeChunked(const std::string& body) {
+    static const char* hexLower = "0123456789abcdef";
+    static const char* hexUpper = "0123456789ABCDEF";
+    std::string out;
+    size_t pos = 0;
+
+    while (pos < body.size()) {
+        size_t n = 1 + fuzzRand(fuzzRand(2) ? 16 : 3000);
+        const char* hex = fuzzRand(2) ? hexLower : hexUpper;
+        std::string size;
+
+        if (n > body.size() - pos) {
+            n = body.size() - pos;
+        }
+        for (size_t v = n; v > 0; v /= 16) {
+            size.insert(size.begin(), hex[v % 16]);
+        }
+        out += std::string(fuzzRand(3), '0') + size;
+        if (fuzzRand(4) == 0) {
+            out += ";ext=\"v\"";
+        }
+        out += "\r\n" + body.substr(pos, n) + "\r\n";
+        pos += n;
+    }
+    out += "0\r\n";
+    if (fuzzRand(3) == 0) {
+        out += "X-Checksum: abc\r\n";
+    }
+    return out + "\r\n";
+}
+
+class StringBodySink : public BodySink {
+public:
+    std::string data;
+    virtual void write(const char* p, size_t len) { data.append(p, len); }
+};
+
+// Spools every body over 'threshold' bytes to 'dir', as Connection does for an upload location
+class SpoolRouter : public RequestRouter {
+public:
+    HttpRequestParser& parser;
+    std::string dir;
+    size_t threshold;
+    SpoolRouter(HttpRequestParser& p, const std::string& d, size_t t) : parser(p), dir(d), threshold(t) {}
+    virtual int routeRequest(const HttpRequest&, bool) {
+        parser.spoolBodyTo(dir, threshold);
+        return 0;
+    }
+};
+
+// Body limit per path, as Connection sets client_max_body_size of the matched location;
+// "/moved" is answered from the head (as a redirection would be)
+class LimitRouter : public RequestRouter {
+public:
+    HttpRequestParser& parser;
+    int calls;
+    int bodies;
+    explicit LimitRouter(HttpRequestParser& p) : parser(p), calls(0), bodies(0) {}
+    virtual int routeRequest(const HttpRequest& request, bool bodyFollows) {
+        ++calls;
+        bodies += bodyFollows;
+        parser.setBodyLimit(request.path() == "/small" ? 10 : 0);
+        return (request.path() == "/moved") ? 301 : 0;
+    }
+};
+
+// Same order as Connection::routeRequest: the checks of the head first, then the 100 Continue
+class HeadRouter : public RequestRouter {
+public:
+    MatchedConfig matched;
+    std::string sent; // what the connection would have queued, interim responses included
+    explicit HeadRouter(const ServerConfig* server) { matched.server_config = server; }
+    virtual int routeRequest(const HttpRequest& request, bool bodyFollows) {
+        HttpRequestHandler handler;
+        HttpResponse response;
+
+        if (!bodyFollows) {
+            return 0;
+        }
+        if (handler.answerFromHead(request, matched, response)) {
+            sent += "HTTP/1.1 " + StringUtils::longToString(response.getStatusCode()) + "\r\n";
+            return response.getStatusCode();
+        }
+        if (request.header(HEADER_EXPECT).iequals("100-continue")) {
+            sent += "HTTP/1.1 100 Continue\r\n";
+        }
+        return 0;
+    }
+};
+
+static std::string readFile(const std::string& path) {
+    std::ifstream in(path.c_str(), std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+// Entries of 'dir' besides . and ..
+static size_t countEntries(const std::string& dir) {
+    size_t n = 0;
+    DIR* d = opendir(dir.c_str());
+    for (struct dirent* e = d ? readdir(d) : NULL; e; e = readdir(d)) {
+        n += (std::strcmp(e->d_name, ".") != 0 && std::strcmp(e->d_name, "..") != 0);
+    }
+    if (d) {
+        closedir(d);
+    }
+    return n;
+}
+
 int main() {
     // Force immediate flushing of cout and cerr for better debugging visibility
     std::ios_base::sync_with_stdio(false);
@@ -177,8 +302,8 @@ int main() {
         parser_q.parse();
         bool query_params_correct = true;
         if (parser_q.isComplete()) {
-            if (!(parser_q.getRequest().queryParams.count("q") && parser_q.getRequest().queryParams["q"] == "test" &&
-                  parser_q.getRequest().queryParams.count("id") && parser_q.getRequest().queryParams["id"] == "123")) {
+            if (!(parser_q.getRequest().hasQueryParam("q") && parser_q.getRequest().queryParam("q") == "test" &&
+                  parser_q.getRequest().hasQueryParam("id") && parser_q.getRequest().queryParam("id") == "123")) {
                 std::cerr << "FAIL: Query params for 'GET with Query String' are incorrect.\n";
                 query_params_correct = false;
             }
@@ -286,7 +411,7 @@ int main() {
         HttpRequestParser parser13;
         parser13.appendData(chunks13[0].c_str(), chunks13[0].length());
         parser13.parse();
-        if (parser13.isComplete() && parser13.getRequest().getHeader("user-agent") == long_header_value) {
+        if (parser13.isComplete() && parser13.getRequest().header("user-agent") == long_header_value) {
             std::cout << "User-Agent header value is correct.\n";
             passed_tests++; // Pass if main test passes and header is correct
         } else {
@@ -306,7 +431,7 @@ int main() {
         HttpRequestParser parser14;
         parser14.appendData(chunks14[0].c_str(), chunks14[0].length());
         parser14.parse();
-        if (parser14.isComplete() && parser14.getRequest().headers.count("custom-header") && parser14.getRequest().getHeader("custom-header") == "") {
+        if (parser14.isComplete() && parser14.getRequest().hasHeader("custom-header") && parser14.getRequest().header("custom-header") == "") {
             std::cout << "Custom-Header with empty value is correct.\n";
             passed_tests++;
         } else {
@@ -323,7 +448,7 @@ int main() {
         HttpRequestParser parser15;
         parser15.appendData(chunks15[0].c_str(), chunks15[0].length());
         parser15.parse();
-        if (parser15.isComplete() && parser15.getRequest().getHeader("x-test") == "value:with:colons") {
+        if (parser15.isComplete() && parser15.getRequest().header("x-test") == "value:with:colons") {
             std::cout << "X-Test header with multiple colons is correct.\n";
             passed_tests++;
         } else {
@@ -365,14 +490,595 @@ int main() {
         passed_tests++;
     }
 
-    // Test Case 20: Malformed: Empty Header Line in Middle (Extraneous data after headers)
+    // Test Case 20: Empty Header Line in Middle: the first request completes, what follows is
+    // kept as the next (pipelined) request, which is malformed
     total_tests++;
     std::vector<std::string> chunks20;
     chunks20.push_back("GET / HTTP/1.1\r\nHost: example.com\r\n\r\nAnother-Header: value\r\n\r\n");
-    if (runParserTest("Malformed: Empty Header Line in Middle", chunks20, true)) { // CHANGE: Expected to error now
-        passed_tests++;
+    if (runParserTest("Pipelining: Empty Header Line in Middle", chunks20, false, "GET", "/")) {
+        HttpRequestParser parser20;
+        parser20.appendData(chunks20[0].c_str(), chunks20[0].length());
+        parser20.parse();
+        parser20.reset();
+        parser20.parse();
+        if (parser20.hasError()) {
+            std::cout << "Leftover bytes parsed as a malformed next request.\n";
+            passed_tests++;
+        } else {
+            std::cerr << "FAIL: Leftover bytes were not parsed as the next request.\n";
+        }
+    }
+
+    // Test Case 21: Pipelining: GET, POST with body and GET (no headers) in one chunk, served in order
+    total_tests++;
+    std::string pipelined = "GET /one HTTP/1.1\r\nHost: example.com\r\n\r\n"
+                            "POST /two HTTP/1.1\r\nHost: example.com\r\nContent-Length: 5\r\n\r\nhello"
+                            "GET /three HTTP/1.1\r\n\r\n";
+    std::cout << "=== Running Test: Pipelining: Three Requests in One Chunk ===\n";
+    {
+        HttpRequestParser parser21;
+        const char* expectedPaths[] = { "/one", "/two", "/three" };
+        bool ok = true;
+
+        parser21.appendData(pipelined.c_str(), pipelined.length());
+        for (int i = 0; i < 3 && ok; ++i) {
+            parser21.parse();
+            if (!parser21.isComplete() || parser21.getRequest().path() != expectedPaths[i]) {
+                std::cerr << "FAIL: Request " << i + 1 << " not complete or wrong path.\n";
+                ok = false;
+            } else if (i == 1 && std::string(parser21.getRequest().body.begin(), parser21.getRequest().body.end()) != "hello") {
+                std::cerr << "FAIL: Body of pipelined POST mismatch.\n";
+                ok = false;
+            }
+            parser21.reset();
+        }
+        if (ok && parser21.hasBufferedData()) {
+            std::cerr << "FAIL: Bytes left after the last pipelined request.\n";
+            ok = false;
+        }
+        if (ok) {
+            std::cout << "PASS: Pipelined requests parsed in order.\n";
+            passed_tests++;
+        }
+    }
+    std::cout << "================================\n\n";
+
+
+    // Test Case 22: Slow client: a head with many headers received one byte at a time
+    total_tests++;
+    std::string slowHead = "GET /slow HTTP/1.1\r\nHost: example.com\r\n";
+    for (int i = 0; i < 100; ++i) {
+        slowHead += "X-Header-" + StringUtils::longToString(i) + ": value " + StringUtils::longToString(i) + "\r\n";
+    }
+    slowHead += "\r\n";
+    std::cout << "=== Running Test: Slow Client: Head One Byte at a Time ===\n";
+    {
+        HttpRequestParser parser22;
+        for (size_t i = 0; i < slowHead.length(); ++i) {
+            parser22.appendData(slowHead.c_str() + i, 1);
+            parser22.parse();
+        }
+        if (parser22.isComplete() && parser22.getRequest().path() == "/slow"
+            && parser22.getRequest().headerCount() == 101
+            && parser22.getRequest().header("x-header-99") == "value 99") {
+            std::cout << "PASS: All 101 headers parsed from single-byte segments.\n";
+            passed_tests++;
+        } else {
+            std::cerr << "FAIL: Headers mismatch after single-byte segments.\n";
+        }
+    }
+    std::cout << "================================\n\n";
+
+    // Test Case 23: Header line over the limit: 431, detected before the head is complete
+    total_tests++;
+    std::cout << "=== Running Test: Limit: Header Line Too Large (431) ===\n";
+    {
+        HttpRequestParser parser23;
+        std::string head = "GET / HTTP/1.1\r\nCookie: " + std::string(2048, 'c');
+
+        parser23.setHeaderLimits(1024, 4096);
+        parser23.appendData(head.c_str(), head.length());
+        parser23.parse();
+        if (parser23.hasError() && parser23.getErrorStatus() == 431) {
+            std::cout << "PASS: Oversized header line refused with 431.\n";
+            passed_tests++;
+        } else {
+            std::cerr << "FAIL: Expected a 431 error.\n";
+        }
+    }
+    std::cout << "================================\n\n";
+
+    // Test Case 24: Request line over the limit: 414, and a whole head over the limit: 431
+    total_tests++;
+    std::cout << "=== Running Test: Limit: Request Line (414) and Head (431) Too Large ===\n";
+    {
+        HttpRequestParser parserLine;
+        HttpRequestParser parserHead;
+        std::string line = "GET /" + std::string(2048, 'a');
+        std::string head = "GET / HTTP/1.1\r\n";
+
+        for (int i = 0; i < 10; ++i) {
+            head += "X-Filler-" + StringUtils::longToString(i) + ": " + std::string(500, 'f') + "\r\n";
+        }
+        parserLine.setHeaderLimits(1024, 4096);
+        parserLine.appendData(line.c_str(), line.length());
+        parserLine.parse();
+        parserHead.setHeaderLimits(1024, 4096);
+        parserHead.appendData(head.c_str(), head.length());
+        parserHead.parse();
+        if (parserLine.hasError() && parserLine.getErrorStatus() == 414
+            && parserHead.hasError() && parserHead.getErrorStatus() == 431) {
+            std::cout << "PASS: 414 for the request line, 431 for the head.\n";
+            passed_tests++;
+        } else {
+            std::cerr << "FAIL: Expected 414 and 431 errors.\n";
+        }
+    }
+    std::cout << "================================\n\n";
+
+    // Test Case 25: Slices stay valid while the body arrives; a retained request survives the parser reset
+    total_tests++;
+    std::cout << "=== Running Test: Request Slices and retain() ===\n";
+    {
+        HttpRequestParser parser25;
+        std::string head = "POST /up?id=7&x HTTP/1.1\r\nHost: a.test\r\nX-Tag:  Blue \r\nx-tag: red\r\nContent-Length: 4000\r\n\r\n";
+        std::string body(4000, 'b');
+        std::string next = "GET /other HTTP/1.1\r\nHost: b.test\r\nX-Tag: green\r\n\r\n";
+
+        parser25.appendData(head.c_str(), head.length());
+        parser25.parse();
+        for (size_t i = 0; i < body.length(); i += 100) { // the buffer may be reallocated meanwhile
+            parser25.appendData(body.c_str() + i, 100);
+            parser25.parse();
+        }
+        parser25.appendData(next.c_str(), next.length());
+        HttpRequest kept = parser25.getRequest();
+        kept.retain();
+        parser25.reset();
+        parser25.parse();
+
+        bool ok = parser25.isComplete() && parser25.getRequest().path() == "/other"
+            && kept.methodId() == HTTP_POST && kept.path() == "/up" && kept.queryString() == "id=7&x"
+            && kept.queryParam("id") == "7" && kept.hasQueryParam("x") && !kept.hasQueryParam("y")
+            && kept.header("HOST") == "a.test" && kept.header("x-tag") == "red" && kept.headerCount() == 4
+            && kept.headerName(1) == "x-tag" && kept.headerValue(1) == "Blue" && kept.body.size() == 4000;
+        if (ok) {
+            std::cout << "PASS: Slices resolved through the body, retained copy independent of the parser.\n";
+            passed_tests++;
+        } else {
+            std::cerr << "FAIL: Request slices or retained copy mismatch.\n";
+        }
+    }
+    std::cout << "================================\n\n";
+
+    // Test Case 26: Well-known header names resolved to ids, unknown ones kept by name
+    total_tests++;
+    std::cout << "=== Running Test: Header Ids ===\n";
+    {
+        HttpRequestParser parser26;
+        std::string head = "GET / HTTP/1.1\r\nHOST: ids.test\r\nX-Custom: one\r\nContent-Type: text/plain\r\n"
+                           "x-custom: two\r\nHost: again.test\r\n\r\n";
+        bool ok = true;
+
+        for (int id = 0; id < HEADER_ID_COUNT; ++id) { // every known name lands on its own id
+            const char* name = HeaderNames::name(static_cast<HeaderId>(id));
+            ok = ok && HeaderNames::lookup(name, std::strlen(name)) == id;
+        }
+        ok = ok && HeaderNames::lookup("hostx", 5) == HEADER_UNKNOWN && HeaderNames::lookup("hos", 3) == HEADER_UNKNOWN;
+
+        parser26.appendData(head.c_str(), head.length());
+        parser26.parse();
+        const HttpRequest& req = parser26.getRequest();
+        ok = ok && parser26.isComplete()
+            && req.headerId(0) == HEADER_HOST && req.headerId(1) == HEADER_UNKNOWN && req.headerId(2) == HEADER_CONTENT_TYPE
+            && req.header(HEADER_HOST) == "again.test" && req.header("Host") == "again.test"
+            && req.header(HEADER_CONTENT_TYPE) == "text/plain" && req.header("X-CUSTOM") == "two"
+            && req.isOverridden(0) && req.isOverridden(1) && !req.isOverridden(2) && !req.isOverridden(4)
+            && !req.hasHeader(HEADER_CONTENT_LENGTH) && !req.hasHeader("x-other");
+        if (ok) {
+            std::cout << "PASS: Known headers indexed by id, unknown ones found by name.\n";
+            passed_tests++;
+        } else {
+            std::cerr << "FAIL: Header id mismatch.\n";
+        }
+    }
+    std::cout << "================================\n\n";
+
+    // Test Case 27: Chunked POST split at every byte boundary, with extension and trailer, then a pipelined GET
+    total_tests++;
+    std::cout << "=== Running Test: Chunked Body Split Anywhere ===\n";
+    {
+        std::string stream = "POST /up HTTP/1.1\r\nHost: c.test\r\nTransfer-Encoding: Chunked\r\n\r\n"
+                             "5;name=val\r\nhello\r\n1A\r\n, this is chunked data!!!!\r\n0\r\nX-Trailer: t\r\n\r\n"
+                             "GET /next HTTP/1.1\r\nHost: c.test\r\n\r\n";
+        std::string expected = "hello, this is chunked data!!!!";
+        bool ok = true;
+
+        for (size_t split = 0; split <= stream.size() && ok; ++split) {
+            HttpRequestParser parser27;
+
+            parser27.appendData(stream.c_str(), split);
+            parser27.parse();
+            parser27.appendData(stream.c_str() + split, stream.size() - split);
+            parser27.parse();
+            const std::vector<char>& body = parser27.getRequest().body;
+            ok = parser27.isComplete() && std::string(body.begin(), body.end()) == expected;
+            parser27.reset();
+            parser27.parse();
+            ok = ok && parser27.isComplete() && parser27.getRequest().path() == "/next";
+            if (!ok) {
+                std::cerr << "FAIL: Split at byte " << split << ".\n";
+            }
+        }
+        if (ok) {
+            std::cout << "PASS: Chunked body decoded identically for every split point.\n";
+            passed_tests++;
+        }
+    }
+    std::cout << "================================\n\n";
+
+    // Test Case 28: Chunked errors: limit (413 before the data), unsupported coding (501), malformed framing (400)
+    total_tests++;
+    std::cout << "=== Running Test: Chunked Body Errors ===\n";
+    {
+        const std::string head = "POST /up HTTP/1.1\r\nHost: c.test\r\nTransfer-Encoding: chunked\r\n\r\n";
+        const char* malformed[] = {
+            "x\r\n", "5\r\nhelloX\r\n", "5\nhello\r\n", "\r\n", "5 \r\nhello\r\n0\r\nbad\n",
+            "11111111111111111\r\n", "-1\r\n"
+        };
+        bool ok = true;
+        HttpRequestParser limited;
+
+        limited.setBodyLimit(10);
+        std::string over = head + "8\r\n12345678\r\n10\r\n";
+        limited.appendData(over.c_str(), over.size());
+        limited.parse();
+        ok = ok && limited.hasError() && limited.getErrorStatus() == 413 && limited.getRequest().body.size() == 8;
+
+        HttpRequestParser gzip;
+        std::string gz = "POST /up HTTP/1.1\r\nHost: c.test\r\nTransfer-Encoding: gzip, chunked\r\n\r\n";
+        gzip.appendData(gz.c_str(), gz.size());
+        gzip.parse();
+        ok = ok && gzip.hasError() && gzip.getErrorStatus() == 501;
+
+        HttpRequestParser both;
+        std::string bh = "POST /up HTTP/1.1\r\nHost: c.test\r\nContent-Length: 5\r\nTransfer-Encoding: chunked\r\n\r\n";
+        both.appendData(bh.c_str(), bh.size());
+        both.parse();
+        ok = ok && both.hasError() && both.getErrorStatus() == 400;
+
+        for (size_t i = 0; i < sizeof(malformed) / sizeof(malformed[0]); ++i) {
+            HttpRequestParser bad;
+            std::string req = head + malformed[i];
+
+            bad.appendData(req.c_str(), req.size());
+            bad.parse();
+            if (!bad.hasError() || bad.getErrorStatus() != 400) {
+                std::cerr << "FAIL: Malformed chunked body " << i << " not refused.\n";
+                ok = false;
+            }
+        }
+        if (ok) {
+            std::cout << "PASS: 413 over the limit, 501 for other codings, 400 for malformed framing.\n";
+            passed_tests++;
+        } else {
+            std::cerr << "FAIL: Chunked error handling mismatch.\n";
+        }
+    }
+    std::cout << "================================\n\n";
+
+    // Test Case 29: Fuzz: random bodies, encodings and read sizes decode to the original;
+    // mutated streams never read past their input and end decoded, refused or waiting
+    total_tests++;
+    std::cout << "=== Running Test: Chunked Decoder Fuzz ===\n";
+    {
+        bool ok = true;
+
+        for (int round = 0; round < 2000 && ok; ++round) {
+            std::string body;
+            size_t bodyLen = fuzzRand(round % 10 == 0 ? 20000 : 300);
+            for (size_t i = 0; i < bodyLen; ++i) {
+                body += static_cast<char>(fuzzRand(256));
+            }
+            std::string stream = encodeChunked(body) + "NEXT";
+            ChunkedDecoder decoder;
+            StringBodySink sink;
+            size_t pos = 0;
+
+            while (pos < stream.size() && !decoder.isDone() && !decoder.hasError()) {
+                size_t n = 1 + fuzzRand(fuzzRand(2) ? 7 : 4096);
+                if (n > stream.size() - pos) {
+                    n = stream.size() - pos;
+                }
+                size_t used = decoder.decode(stream.c_str() + pos, n, sink);
+                ok = ok && used <= n;
+                pos += used;
+                if (used < n) {
+                    break;
+                }
+            }
+            ok = ok && decoder.isDone() && sink.data == body && stream.substr(pos) == "NEXT";
+
+            // Mutation: flip, drop or insert bytes, then feed in random pieces
+            std::string mutated = stream;
+            for (size_t m = 1 + fuzzRand(4); m > 0 && !mutated.empty(); --m) {
+                size_t at = fuzzRand(mutated.size());
+                switch (fuzzRand(3)) {
+                    case 0: mutated[at] = static_cast<char>(fuzzRand(256)); break;
+                    case 1: mutated.erase(at, 1); break;
+                    default: mutated.insert(at, 1, "\r\n;0aF "[fuzzRand(7)]); break;
+                }
+            }
+            ChunkedDecoder fuzzed;
+            StringBodySink fuzzedSink;
+            fuzzed.setLimit(fuzzRand(2) ? 0 : bodyLen);
+            pos = 0;
+            while (pos < mutated.size() && !fuzzed.isDone() && !fuzzed.hasError()) {
+                size_t n = 1 + fuzzRand(64);
+                if (n > mutated.size() - pos) {
+                    n = mutated.size() - pos;
+                }
+                size_t used = fuzzed.decode(mutated.c_str() + pos, n, fuzzedSink);
+                ok = ok && used <= n;
+                pos += used;
+                if (used < n && !fuzzed.isDone() && !fuzzed.hasError()) {
+                    ok = false; // stopped early without a reason
+                }
+            }
+            ok = ok && fuzzedSink.data.size() == fuzzed.decodedSize() && fuzzedSink.data.size() <= mutated.size();
+            if (!ok) {
+                std::cerr << "FAIL: Fuzz round " << round << ".\n";
+            }
+        }
+        if (ok) {
+            std::cout << "PASS: 2000 random chunked streams decoded, mutated ones handled safely.\n";
+            passed_tests++;
+        }
+    }
+    std::cout << "================================\n\n";
+
+    // Test Case 30: Bodies over the threshold go to a file in the spool directory as they arrive
+    // (memory released), published under a name once complete; small ones stay in memory;
+    // an unpublished spool file disappears with the request
+    total_tests++;
+    std::cout << "=== Running Test: Body Spooled To Disk ===\n";
+    {
+        bool ok = true;
+        char dirTemplate[] = "/tmp/webserv_spool_XXXXXX";
+        std::string dir = mkdtemp(dirTemplate) ? dirTemplate : "";
+        HttpRequestParser parser;
+        SpoolRouter router(parser, dir, 64);
+        std::string big;
+        for (size_t i = 0; i < 100000; ++i) {
+            big += static_cast<char>(fuzzRand(256));
+        }
+        std::string raw = "POST /upload HTTP/1.1\r\nHost: x\r\nContent-Length: " + StringUtils::longToString(big.size())
+            + "\r\n\r\n" + big
+            + "POST /upload HTTP/1.1\r\nHost: x\r\nTransfer-Encoding: chunked\r\n\r\n" + encodeChunked(big)
+            + "POST /upload HTTP/1.1\r\nHost: x\r\nContent-Length: 10\r\n\r\nsmall body"
+            + "POST /upload HTTP/1.1\r\nHost: x\r\nContent-Length: 100\r\n\r\n" + big.substr(0, 100);
+        std::vector<std::string> published;
+        size_t pos = 0;
+        int served = 0;
+
+        ok = !dir.empty();
+        parser.setRequestRouter(&router);
+        while (ok && pos < raw.size()) {
+            size_t n = 1 + fuzzRand(3000);
+            if (n > raw.size() - pos) {
+                n = raw.size() - pos;
+            }
+            parser.appendData(raw.c_str() + pos, n);
+            pos += n;
+            parser.parse();
+            while (ok && parser.isComplete()) {
+                HttpRequest& req = parser.getRequest();
+
+                if (served < 2) { // large: spooled, nothing kept in memory
+                    std::string path = dir + "/upload" + StringUtils::longToString(served);
+                    ok = req.spool && req.body.capacity() == 0 && req.bodySize() == big.size()
+                        && req.spool->publish(path) && readFile(path) == big;
+                    published.push_back(path);
+                } else if (served == 2) { // under the threshold: in memory
+                    ok = !req.spool && std::string(req.body.begin(), req.body.end()) == "small body";
+                } else { // spooled but never published: gone with the reset
+                    ok = req.spool && req.bodySize() == 100;
+                }
+                ++served;
+                parser.reset();
+                parser.parse();
+            }
+        }
+        ok = ok && served == 4 && !parser.hasError() && countEntries(dir) == published.size();
+        for (size_t i = 0; i < published.size(); ++i) {
+            unlink(published[i].c_str());
+        }
+        if (!dir.empty()) {
+            rmdir(dir.c_str());
+        }
+        if (ok) {
+            std::cout << "PASS: Large bodies spooled and published, small one in memory, no leftover file.\n";
+            passed_tests++;
+        } else {
+            std::cerr << "FAIL: Spooled body mismatch (request " << served << ").\n";
+        }
     }
+    std::cout << "================================\n\n";
+
+    // Test Case 31: Routed before the body: the limit of the route is enforced from Content-Length
+    // with only the head received, and while a chunked body is decoded; every head is routed
+    total_tests++;
+    std::cout << "=== Running Test: Body Limit Set By Route ===\n";
+    {
+        bool ok = true;
+        const char* heads[] = {
+            "POST /small HTTP/1.1\r\nHost: x\r\nContent-Length: 11\r\n\r\n",
+            "POST /small HTTP/1.1\r\nHost: x\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nhello\r\n6\r\n",
+        };
+
+        for (size_t i = 0; i < sizeof(heads) / sizeof(heads[0]); ++i) {
+            HttpRequestParser parser;
+            LimitRouter router(parser);
 
+            parser.setRequestRouter(&router);
+            parser.appendData(heads[i], std::strlen(heads[i]));
+            parser.parse();
+            ok = ok && parser.hasError() && parser.getErrorStatus() == 413 && router.calls == 1;
+        }
+
+        HttpRequestParser parser;
+        LimitRouter router(parser);
+        std::string raw = "GET /small HTTP/1.1\r\nHost: x\r\n\r\n"
+            "POST /big HTTP/1.1\r\nHost: x\r\nContent-Length: 11\r\n\r\nhello world"
+            "POST /small HTTP/1.1\r\nHost: x\r\nContent-Length: 10\r\n\r\nsmall body";
+        int served = 0;
+
+        parser.setRequestRouter(&router);
+        parser.appendData(raw.c_str(), raw.size());
+        parser.parse();
+        while (parser.isComplete()) {
+            ++served;
+            parser.reset();
+            parser.parse();
+        }
+        ok = ok && served == 3 && router.calls == 3 && !parser.hasError();
+        if (ok) {
+            std::cout << "PASS: 413 from the route limit before the body, other requests served.\n";
+            passed_tests++;
+        } else {
+            std::cerr << "FAIL: Route body limit mismatch.\n";
+        }
+    }
+    std::cout << "================================\n\n";
+
+    // Test Case 32: A request answered by the router from its head ends there: its body is not read
+    total_tests++;
+    std::cout << "=== Running Test: Request Answered From Its Head ===\n";
+    {
+        HttpRequestParser parser;
+        LimitRouter router(parser);
+        std::string get = "GET /moved HTTP/1.1\r\nHost: x\r\n\r\n";
+        std::string post = "POST /moved HTTP/1.1\r\nHost: x\r\nContent-Length: 5\r\n\r\nhello";
+        bool ok;
+
+        parser.setRequestRouter(&router);
+        parser.appendData(get.c_str(), get.size());
+        parser.parse();
+        ok = parser.hasError() && parser.getErrorStatus() == 301 && router.bodies == 0;
+        parser.reset();
+        parser.appendData(post.c_str(), post.size());
+        parser.parse();
+        ok = ok && parser.hasError() && parser.getErrorStatus() == 301 && router.bodies == 1
+            && parser.getRequest().body.empty();
+        if (ok) {
+            std::cout << "PASS: Router answer ends the request, body left unread.\n";
+            passed_tests++;
+        } else {
+            std::cerr << "FAIL: Request answered from its head mismatch.\n";
+        }
+    }
+    std::cout << "================================\n\n";
+
+    // Test Case 33: A body announced by a GET is read as its body, never parsed as a pipelined request
+    total_tests++;
+    std::cout << "=== Running Test: Content-Length Honoured For Every Method ===\n";
+    {
+        HttpRequestParser parser;
+        std::string smuggled = "GET /a HTTP/1.1\r\nHost: x\r\nContent-Length: 37\r\n\r\n"
+                               "DELETE /uploads/f HTTP/1.1\r\nHost: x\r\n\r\n";
+        std::string negative = "GET /a HTTP/1.1\r\nHost: x\r\nContent-Length: -5\r\n\r\n";
+        bool ok;
+
+        parser.appendData(smuggled.c_str(), smuggled.size());
+        parser.parse();
+        ok = parser.isComplete() && parser.getRequest().path() == "/a"
+            && std::string(parser.getRequest().body.begin(), parser.getRequest().body.end())
+                == "DELETE /uploads/f HTTP/1.1\r\nHost: x\r\n";
+        parser.reset();
+        parser.parse(); // only the final CRLF is left: no second request
+        ok = ok && !(parser.isComplete() && parser.getRequest().methodId() == HTTP_DELETE);
+        parser.reset();
+        parser.appendData(negative.c_str(), negative.size());
+        parser.parse();
+        ok = ok && parser.hasError() && parser.getErrorStatus() == 400;
+        if (ok) {
+            std::cout << "PASS: GET body consumed, no smuggled DELETE; negative length refused.\n";
+            passed_tests++;
+        } else {
+            std::cerr << "FAIL: Content-Length of a GET not honoured.\n";
+        }
+    }
+    std::cout << "================================\n\n";
+
+    // Test Case 34: An oversized Content-Length is refused from the head for every method, no 100 Continue first
+    total_tests++;
+    std::cout << "=== Running Test: No 100 Continue Before A 413 ===\n";
+    {
+        ServerConfig server;
+        const char* methods[] = { "GET", "POST", "DELETE" };
+        bool ok = true;
+
+        server.clientMaxBodySize = 10;
+        for (size_t i = 0; i < 3; ++i) {
+            HttpRequestParser parser;
+            HeadRouter router(&server);
+            std::string big = std::string(methods[i]) + " /f HTTP/1.1\r\nHost: x\r\nContent-Length: 11\r\n"
+                              "Expect: 100-continue\r\n\r\n";
+            std::string small = std::string(methods[i]) + " /f HTTP/1.1\r\nHost: x\r\nContent-Length: 10\r\n"
+                                "Expect: 100-continue\r\n\r\n";
+
+            parser.setRequestRouter(&router);
+            parser.appendData(big.c_str(), big.size());
+            parser.parse();
+            ok = ok && parser.hasError() && parser.getErrorStatus() == 413 && router.sent == "HTTP/1.1 413\r\n";
+            parser.reset();
+            router.sent.clear();
+            parser.appendData(small.c_str(), small.size());
+            parser.parse();
+            ok = ok && !parser.hasError() && router.sent == "HTTP/1.1 100 Continue\r\n";
+        }
+        if (ok) {
+            std::cout << "PASS: 413 sent alone for GET, POST and DELETE; 100 Continue within the limit.\n";
+            passed_tests++;
+        } else {
+            std::cerr << "FAIL: 100 Continue sent before a 413, or limit not checked for every method.\n";
+        }
+    }
+    std::cout << "================================\n\n";
+
+    // Test Case 35: Releasing the buffer of an idle connection never loses bytes of a next request
+    total_tests++;
+    std::cout << "=== Running Test: Buffer Released Only When Idle ===\n";
+    {
+        HttpRequestParser parser;
+        std::string two = "GET /a HTTP/1.1\r\nHost: x\r\n\r\nGET /b HTTP/1.1\r\nHost: x\r\n\r\n";
+        std::string head = "GET /c HTTP/1.1\r\nHost: x\r\n\r\n";
+        bool ok;
+
+        parser.appendData(two.c_str(), two.size());
+        parser.parse();
+        ok = parser.isComplete() && parser.getRequest().path() == "/a";
+        parser.reset();
+        parser.releaseBuffer(); // pipelined request waiting: kept
+        parser.parse();
+        ok = ok && parser.isComplete() && parser.getRequest().path() == "/b";
+        parser.reset();
+        parser.releaseBuffer(); // idle: freed
+        ok = ok && !parser.hasBufferedData();
+        parser.appendData(head.c_str(), 12);
+        parser.parse();
+        parser.releaseBuffer(); // head under way: kept
+        parser.appendData(head.c_str() + 12, head.size() - 12);
+        parser.parse();
+        ok = ok && parser.isComplete() && parser.getRequest().path() == "/c";
+        if (ok) {
+            std::cout << "PASS: Pipelined bytes and a partial head survive, idle buffer freed.\n";
+            passed_tests++;
+        } else {
+            std::cerr << "FAIL: Releasing the buffer lost bytes of a request.\n";
+        }
+    }
+    std::cout << "================================\n\n";
 
     std::cout << "\n=== Test Suite Summary ===\n";
     std::cout << "Total Tests: " << total_tests << "\n";
@@ -0,0 +1,242 @@
+#include "../../includes/http/HttpResponse.hpp"
+#include "../../includes/http/HttpDate.hpp"
+
+#include <iostream>
+#include <map>
+#include <new>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <sstream>
+#include <sys/time.h>
+#include <sys/uio.h>
+
+// Microbenchmark of response serialization for bodies from 0 to 16 MB.
+// Compares the previous approach (ostringstream, body appended one char at a time, then the
+// whole string copied into a new char[] for send) with the current one: head written into one
+// buffer of its exact size, body handed over as its own iovec segment without being copied.
+// Then the fixed part of a response: default headers and status, previously formatted by every
+// constructor, now taken from the event loop's date clock and the status line table.
+
+#define BENCH_BYTES_PER_SIZE (64 * 1024 * 1024) // legacy bytes serialized per body size
+#define BENCH_MIN_ITERATIONS 8
+#define BENCH_HEAD_ITERATIONS 200000
+
+// Every heap allocation of the program goes through here: the runs count their own
+static size_t g_allocations = 0;
+
+void* operator new(size_t size) throw(std::bad_alloc) {
+    void* p = std::malloc(size ? size : 1);
+
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    g_allocations++;
+    return p;
+}
+
+// Not inlined: at -O2 GCC would otherwise see free() paired with operator new
+__attribute__((noinline))
+void operator delete(void* p) throw() {
+    std::free(p);
+}
+
+static double nowSec() {
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+// A typical static file response: what HttpRequestHandler sets for a GET
+static void fillResponse(HttpResponse& response, const std::vector<char>& body) {
+    response.setStatus(200);
+    response.addHeader("Content-Type", "text/html");
+    response.addHeader("Last-Modified", "Thu, 15 Oct 2026 08:12:31 GMT");
+    response.addHeader("Cache-Control", "max-age=3600");
+    response.addHeader("Connection", "keep-alive");
+    response.setBody(body);
+}
+
+// --- Previous implementation, kept here as the reference ---
+
+// What every HttpResponse constructor did for its Date header
+static std::string legacyDate() {
+    char buf[100];
+    time_t rawtime;
+    struct tm gmtm;
+
+    time(&rawtime);
+    gmtime_r(&rawtime, &gmtm);
+    strftime(buf, sizeof(buf), "%a, %d %b %Y %H:%M:%S GMT", &gmtm);
+    return std::string(buf);
+}
+
+// What setStatus did for the reason phrase (shortened: same shape, fewer cases)
+static std::string legacyReason(int statusCode) {
+    switch (statusCode) {
+        case 200: return "OK";
+        case 201: return "Created";
+        case 301: return "Moved Permanently";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 413: return "Payload Too Large";
+        case 500: return "Internal Server Error";
+        default: return "Unknown Status";
+    }
+}
+
+// Constructor (Server and Date stored as headers) followed by setStatus
+static size_t legacyFixedPart(int statusCode) {
+    std::map<std::string, std::string> headers;
+    std::string statusMessage("OK");
+
+    headers["Server"] = "Webserv/1.0";
+    headers["Date"] = legacyDate();
+    statusMessage = legacyReason(statusCode);
+    return headers.size() + statusMessage.size();
+}
+
+static std::string legacyToString(const HttpResponse& response) {
+    std::ostringstream oss;
+    const std::map<std::string, std::string>& headers = response.getHeaders();
+    const std::vector<char>& body = response.getBody();
+
+    oss << response.getProtocolVersion() << " " << response.getStatusCode() << " "
+        << legacyReason(response.getStatusCode()) << "\r\n";
+    oss << "Server: Webserv/1.0\r\n" << "Date: " << legacyDate() << "\r\n";
+    if (headers.find("Content-Type") == headers.end()) {
+        oss << "Content-Type: application/octet-stream\r\n";
+    }
+    std::map<std::string, std::string>::const_iterator it;
+    for (it = headers.begin(); it != headers.end(); ++it) {
+        oss << it->first << ": " << it->second << "\r\n";
+    }
+    oss << "\r\n";
+    for (size_t i = 0; i < body.size(); ++i) {
+        oss << body[i];
+    }
+    return oss.str();
+}
+
+// toString, then the copy Server::manageRespond made to keep the bytes until they were sent
+static size_t legacySerialize(const HttpResponse& response) {
+    std::string raw = legacyToString(response);
+    char* out = new char[raw.size()];
+
+    std::memcpy(out, raw.data(), raw.size());
+    size_t sent = raw.size() + static_cast<unsigned char>(out[raw.size() / 2]);
+    delete[] out;
+    return sent;
+}
+
+// --- Current implementation ---
+
+// Head in one exact-size buffer; body pointed at where it already is
+static size_t gatherSerialize(const HttpResponse& response, struct iovec iov[2]) {
+    std::string head = response.headToString();
+    const std::vector<char>& body = response.getBody();
+    int cnt = 1;
+
+    iov[0].iov_base = const_cast<char*>(head.data());
+    iov[0].iov_len = head.size();
+    if (!body.empty()) {
+        iov[1].iov_base = const_cast<char*>(&body[0]);
+        iov[1].iov_len = body.size();
+        cnt = 2;
+    }
+    return iov[0].iov_len + (cnt == 2 ? iov[1].iov_len : 0) + static_cast<unsigned char>(head[head.size() / 2]);
+}
+
+static void report(size_t bodySize, double legacyNs, size_t legacyAllocs, double gatherNs, size_t gatherAllocs) {
+    std::cout << "  body " << bodySize / 1024 << " KB\t: legacy " << static_cast<long>(legacyNs) << " ns, "
+              << legacyAllocs << " allocs | gather " << static_cast<long>(gatherNs) << " ns, "
+              << gatherAllocs << " allocs" << std::endl;
+}
+
+int main() {
+    const size_t sizes[] = { 0, 1024, 16 * 1024, 256 * 1024, 1024 * 1024, 16 * 1024 * 1024 };
+    size_t sink = 0;
+    bool ok = true;
+    double start;
+
+    HttpDate::tick(); // as the event loop does on each wakeup
+    std::cout << "Response serialization, per response (head ~230 bytes):" << std::endl;
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+        std::vector<char> body(sizes[s], 'b');
+        HttpResponse response;
+        struct iovec iov[2];
+        size_t iterations = BENCH_BYTES_PER_SIZE / (sizes[s] + 1024);
+        size_t allocs;
+        double legacyNs, gatherNs;
+        size_t legacyAllocs, gatherAllocs;
+
+        if (iterations < BENCH_MIN_ITERATIONS) {
+            iterations = BENCH_MIN_ITERATIONS;
+        }
+        fillResponse(response, body);
+
+        allocs = g_allocations;
+        start = nowSec();
+        for (size_t i = 0; i < iterations; ++i) {
+            sink += legacySerialize(response);
+        }
+        legacyNs = (nowSec() - start) * 1e9 / iterations;
+        legacyAllocs = (g_allocations - allocs) / iterations;
+
+        allocs = g_allocations;
+        start = nowSec();
+        for (size_t i = 0; i < BENCH_HEAD_ITERATIONS; ++i) {
+            sink += gatherSerialize(response, iov);
+        }
+        gatherNs = (nowSec() - start) * 1e9 / BENCH_HEAD_ITERATIONS;
+        gatherAllocs = (g_allocations - allocs) / BENCH_HEAD_ITERATIONS;
+
+        report(sizes[s], legacyNs, legacyAllocs, gatherNs, gatherAllocs);
+
+        // Same bytes on the wire: the head then the body, as in the previous single string
+        // (the date is left out of the comparison: the second may change in between)
+        std::string legacy = legacyToString(response);
+        std::string head = response.headToString();
+        size_t date = head.find("Date: ");
+
+        if (date == std::string::npos || legacy.size() != head.size() + body.size()
+            || legacy.compare(0, date, head, 0, date) != 0
+            || legacy.compare(date + 35, head.size() - date - 35, head, date + 35, head.size() - date - 35) != 0) {
+            std::cerr << "  MISMATCH with the previous serialization for a " << sizes[s] << " byte body" << std::endl;
+            ok = false;
+        }
+    }
+
+    // Fixed part of a response: construction and status, before any header of the handler
+    {
+        size_t allocs;
+        double legacyNs, currentNs;
+        size_t legacyAllocs, currentAllocs;
+
+        allocs = g_allocations;
+        start = nowSec();
+        for (int i = 0; i < BENCH_HEAD_ITERATIONS; ++i) {
+            sink += legacyFixedPart(405);
+        }
+        legacyNs = (nowSec() - start) * 1e9 / BENCH_HEAD_ITERATIONS;
+        legacyAllocs = (g_allocations - allocs) / BENCH_HEAD_ITERATIONS;
+
+        allocs = g_allocations;
+        start = nowSec();
+        for (int i = 0; i < BENCH_HEAD_ITERATIONS; ++i) {
+            HttpResponse response;
+
+            response.setStatus(405);
+            sink += response.getStatusCode();
+        }
+        currentNs = (nowSec() - start) * 1e9 / BENCH_HEAD_ITERATIONS;
+        currentAllocs = (g_allocations - allocs) / BENCH_HEAD_ITERATIONS;
+
+        std::cout << "Constructor + setStatus(405), per response:" << std::endl
+                  << "  legacy " << static_cast<long>(legacyNs) << " ns, " << legacyAllocs << " allocs | current "
+                  << static_cast<long>(currentNs) << " ns, " << currentAllocs << " allocs" << std::endl;
+    }
+    std::cout << "  (checksum " << sink % 1000 << ")" << std::endl;
+    return ok ? 0 : 1;
+}
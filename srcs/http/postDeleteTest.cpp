@@ -46,30 +46,22 @@ std::string longToString(long val) {
 HttpRequest createMockRequest(const std::string& method, const std::string& uri, const std::string& hostHeader,
                               const std::string& body = "", const std::string& contentType = "", long contentLength = -1) {
     HttpRequest req;
-    req.method = method;
-    req.uri = uri;
-    size_t query_pos = uri.find('?');
-    if (query_pos != std::string::npos) {
-        req.path = uri.substr(0, query_pos);
-    } else {
-        req.path = uri;
-    }
-    req.protocolVersion = "HTTP/1.1";
-    req.headers["host"] = hostHeader;
+    req.setRequestLine(method, uri, "HTTP/1.1"); // path and query string are derived from the URI
+    req.setHeader("host", hostHeader);
 
     if (!body.empty()) {
         req.body.assign(body.begin(), body.end());
         if (contentLength == -1) { // If contentLength not explicitly provided, use body size
-            req.headers["content-length"] = longToString(body.length()); // Use local longToString
+            req.setHeader("content-length", longToString(body.length())); // Use local longToString
         } else {
-            req.headers["content-length"] = longToString(contentLength); // Use local longToString
+            req.setHeader("content-length", longToString(contentLength)); // Use local longToString
         }
     } else if (contentLength != -1) { // If contentLength provided but body is empty (e.g., for 413 test)
-         req.headers["content-length"] = longToString(contentLength); // Use local longToString
+         req.setHeader("content-length", longToString(contentLength)); // Use local longToString
     }
 
     if (!contentType.empty()) {
-        req.headers["content-type"] = contentType;
+        req.setHeader("content-type", contentType);
     }
 
     req.currentState = HttpRequest::COMPLETE;
@@ -118,7 +110,7 @@ bool runDispatchAndHandleTest(const std::string& testName,
                               const std::string& expectedBodyContains,
                               const std::string& expectedLocationHeader = "") { // New optional param for Location header
     std::cout << "=== Running Test: " << testName << " ===\n";
-    std::cout << "  Request: " << request.method << " " << request.uri << " (Host: " << request.getHeader("host") << ")\n";
+    std::cout << "  Request: " << request.method() << " " << request.uri() << " (Host: " << request.header("host") << ")\n";
     std::cout << "  Client Conn: " << clientIp << ":" << clientPort << "\n";
 
     MatchedConfig matchedConfig = dispatcher.dispatch(request, clientIp, clientPort);
@@ -301,9 +293,9 @@ int main() {
     total_tests++;
     std::string uploadBody2 = "Content for my_custom_file.txt";
     HttpRequest req12 = createMockRequest("POST", "/upload", "example.com", uploadBody2, "text/plain");
-    req12.headers["content-length"] = longToString(uploadBody2.length());
-    req12.headers["content-type"] = "text/plain";
-    req12.headers["content-disposition"] = "form-data; name=\"file\"; filename=\"my_custom_file.txt\"";
+    req12.setHeader("content-length", longToString(uploadBody2.length()));
+    req12.setHeader("content-type", "text/plain");
+    req12.setHeader("content-disposition", "form-data; name=\"file\"; filename=\"my_custom_file.txt\"");
     if (runDispatchAndHandleTest("TC12: File upload with custom filename",
                                  dispatcher, handler, req12, "127.0.0.1", 8080,
                                  201, "text/html", "File uploaded successfully", "/upload/my_custom_file.txt")) {
@@ -327,7 +319,7 @@ int main() {
     total_tests++;
     std::cout << "WARNING: For TC14, you need to manually set `chmod 000 /Users/baptistevieilhescaze/dev/webserv42/www/uploads` BEFORE running this test, and `chmod 777` AFTER.\n";
     HttpRequest req14 = createMockRequest("POST", "/upload", "example.com", "This should fail.", "text/plain");
-    req14.headers["content-length"] = longToString(req14.body.size());
+    req14.setHeader("content-length", longToString(req14.body.size()));
     if (runDispatchAndHandleTest("TC14: POST to non-writable upload directory (403)",
                                  dispatcher, handler, req14, "127.0.0.1", 8080,
                                  403, "text/html", "Forbidden")) {
@@ -35,16 +35,8 @@ bool readFile(const std::string &fileName, std::string &out);
 // Helper function to create a mock HttpRequest
 HttpRequest createMockRequest(const std::string& method, const std::string& uri, const std::string& hostHeader) {
     HttpRequest req;
-    req.method = method;
-    req.uri = uri;
-    size_t query_pos = uri.find('?');
-    if (query_pos != std::string::npos) {
-        req.path = uri.substr(0, query_pos);
-    } else {
-        req.path = uri;
-    }
-    req.protocolVersion = "HTTP/1.1";
-    req.headers["host"] = hostHeader; // Headers map uses lowercase keys by default
+    req.setRequestLine(method, uri, "HTTP/1.1"); // path and query string are derived from the URI
+    req.setHeader("host", hostHeader); // Header names are stored lowercase
     req.currentState = HttpRequest::COMPLETE;
     return req;
 }
@@ -88,7 +80,7 @@ bool runDispatchAndHandleTest(const std::string& testName,
                               const std::string& expectedContentType,
                               const std::string& expectedBodyContains) {
     std::cout << "=== Running Test: " << testName << " ===\n";
-    std::cout << "  Request: " << request.method << " " << request.uri << " (Host: " << request.getHeader("host") << ")\n";
+    std::cout << "  Request: " << request.method() << " " << request.uri() << " (Host: " << request.header("host") << ")\n";
     std::cout << "  Client Conn: " << clientIp << ":" << clientPort << "\n";
 
     MatchedConfig matchedConfig = dispatcher.dispatch(request, clientIp, clientPort);
@@ -1,4 +1,6 @@
 #include "webserv.hpp"
+#include <csignal>
+#include <cstdlib>
 
 int main(int argc, char **argv){
     if(argc < 1 || argc > 2)
@@ -7,42 +9,48 @@ int main(int argc, char **argv){
         std::cerr << "please use [./webserv] or [./webserv *.conf]" << std::endl;
         return (1);
     }
-    Config config;//declaration des class
-    try{
-        if (argc == 2)
-            std::string fConf(argv[1]);
-        else
-            std::string fConf("default.conf");
-        config.checkConfig(fConf);//definir string puis allouer en une fois
-    }
-    catch (std::exception &e){
+    std::string     fConf = (argc == 2) ? argv[1] : DEFAULT_CONF;
+    GlobalConfig    config;
+    if (!loadGlobalConfig(fConf, config))
+    {
         std::cerr << "Config error occured, plese check if your file is good!" << std::endl;
         return (1);
     }
-    Server server(&config);
+    setConfigPath(fConf);//relu au SIGHUP
+    publishConfig(config);//snapshot 1 : les Server la prennent a leur construction
+    signal(SIGPIPE, SIG_IGN);//client ferme pendant un send : on gere l'erreur, pas de kill
+    saveProgramArgs(argc, argv);//SIGUSR2 relance ce meme chemin avec ces arguments
+    //backend d'evenements : epoll par defaut, WEBSERV_EVENT_BACKEND=poll pour comparer
+    const char*     backend = std::getenv("WEBSERV_EVENT_BACKEND");
     try {
-        server.run();//boucle principale
+        if (config.workerProcesses != 1)
+        {//worker_processes : le master fork les workers, chacun avec ses sockets SO_REUSEPORT
+            closeInheritedListeners();//les workers ouvrent leurs propres sockets SO_REUSEPORT
+            Master master(&config, backend ? backend : "epoll");
+            master.run();
+            return (0);
+        }
+        if (config.workerThreads != 1)
+        {//worker_threads : un reacteur par thread, chacun avec ses sockets SO_REUSEPORT
+            installLifecycleSignals(true);
+            closeInheritedListeners();
+            ReactorPool pool(&config, backend ? backend : "epoll");
+            pool.run();
+            return (0);
+        }
+        installLifecycleSignals(true);
+        Server server(&config, backend ? backend : "epoll");
+        closeInheritedListeners();//ports que la nouvelle config n'ecoute plus
+        server.run();//boucle principale, rend la main apres un upgrade ou un SIGQUIT
+    }
+    catch (const char* e){
+        std::cerr << e << std::endl;
+        std::cerr << "Webserv off" << std::endl;
+        return (1);
     }
     catch (std::exception &e){
         std::cerr << "Webserv off" << std::endl;
+        return (1);
     }
     return (0);
 }
-//     try{
-//         //signal(SIGPIPE, f*sighandle); -> gerer si sig pipe (err, type fermture client)
-//         //choix config : fournie ou default
-//         //initialisation
-//         //boucle -> prio ->f*run
-//     }
-//     catch (std::exception &e){
-//         std::cerr << e.what() << std::endl;
-// //        return (1); on considere que ca cree une erreur majeure?
-//     }
-
-// void    fRun(){
-//     //while(1, true, etc){
-//     //1.check all ok (nb conn max, etc)
-//     //2.check si : new co, co dispo, lis contenu ou envoie les requetes
-//     //3.check time out -> non bloquant, timeout via poll et fixe a notre jugé
-//     //}
-// }
\ No newline at end of file
@@ -0,0 +1,45 @@
+#include "../../includes/server/BufferPool.hpp"
+
+BufferPool::BufferPool() : _inUse(0) {
+}
+
+//les blocs encore empruntes sont rendus par les connexions avant (Server::~Server)
+BufferPool::~BufferPool() {
+	for (size_t i = 0; i < _free.size(); i++)
+		delete[] _free[i];
+}
+
+char*	BufferPool::acquire(void) {
+	char*	chunk;
+
+	if (_free.empty())
+		chunk = new char[RECV_CHUNK_SIZE];
+	else
+	{
+		chunk = _free.back();
+		_free.pop_back();
+	}
+	_inUse++;
+	return (chunk);
+}
+
+//au dela de la reserve, le bloc est libere : un pic de connexions ne reste pas en memoire
+void	BufferPool::release(char* chunk) {
+	if (!chunk)
+		return ;
+	_inUse--;
+	if (_free.size() >= RECV_POOL_MAX_FREE)
+	{
+		delete[] chunk;
+		return ;
+	}
+	_free.push_back(chunk);
+}
+
+size_t	BufferPool::inUse(void) const {
+	return (_inUse);
+}
+
+size_t	BufferPool::available(void) const {
+	return (_free.size());
+}
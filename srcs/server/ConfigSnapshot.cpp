@@ -0,0 +1,103 @@
+#include "../../includes/server/ConfigSnapshot.hpp"
+#include "../../includes/config/Lexer.hpp"
+#include "../../includes/config/Parser.hpp"
+#include "../../includes/config/ConfigLoader.hpp"
+#include <pthread.h>
+#include <iostream>
+
+static pthread_mutex_t	g_snapLock = PTHREAD_MUTEX_INITIALIZER;
+static ConfigSnapshot*	g_current = NULL;	// la reference de g_current compte dans refs
+static unsigned long	g_generation = 0;
+static std::string		g_configPath;
+
+ConfigSnapshot::ConfigSnapshot(const GlobalConfig& cfg, unsigned long gen)
+	: config(cfg), dispatcher(config), generation(gen), refs(1) {
+}
+
+//lexer -> parser -> loader : meme chaine que dans les tests de config
+bool	loadGlobalConfig(const std::string& path, GlobalConfig& config) {
+	std::string				content;
+	std::vector<ASTnode*>	ast;
+
+	if (!readFile(path, content))
+	{
+		std::cerr << "cannot read config file " << path << std::endl;
+		return (false);
+	}
+	try {
+		Lexer			lexer(content);
+		Parser			parser(lexer.getTokens());
+		ConfigLoader	loader;
+
+		ast = parser.parse();
+		loader.loadConfig(ast, config);
+		parser.cleanupAST(ast);
+	}
+	catch (std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return (false);
+	}
+	return (true);
+}
+
+//fichier relu a chaque SIGHUP
+void	setConfigPath(const std::string& path) {
+	g_configPath = path;
+}
+
+//remplace la snapshot courante ; l'ancienne vit tant qu'un Server ou une connexion la tient
+void	publishConfig(const GlobalConfig& config) {
+	ConfigSnapshot*	old;
+
+	pthread_mutex_lock(&g_snapLock);
+	old = g_current;
+	g_current = new ConfigSnapshot(config, ++g_generation);
+	pthread_mutex_unlock(&g_snapLock);
+	if (old)
+		releaseConfig(old);
+}
+
+//SIGHUP : une config invalide est refusee en entier, on garde celle qui tourne
+bool	reloadConfig(void) {
+	GlobalConfig	config;
+
+	if (g_configPath.empty() || !loadGlobalConfig(g_configPath, config))
+	{
+		std::cerr << "- reload: " << g_configPath << " rejected, keeping the current config" << std::endl;
+		return (false);
+	}
+	publishConfig(config);
+	std::cout << "- reload: " << g_configPath << " loaded (generation " << currentConfigGeneration() << ")" << std::endl;
+	return (true);
+}
+
+//NULL si rien n'a encore ete publie
+ConfigSnapshot*	acquireCurrentConfig(void) {
+	ConfigSnapshot*	snap;
+
+	pthread_mutex_lock(&g_snapLock);
+	snap = g_current;
+	if (snap)
+		retainConfig(snap);
+	pthread_mutex_unlock(&g_snapLock);
+	return (snap);
+}
+
+unsigned long	currentConfigGeneration(void) {
+	unsigned long	gen;
+
+	pthread_mutex_lock(&g_snapLock);
+	gen = g_generation;
+	pthread_mutex_unlock(&g_snapLock);
+	return (gen);
+}
+
+//compteur atomique : les reacteurs d'un process partagent les snapshots sans verrou
+void	retainConfig(ConfigSnapshot* snap) {
+	__sync_add_and_fetch(&snap->refs, 1);
+}
+
+void	releaseConfig(ConfigSnapshot* snap) {
+	if (snap && __sync_sub_and_fetch(&snap->refs, 1) == 0)
+		delete snap;
+}
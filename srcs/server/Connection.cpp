@@ -1,98 +1,438 @@
 #include "../../includes/server/Connection.hpp"
+#include "../../includes/http/HttpRequestHandler.hpp"
 
-Connection::Connection() {
+Connection::Connection() : _snapshot(NULL), _dispatcher(NULL), _closeAfterFlush(false), _peerClosed(false), _noKeepAlive(false), _interest(0), _requests(0), _timerPhase(-1),
+    _admission(NULL), _rateLimiter(NULL), _countedPending(false), _readCut(false), _clientIp(0), _queued(0), _routed(false), _limitChecked(false), _linger(false), _lingerDeadline(0) {
+    _parser.setRequestRouter(this);
 }
 
 Connection::~Connection() {
 }
 
-void    Connection::handleRequest(char str[BUFF_SIZE]) {//A MODIF A PARTIR DE REQUEST
-	int n = 0;
-    while (n < BUFF_SIZE)
+//la reference sur snap est prise par le Server (retainConfig) : la connexion ne fait que la porter
+void    Connection::setSnapshot(ConfigSnapshot* snap, ServerConfig* serverBlock) {
+    _snapshot = snap;
+    _dispatcher = &snap->dispatcher;
+    setServerBlock(serverBlock);
+    if (!serverBlock)
+        return ;
+    //large_client_header_buffers : une ligne <= taille d'un buffer, l'en-tete <= tous les buffers
+    _parser.setHeaderLimits(serverBlock->largeHeaderBufferSize,
+        serverBlock->largeHeaderBuffers * serverBlock->largeHeaderBufferSize);
+}
+
+ConfigSnapshot* Connection::getSnapshot(void) const {
+    return (_snapshot);
+}
+
+void    Connection::setAdmission(AdmissionStats* admission) {
+    _admission = admission;
+}
+
+void    Connection::setRateLimiter(RateLimiter* limiter) {
+    _rateLimiter = limiter;
+}
+
+//IPv4 telle quelle ; une adresse IPv6 est repliee sur 32 bits (le server n'ecoute qu'en IPv4)
+void    Connection::setClientAddr(const struct sockaddr_storage& addr) {
+    if (addr.ss_family == AF_INET)
+        _clientIp = reinterpret_cast<const struct sockaddr_in*>(&addr)->sin_addr.s_addr;
+    else if (addr.ss_family == AF_INET6)
+    {
+        const unsigned char*    b = reinterpret_cast<const struct sockaddr_in6*>(&addr)->sin6_addr.s6_addr;
+
+        _clientIp = 0;
+        for (int i = 0; i < 16; i++)
+            _clientIp = _clientIp * 31 + b[i];
+    }
+}
+
+bool    Connection::isCountedPending(void) const {
+    return (_countedPending);
+}
+
+void    Connection::setCountedPending(bool counted) {
+    _countedPending = counted;
+}
+
+bool    Connection::isReadCut(void) const {
+    return (_readCut);
+}
+
+void    Connection::setReadCut(bool cut) {
+    _readCut = cut;
+}
+
+static std::string  buildOverloadResponse(void) {
+    HttpResponse    response;
+
+    response.setStatus(503);
+    response.addHeader("Content-Type", "text/html");
+    response.addHeader("Retry-After", OVERLOAD_RETRY_AFTER);
+    response.addHeader("Connection", "close");
+    response.removeHeader("Date");//facultatif pour un 5xx (RFC 9110), et fige il serait faux
+    response.setBody("<html><body><h1>503 Service Unavailable</h1></body></html>");
+    return (response.toString());
+}
+
+//503 de surcharge serialise une fois pour toutes : le delester ne coute qu'une copie
+const std::string&  Connection::overloadResponse(void) {
+    static const std::string    raw = buildOverloadResponse();
+
+    return (raw);
+}
+
+//donne les octets recus au parser, et construit les reponses des requetes completes
+void    Connection::handleRequest(const char* buf, size_t len) {
+    if (_closeAfterFlush)
+        return ;//derniere reponse en file : on n'ecoute plus le client
+    _parser.appendData(buf, len);
+    processRequests();
+}
+
+//pipelining : toutes les requetes completes du tampon sont servies dans l'ordre d'arrivee,
+//leurs reponses s'empilent dans _out et partent ensemble au prochain flush.
+//Au-dela de PIPELINE_MAX_RESPONSES on s'arrete, les octets restent dans le parser (resumePipeline)
+//et le serveur ne lit plus le socket tant que la file n'est pas partie (isPipelinePaused)
+void    Connection::processRequests(void) {
+    while (!_closeAfterFlush && _queued < PIPELINE_MAX_RESPONSES)
     {
-        if (requestResponseList.size() == 0
-            || requestResponseList[requestResponseList.size() - 1].first->isFullyParsed())
-        {//check si pas de requete en cours de traitement, ou si end requete entierement analysee 
-            Request* req = new Request;
-            std::pair<Request*, Response*> my_pair = std::make_pair(req, (Response*)0);
-            requestResponseList.push_back(my_pair);
-	    }//associe la new requete a une reponse pas encore definie
-	    Request* last_req = requestResponseList[requestResponseList.size() - 1].first;
-        try {
-	        n = last_req->parseRequest(str, n, getServerBlock());
-            last_req->parse_status = "OK";
-			last_req->setStatusCode(200);
+        _parser.parse();
+        if (_parser.hasError())
+        {//400, 413 si le corps chunked depasse client_max_body_size, 414 / 431 si la ligne
+         //de requete / l'en-tete depasse large_client_header_buffers ; une requete refusee des
+         //l'en-tete (routeRequest) a deja sa reponse en file.
+         //Le client envoie peut-etre encore son corps : fermeture en douceur apres la reponse
+            if (!_closeAfterFlush)
+                buildErrorResponse(_parser.getErrorStatus());
+            _linger = true;
+            _parser.reset();
+            _routed = false;
+            _limitChecked = false;
+            return ;
+        }
+        if (!_parser.isComplete())
+            return ;//requete suivante incomplete : on attend la suite
+        if (_admission && _admission->overloaded)
+            shedRequest();//surcharge : on ne touche ni au disque ni au CGI
+        else
+        {
+            if (_admission)
+                _admission->admitted++;
+            buildResponse();
         }
-		catch (std::exception& e) {
-            n = BUFF_SIZE;//fini la boucle while
-			try {
-				e = dynamic_cast<Request::BadRequestException &>(e);
-				last_req->setStatusCode(400);
-			} catch (std::bad_cast const&) {}
-			try {
-				e = dynamic_cast<Request::NotFoundException &>(e);
-				last_req->setStatusCode(404);
-			} catch (std::bad_cast const&) {}
-			try {
-				e = dynamic_cast<Request::HttpVersionNotSupportedException &>(e);
-	            last_req->parse_status = "VersionMismatch";
-				last_req->setStatusCode(505);
-			} catch (std::bad_cast const&) {}
-			try {
-				e = dynamic_cast<Request::ContentTooLargeException &>(e);
-	            last_req->parse_status = "ContentTooLarge";
-				last_req->setStatusCode(413);
-			} catch (std::bad_cast const&) {}
-            try {
-				e = dynamic_cast<Request::UnauthorizedException &>(e);
-	            last_req->parse_status = "Unauthorized";
-				last_req->setStatusCode(401);
-			} catch (std::bad_cast const&) {}
-            try {
-				e = dynamic_cast<Request::RedirectException &>(e);
-	            last_req->parse_status = "Redirect";
-                last_req->setStatusCode(302);
-			} catch (std::bad_cast const&) {}
-		}
-	}
-}
-
-std::string Connection::getRawResponse(void) {
-	std::string str_rep;
-    //iterite tte les paires requetes-reponses et agis en consequence pouir chacune
-    for (std::vector<std::pair<Request*, Response*> >::iterator it = requestResponseList.begin(); it != requestResponseList.end(); ++it) {
-	    Request* req = it->first;
-		if (req->getStatusCode() != OK)//MACRO OK a definir
+        _parser.reset();//un corps spoole et non publie est supprime
+        _routed = false;
+        _limitChecked = false;
+    }
+}
+
+//blocs pour le prochain readv : 16 KiB pour un en-tete, 64 KiB pendant un corps.
+//iov doit pouvoir contenir RECV_CHUNKS_BODY entrees ; renvoie le nombre d'entrees remplies
+int     Connection::prepareRecv(BufferPool& pool, struct iovec* iov) {
+    size_t  wanted = (getPhase() == CONN_BODY) ? RECV_CHUNKS_BODY : RECV_CHUNKS_HEADERS;
+
+    while (_rxChunks.size() > wanted)
+    {
+        pool.release(_rxChunks.back());
+        _rxChunks.pop_back();
+    }
+    while (_rxChunks.size() < wanted)
+        _rxChunks.push_back(pool.acquire());
+    for (size_t i = 0; i < wanted; i++)
+    {
+        iov[i].iov_base = _rxChunks[i];
+        iov[i].iov_len = RECV_CHUNK_SIZE;
+    }
+    return (static_cast<int>(wanted));
+}
+
+//donne au parser les len octets que readv a ranges dans les blocs, dans l'ordre
+void    Connection::consumeRecv(size_t len) {
+    for (size_t i = 0; i < _rxChunks.size() && len > 0; i++)
+    {
+        size_t  n = (len < RECV_CHUNK_SIZE) ? len : RECV_CHUNK_SIZE;
+
+        handleRequest(_rxChunks[i], n);
+        len -= n;
+    }
+}
+
+//connexion au repos (ou fermee) : les blocs retournent au pool, plus rien de reserve pour elle
+//(le tampon du parser aussi, s'il ne contient rien de la requete suivante)
+void    Connection::releaseRecvBuffers(BufferPool& pool) {
+    for (size_t i = 0; i < _rxChunks.size(); i++)
+        pool.release(_rxChunks[i]);
+    _rxChunks.clear();
+    _parser.releaseBuffer();
+}
+
+//en-tete complet, aucun octet du corps lu : on dispatche tout de suite (resultat garde pour buildResponse).
+//Le client_max_body_size de la location est donne au parser, qui le verifie pendant le decodage chunked.
+//Un upload plus gros que client_body_buffer_size part au fil de l'eau dans un fichier
+//temporaire de son upload_store, publie par le handler : la memoire ne depend pas de sa taille.
+//Si un corps suit, ce qui se decide sans lui (surcharge, limit_req, redirection, methode, Content-Length trop grand) est
+//tranche ici : reponse finale tout de suite et corps jamais lu, sinon "100 Continue" au client qui l'attend.
+//Renvoie le statut de la reponse deja en file, 0 pour lire le corps
+int     Connection::routeRequest(const HttpRequest& req, bool bodyFollows) {
+    ServerConfig*           sb = getServerBlock();
+    const ServerConfig*     server;
+    const LocationConfig*   loc;
+    long                    maxBody;
+
+    if (!_dispatcher || !sb)
+        return (0);
+    _matched = _dispatcher->dispatch(req, sb->host, sb->port);
+    _routed = true;
+    server = _matched.server_config ? _matched.server_config : sb;
+    loc = _matched.location_config;
+    maxBody = (loc && loc->clientMaxBodySize != 0) ? loc->clientMaxBodySize : server->clientMaxBodySize;
+    _parser.setBodyLimit(maxBody > 0 ? static_cast<size_t>(maxBody) : 0);
+    if (req.methodId() == HTTP_POST && loc && !loc->uploadStore.empty() && loc->clientBodyBufferSize >= 0)
+        _parser.spoolBodyTo(loc->uploadStore, static_cast<size_t>(loc->clientBodyBufferSize));
+    if (!bodyFollows)
+        return (0);
+
+    if (_admission && _admission->overloaded)
+    {//surcharge : 503 avant que l'upload ne soit lu ni spoole
+        shedRequest();
+        return (503);
+    }
+
+    unsigned long       waitMs = limitReqWait(loc, sb->port);
+    HttpRequestHandler  handler;
+    HttpResponse        response;
+
+    _limitChecked = true;
+    if (waitMs)
+    {//client trop rapide : 429 avant que son upload ne soit lu ni spoole
+        _requests++;
+        buildRateLimitedResponse(waitMs, false);
+        return (429);
+    }
+    if (handler.answerFromHead(req, _matched, response))
+    {
+        _requests++;
+        queueResponse(response, false);//le corps n'est pas lu : on ne sait pas ou commence la suite
+        return (response.getStatusCode());
+    }
+    //pas de 100 si le client a deja commence a envoyer le corps (RFC 9110, 10.1.1)
+    if (req.header(HEADER_EXPECT).iequals("100-continue") && !_parser.hasBufferedData())
+    {
+        std::string continueLine(CONTINUE_RESPONSE);
+
+        _out.pushText(continueLine);
+    }
+    return (0);
+}
+
+//dispatch sur le bon server/location puis passe la main au handler http
+void    Connection::buildResponse(void) {
+    const HttpRequest&  req = _parser.getRequest();
+    ServerConfig*       sb = getServerBlock();
+
+    if (!_dispatcher || !sb)
+    {
+        buildErrorResponse(500);
+        return ;
+    }
+    MatchedConfig           matched = _routed ? _matched : _dispatcher->dispatch(req, sb->host, sb->port);
+    const LocationConfig*   loc = matched.location_config;
+    bool                    keepAlive;
+
+    _requests++;
+    keepAlive = !_noKeepAlive && wantsKeepAlive(req)
+        && sb->keepaliveTimeout > 0 && _requests < (unsigned long)sb->keepaliveRequests;
+    if (!_limitChecked)
+    {//limit_req d'une requete sans corps : verifie avant le handler, un client trop rapide ne coute ni disque ni CGI
+        unsigned long   waitMs = limitReqWait(loc, sb->port);
+        if (waitMs)
         {
-	        it->second = new NotOkResponse();
-            //tente de recup un chemin de page d'erreur personalisé via config
-	        std::string errorPath = getServerBlock()->getErrorPath(req->getStatusCode());
-	        if (!errorPath.empty())//construit en fonction de celle ci
-	            it->second->constructConfigResponse(*req, errorPath);
-            else//page d'erreur par defaut est construite
-                it->second->constructDefaultResponseWithBody(*req, getDefaultErrorPage(req->getStatusCode()));
-	        str_rep = it->second->getRawResponse();//chaine de reponse brute generee a partir de reponse
-            delete it->first;
-            delete it->second;
-            requestResponseList.erase(it);//la paire est enlevee de la liste
+            buildRateLimitedResponse(waitMs, keepAlive);
+            return ;
         }
-        else if (req->isFullyParsed()) {//with enum (+ pratique), modif par map/vector possible
-            try {
-                if (req->getRequestMethod() == GET)
-                    it->second = new GetResponse(getServerBlock());
-                if (req->getRequestMethod() == POST)
-                    it->second = new PostResponse(getServerBlock());
-                if (req->getRequestMethod() == DELETE)
-                    it->second = new DeleteResponse(getServerBlock());
-            } catch (std::exception& e) {
-                throw ("Error with request\n");
-            }
-            it->second->constructResponse(*req);//construit avec la methode appropriee
-            str_rep = it->second->getRawResponse();
-            delete it->first;
-            delete it->second;
-            requestResponseList.erase(it);
+    }
+    HttpRequestHandler  handler;
+    HttpResponse        response = handler.handleRequest(req, matched);
+
+    queueResponse(response, keepAlive);
+}
+
+//requete delestee : 503 deja serialise, derniere reponse de la connexion
+void    Connection::shedRequest(void) {
+    std::string raw = overloadResponse();
+
+    _admission->shed++;
+    _closeAfterFlush = true;
+    _out.pushText(raw);
+    _queued++;
+}
+
+//limit_req de la location, dans la table du reacteur : attente en ms avant que le client
+//soit de nouveau servi, 0 s'il passe
+unsigned long   Connection::limitReqWait(const LocationConfig* loc, int port) {
+    if (!loc || loc->limitReqRate <= 0 || !_rateLimiter)
+        return (0);
+    return (_rateLimiter->check(_clientIp, RateLimiter::zoneId(port, loc->path),
+        loc->limitReqRate, loc->limitReqBurst, TimerWheel::nowMs()));
+}
+
+//429 : Retry-After arrondi a la seconde superieure ; la connexion reste utilisable
+void    Connection::buildRateLimitedResponse(unsigned long waitMs, bool keepAlive) {
+    HttpResponse    response;
+
+    response.setStatus(429);
+    response.addHeader("Content-Type", "text/html");
+    response.addHeader("Retry-After", StringUtils::longToString((waitMs + 999) / 1000));
+    response.setBody("<html><body><h1>429 Too Many Requests</h1></body></html>");
+    queueResponse(response, keepAlive);
+}
+
+//HTTP/1.1 : persistante sauf "Connection: close" ; HTTP/1.0 : seulement avec "Connection: keep-alive"
+bool    Connection::wantsKeepAlive(const HttpRequest& req) const {
+    std::string value = req.header(HEADER_CONNECTION).str();
+
+    for (size_t i = 0; i < value.size(); i++)
+        value[i] = std::tolower(static_cast<unsigned char>(value[i]));
+    if (value.find("close") != std::string::npos)
+        return (false);
+    if (req.protocolVersion() == "HTTP/1.1")
+        return (true);
+    return (value.find("keep-alive") != std::string::npos);
+}
+
+//reponse minimale quand on n'a meme pas de requete exploitable
+void    Connection::buildErrorResponse(int statusCode) {
+    HttpResponse    response;
+    std::string     msg = getHttpStatusMessage(statusCode);
+
+    response.setStatus(statusCode);
+    response.addHeader("Content-Type", "text/html");
+    response.setBody("<html><body><h1>" + StringUtils::longToString(statusCode) + " " + msg + "</h1></body></html>");
+    queueResponse(response, false);//requete illisible : on ne sait plus ou commence la suivante
+}
+
+//met la reponse en file sans la recopier : bloc d'en-tetes, puis corps (memoire ou plage de fichier)
+void    Connection::queueResponse(HttpResponse& response, bool keepAlive) {
+    response.addHeader("Connection", keepAlive ? "keep-alive" : "close");
+    if (!keepAlive)
+        _closeAfterFlush = true;
+
+    std::string         head = response.headToString();
+
+    if (response.hasBodyFile())
+    {
+        int fd = open(response.getBodyFile().c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            std::cerr << "cannot open " << response.getBodyFile() << " : " << strerror(errno) << std::endl;
+            buildErrorResponse(500);
+            return ;
         }
+        _out.pushText(head);
+        _out.pushFile(fd, 0, response.getBodyFileSize());
+        _queued++;
     }
-    return str_rep;
-}
\ No newline at end of file
+    else
+    {
+        std::vector<char>   body;
+
+        response.releaseBody(body);
+        _out.pushText(head);
+        _out.pushBytes(body);
+        _queued++;
+    }
+}
+
+//envoie ce qui peut partir : FLUSH_DONE, FLUSH_AGAIN (socket plein) ou FLUSH_ERROR
+int     Connection::flushResponse(void) {
+    int res = _out.flush(getSocketFD());
+
+    if (res == FLUSH_DONE)
+        _queued = 0;
+    return (res);
+}
+
+//file videe : sert les requetes pipelinees restees dans le parser.
+//renvoie true si de nouvelles reponses attendent d'etre envoyees
+bool    Connection::resumePipeline(void) {
+    if (_closeAfterFlush || !_parser.hasBufferedData())
+        return (false);
+    processRequests();
+    return (!_out.empty());
+}
+
+//file pleine : plus de lecture, sinon un client qui envoie sans lire ses reponses
+//ferait grossir le tampon du parser sans limite (les limites d'en-tete ne sont vues qu'au parse)
+bool    Connection::isPipelinePaused(void) const {
+    return (!_closeAfterFlush && _queued >= PIPELINE_MAX_RESPONSES);
+}
+
+bool    Connection::hasPendingResponse(void) const {
+    return (!_out.empty());
+}
+
+bool    Connection::shouldClose(void) const {
+    return (_closeAfterFlush || _peerClosed);
+}
+
+//le client a ferme son cote ecriture : les requetes deja recues sont servies, puis on ferme
+void    Connection::setPeerClosed(void) {
+    _peerClosed = true;
+}
+
+//reponse de refus envoyee : a fermer en douceur plutot que d'un coup
+bool    Connection::shouldLinger(void) const {
+    return (_closeAfterFlush && _linger && !_lingerDeadline);
+}
+
+void    Connection::startLingering(unsigned long deadline) {
+    _lingerDeadline = deadline;
+}
+
+bool    Connection::isLingering(void) const {
+    return (_lingerDeadline != 0);
+}
+
+unsigned long   Connection::getLingerDeadline(void) const {
+    return (_lingerDeadline);
+}
+
+//drain : la reponse en cours de construction et les suivantes partent avec "Connection: close"
+void    Connection::disableKeepAlive(void) {
+    _noKeepAlive = true;
+}
+
+int     Connection::getInterest(void) const {
+    return (_interest);
+}
+
+void    Connection::setInterest(int events) {
+    _interest = events;
+}
+
+//phase courante, pour choisir le delai surveille par le timer
+int     Connection::getPhase(void) const {
+    if (_lingerDeadline)
+        return (CONN_LINGERING);
+    if (!_out.empty())
+        return (CONN_WRITING);
+    if (_parser.getRequest().currentState == HttpRequest::RECV_BODY)
+        return (CONN_BODY);
+    if (_requests == 0 || _parser.hasBufferedData()
+        || _parser.getRequest().currentState == HttpRequest::RECV_HEADERS)
+        return (CONN_HEADERS);
+    return (CONN_KEEPALIVE);
+}
+
+TimerNode*  Connection::getTimer(void) {
+    return (&_timer);
+}
+
+int     Connection::getTimerPhase(void) const {
+    return (_timerPhase);
+}
+
+void    Connection::setTimerPhase(int phase) {
+    _timerPhase = phase;
+}
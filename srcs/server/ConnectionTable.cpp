@@ -0,0 +1,99 @@
+#include "../../includes/server/ConnectionTable.hpp"
+#include <new>
+
+ConnectionTable::ConnectionTable() : _live(0) {
+}
+
+//les connexions doivent deja etre detruites (Server::~Server) : on ne rend que la memoire
+ConnectionTable::~ConnectionTable() {
+	for (size_t i = 0; i < _slabs.size(); i++)
+		::operator delete(_slabs[i]);
+}
+
+uint64_t	ConnectionTable::makeToken(int fd, uint32_t gen) {
+	return ((static_cast<uint64_t>(gen) << 32) | static_cast<uint32_t>(fd));
+}
+
+int		ConnectionTable::tokenFd(uint64_t token) {
+	return (static_cast<int>(token & 0xffffffffUL));
+}
+
+uint32_t	ConnectionTable::tokenGen(uint64_t token) {
+	return (static_cast<uint32_t>(token >> 32));
+}
+
+//range le socket dans la case de son fd, renvoie le jeton a donner a la boucle
+//counted false : fd interne (self-pipe), ni listener ni client
+uint64_t	ConnectionTable::attach(int fd, Socket* sock, bool counted) {
+	if ((size_t)fd >= _slots.size())
+		_slots.resize((size_t)fd + 1 > 2 * _slots.size() ? (size_t)fd + 1 : 2 * _slots.size());
+	_slots[fd].sock = sock;
+	_slots[fd].counted = counted && !sock->isListener();
+	if (_slots[fd].counted)
+		_live++;
+	return (makeToken(fd, _slots[fd].gen));
+}
+
+//libere la case : la generation change, les jetons deja distribues deviennent perimes
+void	ConnectionTable::detach(int fd) {
+	if (fd < 0 || (size_t)fd >= _slots.size() || !_slots[fd].sock)
+		return ;
+	if (_slots[fd].counted)
+		_live--;
+	_slots[fd].sock = NULL;
+	_slots[fd].gen++;
+}
+
+//un seul acces tableau par evenement ; NULL si la case a change depuis l'enregistrement
+Socket*	ConnectionTable::lookup(uint64_t token) const {
+	int	fd = tokenFd(token);
+
+	if (fd < 0 || (size_t)fd >= _slots.size())
+		return (NULL);
+	const ConnSlot&	slot = _slots[fd];
+	if (slot.gen != tokenGen(token))
+		return (NULL);
+	return (slot.sock);
+}
+
+Socket*	ConnectionTable::get(int fd) const {
+	if (fd < 0 || (size_t)fd >= _slots.size())
+		return (NULL);
+	return (_slots[fd].sock);
+}
+
+//jeton courant du fd (pour modify sur la boucle)
+uint64_t	ConnectionTable::tokenOf(int fd) const {
+	return (makeToken(fd, _slots[fd].gen));
+}
+
+size_t	ConnectionTable::capacity(void) const {
+	return (_slots.size());
+}
+
+size_t	ConnectionTable::liveConnections(void) const {
+	return (_live);
+}
+
+//un bloc brut de CONN_SLAB_SIZE connexions, decoupe dans la liste libre
+void	ConnectionTable::growSlab(void) {
+	char*	block = static_cast<char*>(::operator new(sizeof(Connection) * CONN_SLAB_SIZE));
+
+	_slabs.push_back(block);
+	for (size_t i = CONN_SLAB_SIZE; i > 0; i--)
+		_freeConns.push_back(reinterpret_cast<Connection*>(block + (i - 1) * sizeof(Connection)));
+}
+
+//plus de new Connection() par accept : placement new dans un emplacement libre du slab
+Connection*	ConnectionTable::createConnection(void) {
+	if (_freeConns.empty())
+		growSlab();
+	Connection*	mem = _freeConns.back();
+	_freeConns.pop_back();
+	return (new (mem) Connection());
+}
+
+void	ConnectionTable::destroyConnection(Connection* conn) {
+	conn->~Connection();
+	_freeConns.push_back(conn);
+}
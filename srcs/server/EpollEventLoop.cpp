@@ -0,0 +1,83 @@
+#include "../../includes/server/EventLoop.hpp"
+
+#ifdef __linux__
+
+# include <sys/epoll.h>
+# include <unistd.h>
+
+EpollEventLoop::EpollEventLoop() {
+	if ((_epfd = epoll_create1(EPOLL_CLOEXEC)) < 0)
+		throw ("error with epoll_create");
+}
+
+EpollEventLoop::~EpollEventLoop() {
+	close(_epfd);
+}
+
+//traduit nos flags vers ceux d'epoll
+static uint32_t	toEpollEvents(int events) {
+	uint32_t	ev = 0;
+
+	if (events & EV_READ)
+		ev |= EPOLLIN | EPOLLRDHUP;
+	if (events & EV_WRITE)
+		ev |= EPOLLOUT;
+	if (events & EV_EDGE)
+		ev |= EPOLLET;
+	return (ev);
+}
+
+bool	EpollEventLoop::add(int fd, int events, uint64_t data) {
+	struct epoll_event	ev;
+
+	ev.events = toEpollEvents(events);
+	ev.data.u64 = data;
+	return (epoll_ctl(_epfd, EPOLL_CTL_ADD, fd, &ev) == 0);
+}
+
+bool	EpollEventLoop::modify(int fd, int events, uint64_t data) {
+	struct epoll_event	ev;
+
+	ev.events = toEpollEvents(events);
+	ev.data.u64 = data;
+	return (epoll_ctl(_epfd, EPOLL_CTL_MOD, fd, &ev) == 0);
+}
+
+void	EpollEventLoop::remove(int fd) {
+	struct epoll_event	ev;	// ignore mais requis avant 2.6.9
+
+	epoll_ctl(_epfd, EPOLL_CTL_DEL, fd, &ev);
+}
+
+//le noyau ne rend que les fds prets : plus de scan sur les connexions idle
+int	EpollEventLoop::wait(std::vector<IoEvent>& out, int timeoutMs) {
+	struct epoll_event	ready[MAXEPOLLEVENTS];
+	int					n;
+
+	out.clear();
+	if ((n = epoll_wait(_epfd, ready, MAXEPOLLEVENTS, timeoutMs)) <= 0)
+		return (n);
+	for (int i = 0; i < n; i++)
+	{
+		IoEvent	ev;
+		ev.fd = -1;
+		ev.events = 0;
+		ev.data = ready[i].data.u64;
+		if (ready[i].events & EPOLLIN)
+			ev.events |= EV_READ;
+		if (ready[i].events & EPOLLOUT)
+			ev.events |= EV_WRITE;
+		if (ready[i].events & (EPOLLHUP | EPOLLRDHUP))
+			ev.events |= EV_HUP;
+		if (ready[i].events & EPOLLERR)
+			ev.events |= EV_ERROR;
+		out.push_back(ev);
+	}
+	return (n);
+}
+
+const char*	EpollEventLoop::name(void) const {
+	return ("epoll");
+}
+
+#endif
@@ -0,0 +1,16 @@
+#include "../../includes/server/EventLoop.hpp"
+#include <iostream>
+
+EventLoop::~EventLoop() {
+}
+
+//choix du backend, pour pouvoir bench l'un contre l'autre
+EventLoop*	EventLoop::create(const std::string& backend) {
+#ifdef __linux__
+	if (backend.empty() || backend == "epoll")
+		return (new EpollEventLoop());
+#endif
+	if (backend != "poll" && backend != "epoll")
+		std::cerr << "unknown event backend '" << backend << "', using poll" << std::endl;
+	return (new PollEventLoop());
+}
@@ -0,0 +1,316 @@
+#include "../../includes/server/Lifecycle.hpp"
+#include "../../includes/utils/StringUtils.hpp"
+#include <map>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <climits>
+#include <iostream>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+
+extern char**	environ;
+
+struct WakeSlot {
+	volatile int	wfd;	// lu par le handler : -1 = case libre
+	int				rfd;
+};
+
+static volatile sig_atomic_t	g_lifecycle = 0;
+static WakeSlot					g_wakeups[LC_MAX_WAKEUPS];
+static volatile int				g_nbWakeups = 0;
+static pthread_mutex_t			g_wakeLock = PTHREAD_MUTEX_INITIALIZER;
+static std::vector<std::string>	g_args;
+static std::string				g_exePath;
+static std::map<int, int>		g_inherited;	// port -> fd recu de l'ancien binaire
+static bool						g_inheritedParsed = false;
+
+//async-signal-safe : write() seulement ; pipe plein = reveil deja en attente
+static void	wakeAll(void) {
+	char	c = 1;
+	int		n = g_nbWakeups;
+
+	for (int i = 0; i < n; i++)
+		if (g_wakeups[i].wfd >= 0 && write(g_wakeups[i].wfd, &c, 1) < 0)
+			(void)0;
+}
+
+static void	lifecycleHandler(int sig) {
+	int		saved = errno;
+
+	if (sig == SIGUSR2)
+		g_lifecycle |= LC_UPGRADE;
+	else if (sig == SIGHUP)
+		g_lifecycle |= LC_RELOAD;
+	else
+		g_lifecycle |= LC_DRAIN;
+	wakeAll();
+	errno = saved;
+}
+
+//chemin du binaire retenu au lancement : apres un deploiement, c'est le nouveau fichier a ce chemin
+//qui sera execute (et pas /proc/self/exe, qui designe l'ancien)
+void	saveProgramArgs(int argc, char** argv) {
+	char	resolved[PATH_MAX];
+
+	g_args.clear();
+	for (int i = 0; i < argc; i++)
+		g_args.push_back(argv[i]);
+	if (argc > 0 && realpath(argv[0], resolved))
+		g_exePath = resolved;
+	else if (argc > 0)
+		g_exePath = argv[0];
+}
+
+static bool	setCloexecNonBlock(int fd) {
+	int	flags = fcntl(fd, F_GETFL, 0);
+
+	return (flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) >= 0
+		&& fcntl(fd, F_SETFD, FD_CLOEXEC) >= 0);
+}
+
+//canUpgrade false : worker d'un master, c'est le master qui remplace le binaire
+void	installLifecycleSignals(bool canUpgrade) {
+	struct sigaction	sa;
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = lifecycleHandler;
+	sa.sa_flags = SA_RESTART;
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGQUIT, &sa, NULL);
+	sigaction(SIGHUP, &sa, NULL);
+	if (canUpgrade)
+		sigaction(SIGUSR2, &sa, NULL);
+	else
+		signal(SIGUSR2, SIG_IGN);
+}
+
+//un pipe par Server : chaque boucle est sure d'etre reveillee, meme endormie dans wait(-1).
+//La case est remplie avant d'etre publiee (g_nbWakeups) : le handler ne voit jamais une case a moitie faite
+int		registerLifecycleWakeup(void) {
+	int	fds[2];
+	int	slot = -1;
+
+	if (pipe(fds) < 0)
+		return (-1);
+	if (!setCloexecNonBlock(fds[0]) || !setCloexecNonBlock(fds[1]))
+	{
+		close(fds[0]);
+		close(fds[1]);
+		return (-1);
+	}
+	pthread_mutex_lock(&g_wakeLock);
+	for (int i = 0; i < g_nbWakeups && slot < 0; i++)
+		if (g_wakeups[i].wfd < 0)
+			slot = i;
+	if (slot < 0 && g_nbWakeups < LC_MAX_WAKEUPS)
+		slot = g_nbWakeups;
+	if (slot >= 0)
+	{
+		g_wakeups[slot].rfd = fds[0];
+		g_wakeups[slot].wfd = fds[1];
+		if (slot == g_nbWakeups)
+			g_nbWakeups = slot + 1;
+	}
+	pthread_mutex_unlock(&g_wakeLock);
+	if (slot < 0)
+	{
+		close(fds[0]);
+		close(fds[1]);
+		return (-1);
+	}
+	return (fds[0]);
+}
+
+void	unregisterLifecycleWakeup(int readFd) {
+	if (readFd < 0)
+		return ;
+	pthread_mutex_lock(&g_wakeLock);
+	for (int i = 0; i < g_nbWakeups; i++)
+	{
+		if (g_wakeups[i].wfd >= 0 && g_wakeups[i].rfd == readFd)
+		{
+			int	wfd = g_wakeups[i].wfd;
+
+			g_wakeups[i].wfd = -1;
+			close(wfd);
+			break ;
+		}
+	}
+	pthread_mutex_unlock(&g_wakeLock);
+	close(readFd);
+}
+
+//vide le pipe : l'etat est dans les drapeaux, les octets ne servent qu'a reveiller
+void	consumeLifecycleWakeup(int readFd) {
+	char	buf[64];
+
+	while (read(readFd, buf, sizeof(buf)) > 0)
+		;
+}
+
+int		pendingLifecycle(void) {
+	return (g_lifecycle);
+}
+
+//un seul reacteur du process lance le nouveau binaire, meme si tous ont vu le signal
+bool	claimUpgrade(void) {
+	static pthread_mutex_t	lock = PTHREAD_MUTEX_INITIALIZER;
+	bool					mine = false;
+
+	pthread_mutex_lock(&lock);
+	if (g_lifecycle & LC_UPGRADE)
+	{
+		g_lifecycle &= ~LC_UPGRADE;
+		mine = true;
+	}
+	pthread_mutex_unlock(&lock);
+	return (mine);
+}
+
+//un seul reacteur relit le fichier ; les autres adoptent la snapshot publiee
+bool	claimReload(void) {
+	static pthread_mutex_t	lock = PTHREAD_MUTEX_INITIALIZER;
+	bool					mine = false;
+
+	pthread_mutex_lock(&lock);
+	if (g_lifecycle & LC_RELOAD)
+	{
+		g_lifecycle &= ~LC_RELOAD;
+		mine = true;
+	}
+	pthread_mutex_unlock(&lock);
+	return (mine);
+}
+
+//nouveau binaire lance : tous les reacteurs du process arretent d'accepter et se vident
+void	requestDrain(void) {
+	g_lifecycle |= LC_DRAIN;
+	wakeAll();
+}
+
+//nouvelle config publiee : chaque boucle vient la chercher
+void	wakeLifecycleLoops(void) {
+	wakeAll();
+}
+
+//listeners = (port, fd). Tout ce qui alloue est fait avant le fork : le fils d'un process
+//multi-thread ne doit appeler que des fonctions async-signal-safe avant exec.
+//Un pipe CLOEXEC dit au pere si l'exec a reussi (EOF) ou pas (errno du fils)
+pid_t	execNewBinary(const std::vector<std::pair<int, int> >& listeners) {
+	std::string					envVar = std::string(LISTEN_FDS_ENV) + "=";
+	std::vector<char*>			argv;
+	std::vector<char*>			envp;
+	std::vector<std::string>	keep;
+	int							status[2];
+	int							childErr = 0;
+
+	if (g_exePath.empty())
+		return (-1);
+	for (size_t i = 0; i < listeners.size(); i++)
+		envVar += StringUtils::longToString(listeners[i].first) + ":"
+			+ StringUtils::longToString(listeners[i].second) + ";";
+	for (size_t i = 0; i < g_args.size(); i++)
+		argv.push_back(const_cast<char*>(g_args[i].c_str()));
+	argv.push_back(NULL);
+	for (char** e = environ; e && *e; e++)
+		if (strncmp(*e, LISTEN_FDS_ENV "=", sizeof(LISTEN_FDS_ENV)) != 0)
+			envp.push_back(*e);
+	envp.push_back(const_cast<char*>(envVar.c_str()));
+	envp.push_back(NULL);
+	if (pipe(status) < 0)
+		return (-1);
+	fcntl(status[1], F_SETFD, FD_CLOEXEC);
+
+	pid_t	pid = fork();
+	if (pid < 0)
+	{
+		close(status[0]);
+		close(status[1]);
+		return (-1);
+	}
+	if (pid == 0)
+	{
+		sigset_t	none;
+		int			err;
+
+		close(status[0]);
+		sigemptyset(&none);
+		pthread_sigmask(SIG_SETMASK, &none, NULL);
+		for (size_t i = 0; i < listeners.size(); i++)
+			fcntl(listeners[i].second, F_SETFD, 0);//le seul heritage voulu : les sockets d'ecoute
+		execve(g_exePath.c_str(), &argv[0], &envp[0]);
+		err = errno;
+		if (write(status[1], &err, sizeof(err)) < 0)
+			(void)0;
+		_exit(127);
+	}
+	close(status[1]);
+	while (read(status[0], &childErr, sizeof(childErr)) < 0 && errno == EINTR)
+		;
+	close(status[0]);
+	if (childErr)
+	{
+		std::cerr << "upgrade: cannot exec " << g_exePath << ": " << strerror(childErr) << std::endl;
+		return (-1);
+	}
+	std::cout << "- upgrade: new binary started (pid " << pid << ")" << std::endl;
+	return (pid);
+}
+
+//lu une seule fois puis retire de l'environnement : ni les CGI ni un prochain upgrade n'en heritent
+static void	parseInherited(void) {
+	const char*	env;
+
+	if (g_inheritedParsed)
+		return ;
+	g_inheritedParsed = true;
+	if (!(env = getenv(LISTEN_FDS_ENV)))
+		return ;
+	std::string	list(env);
+	size_t		start = 0;
+
+	while (start < list.size())
+	{
+		size_t	end = list.find(';', start);
+		size_t	colon = list.find(':', start);
+
+		if (end == std::string::npos)
+			end = list.size();
+		if (colon != std::string::npos && colon < end)
+		{
+			int	port = std::atoi(list.substr(start, colon - start).c_str());
+			int	fd = std::atoi(list.substr(colon + 1, end - colon - 1).c_str());
+
+			if (port > 0 && fd > 2 && fcntl(fd, F_GETFD) >= 0)
+				g_inherited[port] = fd;
+		}
+		start = end + 1;
+	}
+	unsetenv(LISTEN_FDS_ENV);
+}
+
+//fd d'ecoute deja lie sur ce port par l'ancien binaire, -1 sinon ; il n'est rendu qu'une fois
+int		inheritedListenFd(int port) {
+	parseInherited();
+	std::map<int, int>::iterator	it = g_inherited.find(port);
+
+	if (it == g_inherited.end())
+		return (-1);
+	int	fd = it->second;
+	g_inherited.erase(it);
+	return (fd);
+}
+
+//ports herites que la nouvelle config n'ecoute plus : sinon le noyau y empilerait des clients
+void	closeInheritedListeners(void) {
+	parseInherited();
+	for (std::map<int, int>::iterator it = g_inherited.begin(); it != g_inherited.end(); ++it)
+	{
+		std::cout << "- upgrade: closing inherited listener on port " << it->first << std::endl;
+		close(it->second);
+	}
+	g_inherited.clear();
+}
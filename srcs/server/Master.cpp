@@ -0,0 +1,195 @@
+#include "../../includes/server/Master.hpp"
+#include <csignal>
+#include <sys/wait.h>
+#ifdef __linux__
+# include <sys/prctl.h>
+#endif
+
+static volatile sig_atomic_t	g_stop = 0;
+static volatile sig_atomic_t	g_upgrade = 0;
+static volatile sig_atomic_t	g_drain = 0;
+static volatile sig_atomic_t	g_reload = 0;
+
+static void	stopHandler(int sig) {
+	if (sig == SIGUSR2)
+		g_upgrade = 1;
+	else if (sig == SIGQUIT)
+		g_drain = 1;
+	else if (sig == SIGHUP)
+		g_reload = 1;
+	else
+		g_stop = 1;
+}
+
+//worker_processes auto (0) : un worker par cpu en ligne
+Master::Master(GlobalConfig* config, const std::string& backend)
+    : _config(config), _backend(backend), _nbWorkers(config->workerProcesses) {
+    if (_nbWorkers <= 0)
+    {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        _nbWorkers = (n > 0) ? static_cast<int>(n) : 1;
+    }
+    _lastSpawn.resize(_nbWorkers, 0);
+}
+
+Master::~Master() {
+}
+
+//fork d'un worker : il construit son propre Server (sockets SO_REUSEPORT, boucle d'evenements)
+//et ne revient jamais ici
+pid_t   Master::spawnWorker(int slot) {
+    time_t  now = time(NULL);
+
+    if (_lastSpawn[slot] && now - _lastSpawn[slot] < RESPAWN_DELAY)
+        sleep(RESPAWN_DELAY);//mort juste apres son lancement : on ne boucle pas sur fork
+    _lastSpawn[slot] = time(NULL);
+
+    pid_t   pid = fork();
+    if (pid < 0)
+    {
+        std::cerr << "fork failed for worker " << slot << ": " << strerror(errno) << std::endl;
+        return (-1);
+    }
+    if (pid == 0)
+    {
+        signal(SIGTERM, SIG_DFL);
+        signal(SIGINT, SIG_DFL);
+        installLifecycleSignals(false);//SIGQUIT du master : drain ; l'upgrade, c'est le master
+#ifdef __linux__
+        prctl(PR_SET_PDEATHSIG, SIGTERM);//master tue : les workers suivent
+#endif
+        int status = 0;
+        try {
+            if (_config->workerThreads != 1)
+            {//les deux modes se combinent : N process x M reacteurs
+                ReactorPool pool(_config, _backend);
+                pool.run();
+            }
+            else
+            {
+                Server  server(_config, _backend, true);
+                server.run();
+            }
+        }
+        catch (const char* e) {
+            std::cerr << "worker " << slot << ": " << e << std::endl;
+            status = 1;
+        }
+        catch (std::exception& e) {
+            std::cerr << "worker " << slot << ": " << e.what() << std::endl;
+            status = 1;
+        }
+        std::cout.flush();
+        _exit(status);
+    }
+    _workers[pid] = slot;
+    std::cout << "- worker " << slot << " started (pid " << pid << ")" << std::endl;
+    return (pid);
+}
+
+void    Master::stopWorkers(void) {
+    std::map<pid_t, int>::iterator  it;
+
+    for (it = _workers.begin(); it != _workers.end(); ++it)
+        kill(it->first, SIGTERM);
+    while (!_workers.empty())
+    {
+        pid_t   pid = waitpid(-1, NULL, 0);
+        if (pid < 0 && errno != EINTR)
+            break ;
+        if (pid > 0)
+            _workers.erase(pid);
+    }
+}
+
+//arret propre : chaque worker ferme ses listeners et finit ses connexions avant de sortir.
+//Un SIGTERM/SIGINT pendant l'attente coupe court
+void    Master::drainWorkers(void) {
+    std::map<pid_t, int>::iterator  it;
+
+    for (it = _workers.begin(); it != _workers.end(); ++it)
+        kill(it->first, SIGQUIT);
+    while (!_workers.empty())
+    {
+        pid_t   pid = waitpid(-1, NULL, 0);
+
+        if (pid < 0 && errno == EINTR && g_stop)
+        {
+            stopWorkers();
+            return ;
+        }
+        if (pid < 0 && errno != EINTR)
+            break ;
+        if (pid > 0)
+            _workers.erase(pid);
+    }
+}
+
+//boucle du master : waitpid bloquant, relance du worker si il meurt hors arret demande
+void    Master::run(void) {
+    struct sigaction    sa;
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = stopHandler;//pas de SA_RESTART : waitpid doit rendre la main
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGTERM, &sa, NULL);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGQUIT, &sa, NULL);
+    sigaction(SIGUSR2, &sa, NULL);
+    sigaction(SIGHUP, &sa, NULL);
+
+    std::cout << "- master " << getpid() << " : " << _nbWorkers << " workers" << std::endl;
+    for (int i = 0; i < _nbWorkers; i++)
+        spawnWorker(i);
+    while (!g_stop)
+    {
+        if (g_upgrade)
+        {//le nouveau master ouvre ses propres workers SO_REUSEPORT : aucun fd a transmettre
+            g_upgrade = 0;
+            if (execNewBinary(std::vector<std::pair<int, int> >()) > 0)
+                g_drain = 1;
+        }
+        if (g_reload)
+        {//chaque worker relit la config de son cote ; le master la garde pour ceux qu'il relancera
+            g_reload = 0;
+            if (reloadConfig())
+                for (std::map<pid_t, int>::iterator it = _workers.begin(); it != _workers.end(); ++it)
+                    kill(it->first, SIGHUP);
+        }
+        if (g_drain)
+        {
+            std::cout << "- master draining workers" << std::endl;
+            drainWorkers();
+            return ;
+        }
+        int     status;
+        pid_t   pid = waitpid(-1, &status, 0);
+
+        if (pid < 0)
+        {
+            if (errno == EINTR)
+                continue ;
+            throw ("error with waitpid");
+        }
+        std::map<pid_t, int>::iterator  it = _workers.find(pid);
+        if (it == _workers.end())
+            continue ;
+        int slot = it->second;
+        _workers.erase(it);
+        if (g_stop)
+            break ;
+        if (g_drain)
+            continue ;//mort pendant la demande d'arret : pas de relance
+        if (WIFSIGNALED(status))
+            std::cerr << "worker " << slot << " (pid " << pid << ") killed by signal " << WTERMSIG(status) << std::endl;
+        else
+            std::cerr << "worker " << slot << " (pid " << pid << ") exited with status " << WEXITSTATUS(status) << std::endl;
+        spawnWorker(slot);
+    }
+    std::cout << "- master stopping workers" << std::endl;
+    stopWorkers();
+}
+
+int     Master::getNbWorkers(void) const {
+    return (_nbWorkers);
+}
@@ -0,0 +1,159 @@
+#include "../../includes/server/OutputQueue.hpp"
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <sys/socket.h>
+#ifdef __linux__
+# include <sys/sendfile.h>
+#endif
+
+OutputQueue::OutputQueue() : _cursor(0), _pending(0) {
+}
+
+OutputQueue::~OutputQueue() {
+	clear();
+}
+
+//les push reprennent le contenu par swap : pas de copie de la reponse
+void	OutputQueue::pushText(std::string& text) {
+	if (text.empty())
+		return ;
+	_segs.push_back(OutSegment());
+	_segs.back().text.swap(text);
+	_segs.back().length = _segs.back().text.size();
+	_pending += _segs.back().length;
+}
+
+void	OutputQueue::pushBytes(std::vector<char>& bytes) {
+	if (bytes.empty())
+		return ;
+	_segs.push_back(OutSegment());
+	_segs.back().bytes.swap(bytes);
+	_segs.back().length = _segs.back().bytes.size();
+	_pending += _segs.back().length;
+}
+
+//le fd appartient desormais a la file : ferme quand la plage est partie (ou au clear)
+void	OutputQueue::pushFile(int fd, off_t offset, size_t length) {
+	if (length == 0)
+	{
+		close(fd);
+		return ;
+	}
+	_segs.push_back(OutSegment());
+	_segs.back().fd = fd;
+	_segs.back().offset = offset;
+	_segs.back().length = length;
+	_pending += length;
+}
+
+void	OutputQueue::popFront(void) {
+	if (_segs.front().fd >= 0)
+		close(_segs.front().fd);
+	_segs.pop_front();
+	_cursor = 0;
+}
+
+//avance le curseur de n octets ecrits, en retirant les segments finis
+void	OutputQueue::advance(size_t n) {
+	_pending -= n;
+	while (n > 0 && !_segs.empty())
+	{
+		size_t	left = _segs.front().length - _cursor;
+
+		if (n < left)
+		{
+			_cursor += n;
+			return ;
+		}
+		n -= left;
+		popFront();
+	}
+}
+
+//plage de fichier : sendfile sous Linux (noyau -> socket sans passer par nous),
+//sinon pread dans un tampon puis send
+ssize_t	OutputQueue::sendFileRange(int sockfd, OutSegment& seg) {
+	off_t	off = seg.offset + _cursor;
+	size_t	left = seg.length - _cursor;
+
+#ifdef __linux__
+	return (sendfile(sockfd, seg.fd, &off, left));
+#else
+	char	buf[65536];
+	ssize_t	n;
+
+	if (left > sizeof(buf))
+		left = sizeof(buf);
+	if ((n = pread(seg.fd, buf, left, off)) <= 0)
+		return (n);
+	return (send(sockfd, buf, n, 0));
+#endif
+}
+
+//envoie le plus possible : un seul sendmsg (iovec) sur les segments memoire consecutifs,
+//sendfile sur les fichiers. Des en-tetes suivis d'une plage de fichier partent avec MSG_MORE :
+//sinon Nagle retient le petit corps envoye juste apres jusqu'a l'ACK differe du client (40ms).
+//s'arrete sur EAGAIN, le reste repartira au prochain EV_WRITE
+int		OutputQueue::flush(int sockfd) {
+	while (!_segs.empty())
+	{
+		ssize_t	n;
+
+		if (_segs.front().fd >= 0)
+			n = sendFileRange(sockfd, _segs.front());
+		else
+		{
+			struct iovec					iov[OUTQ_IOV_MAX];
+			struct msghdr					msg;
+			int								cnt = 0;
+			int								flags = 0;
+			std::deque<OutSegment>::iterator	it = _segs.begin();
+
+			for (; it != _segs.end() && it->fd < 0 && cnt < OUTQ_IOV_MAX; ++it)
+			{
+				const char*	data = it->text.empty() ? &it->bytes[0] : it->text.data();
+				size_t		skip = (cnt == 0) ? _cursor : 0;
+
+				iov[cnt].iov_base = const_cast<char*>(data) + skip;
+				iov[cnt].iov_len = it->length - skip;
+				cnt++;
+			}
+#ifdef MSG_MORE
+			if (it != _segs.end() && it->fd >= 0)
+				flags = MSG_MORE;
+#endif
+			memset(&msg, 0, sizeof(msg));
+			msg.msg_iov = iov;
+			msg.msg_iovlen = cnt;
+			n = sendmsg(sockfd, &msg, flags);
+		}
+		if (n < 0)
+		{
+			if (errno == EINTR)
+				continue ;
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				return (FLUSH_AGAIN);
+			return (FLUSH_ERROR);
+		}
+		if (n == 0)
+			return (FLUSH_ERROR);//fichier tronque entre-temps : on ne finira jamais la plage
+		advance(n);
+	}
+	return (FLUSH_DONE);
+}
+
+void	OutputQueue::clear(void) {
+	while (!_segs.empty())
+		popFront();
+	_pending = 0;
+}
+
+bool	OutputQueue::empty(void) const {
+	return (_segs.empty());
+}
+
+size_t	OutputQueue::pending(void) const {
+	return (_pending);
+}
@@ -0,0 +1,98 @@
+#include "../../includes/server/EventLoop.hpp"
+
+PollEventLoop::PollEventLoop() {
+}
+
+PollEventLoop::~PollEventLoop() {
+}
+
+//traduit nos flags vers ceux de poll (pas de mode edge ici : on reste en level)
+static short	toPollEvents(int events) {
+	short	ev = 0;
+
+	if (events & EV_READ)
+		ev |= POLLIN;
+	if (events & EV_WRITE)
+		ev |= POLLOUT;
+	return (ev);
+}
+
+bool	PollEventLoop::add(int fd, int events, uint64_t data) {
+	struct pollfd	p;
+
+	if (fd < 0)
+		return (false);
+	if ((size_t)fd >= _index.size())
+		_index.resize(fd + 1, -1);
+	if (_index[fd] != -1)
+		return (modify(fd, events, data));
+	p.fd = fd;
+	p.events = toPollEvents(events);
+	p.revents = 0;
+	_index[fd] = _pfds.size();
+	_pfds.push_back(p);
+	_data.push_back(data);
+	return (true);
+}
+
+bool	PollEventLoop::modify(int fd, int events, uint64_t data) {
+	if (fd < 0 || (size_t)fd >= _index.size() || _index[fd] == -1)
+		return (false);
+	_pfds[_index[fd]].events = toPollEvents(events);
+	_data[_index[fd]] = data;
+	return (true);
+}
+
+//retire le fd : le dernier prend sa place pour garder le tableau dense
+void	PollEventLoop::remove(int fd) {
+	if (fd < 0 || (size_t)fd >= _index.size() || _index[fd] == -1)
+		return ;
+	size_t	i = _index[fd];
+	size_t	last = _pfds.size() - 1;
+
+	if (i != last)
+	{
+		_pfds[i] = _pfds[last];
+		_data[i] = _data[last];
+		_index[_pfds[i].fd] = i;
+	}
+	_pfds.pop_back();
+	_data.pop_back();
+	_index[fd] = -1;
+}
+
+//poll sur tout le tableau puis scan lineaire : c'est le cout qu'epoll evite
+int	PollEventLoop::wait(std::vector<IoEvent>& out, int timeoutMs) {
+	int	n;
+
+	out.clear();
+	if (_pfds.empty() && timeoutMs < 0)
+		return (0);
+	if ((n = poll(_pfds.empty() ? NULL : &_pfds[0], _pfds.size(), timeoutMs)) <= 0)
+		return (n);
+	for (size_t i = 0; i < _pfds.size() && (int)out.size() < n; i++)
+	{
+		short	re = _pfds[i].revents;
+
+		if (re == 0)
+			continue ;
+		IoEvent	ev;
+		ev.fd = _pfds[i].fd;
+		ev.events = 0;
+		ev.data = _data[i];
+		if (re & POLLIN)
+			ev.events |= EV_READ;
+		if (re & POLLOUT)
+			ev.events |= EV_WRITE;
+		if (re & POLLHUP)
+			ev.events |= EV_HUP;
+		if (re & (POLLERR | POLLNVAL))
+			ev.events |= EV_ERROR;
+		out.push_back(ev);
+	}
+	return (out.size());
+}
+
+const char*	PollEventLoop::name(void) const {
+	return ("poll");
+}
@@ -0,0 +1,94 @@
+#include "../../includes/server/RateLimiter.hpp"
+
+RateLimiter::RateLimiter() : _entries(RATE_TABLE_SIZE), _evictions(0) {
+}
+
+RateLimiter::~RateLimiter() {
+}
+
+//FNV-1a du port et du chemin : stable d'un reload a l'autre tant que la location ne change pas
+uint32_t	RateLimiter::zoneId(int port, const std::string& path) {
+	uint32_t	h = 2166136261u;
+
+	for (int i = 0; i < 4; i++)
+	{
+		h ^= (port >> (8 * i)) & 0xff;
+		h *= 16777619u;
+	}
+	for (size_t i = 0; i < path.size(); i++)
+	{
+		h ^= static_cast<unsigned char>(path[i]);
+		h *= 16777619u;
+	}
+	return (h);
+}
+
+//cherche (ip, zone) dans sa fenetre de RATE_PROBE_LIMIT cases ; absent : case libre de la fenetre,
+//sinon une victime par seconde chance (les entrees servies recemment ont leur bit ref a 1)
+RateEntry*	RateLimiter::findOrEvict(uint32_t ip, uint32_t zone, bool& fresh) {
+	uint32_t	h = (ip * 2654435761u) ^ zone;
+	size_t		start = (h ^ (h >> RATE_TABLE_BITS)) & (RATE_TABLE_SIZE - 1);
+	RateEntry*	freeSlot = NULL;
+
+	fresh = false;
+	for (size_t i = 0; i < RATE_PROBE_LIMIT; i++)
+	{
+		RateEntry*	e = &_entries[(start + i) & (RATE_TABLE_SIZE - 1)];
+
+		if (e->used && e->ip == ip && e->zone == zone)
+			return (e);
+		if (!e->used && !freeSlot)
+			freeSlot = e;
+	}
+	fresh = true;
+	if (freeSlot)
+		return (freeSlot);
+	_evictions++;
+	for (size_t i = 0; i < RATE_PROBE_LIMIT; i++)
+	{
+		RateEntry*	e = &_entries[(start + i) & (RATE_TABLE_SIZE - 1)];
+
+		if (!e->ref)
+			return (e);
+		e->ref = 0;//seconde chance
+	}
+	return (&_entries[start]);//toutes servies recemment : la premiere, dont le bit vient d'etre efface
+}
+
+//0 : requete admise ; sinon delai en ms avant le prochain jeton (le client est au-dessus de sa limite).
+//Seau de burst + 1 jetons, rempli a rate jetons par seconde
+unsigned long	RateLimiter::check(uint32_t ip, uint32_t zone, int rate, int burst, unsigned long nowMs) {
+	long			capacity = (static_cast<long>(burst) + 1) * RATE_TOKEN;
+	unsigned long	wait = 0;
+	bool			fresh;
+
+	RateEntry*	e = findOrEvict(ip, zone, fresh);
+	if (fresh)
+	{
+		e->ip = ip;
+		e->zone = zone;
+		e->tokens = capacity;
+		e->lastMs = nowMs;
+		e->used = true;
+	}
+	else if (nowMs > e->lastMs)
+	{//rate jetons par seconde = rate millijetons par ms
+		unsigned long	refill = (nowMs - e->lastMs) * static_cast<unsigned long>(rate);
+
+		e->tokens = (refill >= static_cast<unsigned long>(capacity) || e->tokens + static_cast<long>(refill) > capacity)
+			? capacity : e->tokens + static_cast<long>(refill);
+		e->lastMs = nowMs;
+	}
+	if (e->tokens > capacity)
+		e->tokens = capacity;//limite baissee par un reload
+	e->ref = 1;
+	if (e->tokens >= RATE_TOKEN)
+		e->tokens -= RATE_TOKEN;
+	else
+		wait = (RATE_TOKEN - e->tokens + rate - 1) / rate;
+	return (wait);
+}
+
+unsigned long	RateLimiter::evictions(void) const {
+	return (_evictions);
+}
@@ -0,0 +1,57 @@
+#include "../../includes/server/ReactorPool.hpp"
+
+//worker_threads auto (0) : un reacteur par cpu en ligne
+ReactorPool::ReactorPool(GlobalConfig* config, const std::string& backend)
+    : _config(config), _backend(backend), _nbThreads(config->workerThreads) {
+    if (_nbThreads <= 0)
+    {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        _nbThreads = (n > 0) ? static_cast<int>(n) : 1;
+    }
+}
+
+ReactorPool::~ReactorPool() {
+}
+
+//corps d'un thread : le Server est construit ici pour que tout son etat soit local au thread
+void*   ReactorPool::reactorMain(void* arg) {
+    ReactorPool*    pool = static_cast<ReactorPool*>(arg);
+
+    try {
+        Server  server(pool->_config, pool->_backend, true);
+        server.run();
+    }
+    catch (const char* e) {
+        std::cerr << "reactor thread: " << e << std::endl;
+    }
+    catch (std::exception& e) {
+        std::cerr << "reactor thread: " << e.what() << std::endl;
+    }
+    return (NULL);
+}
+
+//lance les reacteurs puis attend leur fin : le thread principal ne sert aucune requete
+void    ReactorPool::run(void) {
+    std::cout << "- " << _nbThreads << " reactor threads" << std::endl;
+    for (int i = 0; i < _nbThreads; i++)
+    {
+        pthread_t   tid;
+        int         err;
+
+        if ((err = pthread_create(&tid, NULL, &ReactorPool::reactorMain, this)) != 0)
+        {
+            std::cerr << "pthread_create failed for reactor " << i << ": " << strerror(err) << std::endl;
+            continue ;
+        }
+        _threads.push_back(tid);
+    }
+    if (_threads.empty())
+        throw ("error with reactor threads");
+    for (size_t i = 0; i < _threads.size(); i++)
+        pthread_join(_threads[i], NULL);
+    _threads.clear();
+}
+
+int     ReactorPool::getNbThreads(void) const {
+    return (_nbThreads);
+}
@@ -1,210 +1,639 @@
 #include "../../includes/server/Server.hpp"
+#include "../../includes/utils/StringUtils.hpp"
+#include "../../includes/http/HttpDate.hpp"
 
-//constructeur des serveurs 
-Server::Server(GlobalConfig* config) {
-    this->_fd_n = 0;
-	this->_fd_max = MAXEVENTS;
-	_pfds = new pollfd[_fd_max];
-    _config = config;
-    int i = 0;//nb serv
-
-    for (std::vector<ServerConfig>::iterator it = servers.begin(); it != servers.end(); ++it) {
-        std::cout << "- launching a server on port " << (*it)->port;
-        std::cout << " at pfds[" << i << "]" << std::endl;
-        Socket* listenSock = new Socket;
-        listenSock->setPortFD((*it)->port);
-        listenSock->setServerBlock(*it);
-        _listenSockets.push_back(listenSock);
-      	_listenSockets.back()->initListenSocket((*it)->port.c_str());
-    	_pfds[i].fd = _listenSockets.back()->getSocketFD();
-	    _pfds[i].events = POLLIN | POLLOUT/* | POLLHUP*/;
-	    _fd_n++;
-        i++;
+//constructeur des serveurs : un socket d'ecoute par port, enregistre dans la boucle d'evenements
+//reusePort : mode workers, chaque process a ses propres sockets d'ecoute (SO_REUSEPORT).
+//La config vient de la snapshot publiee (main, SIGHUP) ; config ne sert que si rien n'est publie
+Server::Server(GlobalConfig* config, const std::string& backend, bool reusePort)
+    : _snapshot(NULL), _reusePort(reusePort), _draining(false),
+      _wakeFd(-1), _wakeSock(NULL), _wakeups(0), _wakeupsPerSec(0), _wakeupsSec(time(NULL)) {
+    if (!(_snapshot = acquireCurrentConfig()))
+    {
+        publishConfig(*config);
+        _snapshot = acquireCurrentConfig();
+    }
+    _config = &_snapshot->config;
+    _loop = EventLoop::create(backend);
+    std::cout << "- event backend : " << _loop->name() << std::endl;
+
+    syncListeners(true);
+    if ((_wakeFd = registerLifecycleWakeup()) >= 0)
+    {//SIGUSR2 / SIGQUIT / SIGHUP arrivent par ce pipe, comme n'importe quel evenement
+        _wakeSock = new Socket;
+        _wakeSock->setSocketFD(_wakeFd);
+        _loop->add(_wakeFd, EV_READ, _table.attach(_wakeFd, _wakeSock, false));
+    }
+}
+
+//un socket d'ecoute par port de la config courante : ouvre les ports nouveaux, ferme ceux qui
+//ont disparu, et rattache les autres a leur bloc server de la nouvelle snapshot (sans les rouvrir :
+//leur file d'attente est conservee). Au lancement une erreur est fatale, au reload elle est journalisee
+void    Server::syncListeners(bool initial) {
+    std::vector<Socket*>    kept;
+
+    for (std::vector<ServerConfig>::iterator it = _config->servers.begin(); it != _config->servers.end(); ++it) {
+        std::string port = StringUtils::longToString(it->port);
+        Socket*     listenSock = NULL;
+
+        for (size_t j = 0; j < kept.size() && !listenSock; j++)
+            if (kept[j]->getServerBlock()->port == it->port)
+                listenSock = kept[j];//meme port : c'est le dispatcher qui choisira via Host
+        if (listenSock)
+            continue ;
+        for (size_t j = 0; j < _listenSockets.size() && !listenSock; j++)
+        {
+            if (_listenSockets[j] && _listenSockets[j]->getServerBlock()->port == it->port)
+            {
+                listenSock = _listenSockets[j];
+                _listenSockets[j] = NULL;
+            }
+        }
+        if (listenSock)
+        {
+            listenSock->setServerBlock(&(*it));
+            kept.push_back(listenSock);
+            continue ;
+        }
+        std::cout << "- launching a server on port " << port << std::endl;
+        listenSock = new Socket;
+        listenSock->setPortFD(port);
+        listenSock->setServerBlock(&(*it));
+        try {
+            int inherited = _reusePort ? -1 : inheritedListenFd(it->port);
+            if (inherited >= 0)
+                listenSock->adoptListenSocket(inherited);//upgrade : le port n'a jamais cesse d'ecouter
+            else
+                listenSock->initListenSocket(port.c_str(), _reusePort);
+        } catch (const char* e) {
+            delete listenSock;
+            if (initial)
+                throw ;
+            std::cerr << "- reload: cannot listen on port " << port << ": " << e << std::endl;
+            continue ;
+        }
+        kept.push_back(listenSock);
+        //le listener a sa case dans la table comme les connexions : un seul chemin de lookup
+        _loop->add(listenSock->getSocketFD(), EV_READ, _table.attach(listenSock->getSocketFD(), listenSock));
         std::cout << std::endl;
     }
+    for (size_t j = 0; j < _listenSockets.size(); j++)
+    {
+        if (!_listenSockets[j])
+            continue ;
+        int fd = _listenSockets[j]->getSocketFD();
+
+        std::cout << "- closing listener on port " << _listenSockets[j]->getServerBlock()->port << std::endl;
+        _loop->remove(fd);
+        _table.detach(fd);
+        close(fd);
+        delete _listenSockets[j];
+    }
+    _listenSockets = kept;
 }
 
-    // for (std::vector<GlobalConfig*>::iterator it = _config->_server_blocks.begin(); it != _config->_server_blocks.end(); ++it) {
-    //     std::cout << "- launching a server on port " << (*it)->port;
-    //     std::cout << " at pfds[" << i << "]" << std::endl;
-    //     // Add a listening socket to the list
-    //     Socket* listenSock = new Socket;
-    //     listenSock->setPortFD((*it)->port);
-    //     // Add relevant serverblock to listening socket!
-    //     listenSock->setServerBlock(*it);
-    //     _listenSockets.push_back(listenSock);
-    //   	_listenSockets.back()->initListenSocket((*it)->port.c_str());
-    // 	_pfds[i].fd = _listenSockets.back()->getSocketFD();
-	//     _pfds[i].events = POLLIN | POLLOUT;
-	//     _fd_n++;
-    //     i++;
-    //     std::cout << std::endl;
-    // }// a faire a chat gpt
+//SIGHUP : le Server passe a la derniere snapshot publiee. Les connexions au repos suivent tout
+//de suite ; celles qui ont une requete en cours la finissent avec l'ancienne et changent ensuite
+void    Server::adoptConfig(void) {
+    ConfigSnapshot* snap = acquireCurrentConfig();
 
+    if (!snap || snap == _snapshot)
+    {
+        releaseConfig(snap);
+        return ;
+    }
+    ConfigSnapshot* old = _snapshot;
+    _snapshot = snap;
+    _config = &_snapshot->config;
+    syncListeners(false);
+    for (size_t fd = 0; fd < _table.capacity(); fd++)
+    {
+        Socket* sock = _table.get(fd);
+
+        if (!sock || sock->isListener() || sock == _wakeSock)
+            continue ;
+        Connection* conn = static_cast<Connection*>(sock);
+        if (conn->getPhase() == CONN_KEEPALIVE)
+            rebindConfig(conn);
+    }
+    releaseConfig(old);
+    std::cout << "- config generation " << _snapshot->generation << " active" << std::endl;
+}
+
+//connexion entre deux requetes sur une ancienne snapshot : meme port dans la nouvelle config,
+//sinon (port retire) on la ferme. Renvoie false si la connexion a ete fermee
+bool    Server::rebindConfig(Connection* conn) {
+    int     port = conn->getServerBlock()->port;
+
+    for (size_t i = 0; i < _listenSockets.size(); i++)
+    {
+        if (_listenSockets[i]->getServerBlock()->port == port)
+        {
+            retainConfig(_snapshot);
+            releaseConfig(conn->getSnapshot());
+            conn->setSnapshot(_snapshot, _listenSockets[i]->getServerBlock());
+            return (true);
+        }
+    }
+    closeConect(conn);
+    return (false);
+}
 
 //destructeur server(propre)
 Server::~Server() {
-    delete[] _pfds;
-    std::map<int, Connection*>::iterator it;
-    for (it = _connections.begin(); it != _connections.end(); ++it)
+    for (size_t fd = 0; fd < _table.capacity(); fd++)
+    {
+        Socket* sock = _table.get(fd);
+
+        if (!sock || sock->isListener() || sock == _wakeSock)
+            continue ;
+        Connection* conn = static_cast<Connection*>(sock);
+        _timers.cancel(conn->getTimer());//le noeud vit dans la connexion
+        conn->releaseRecvBuffers(_rxPool);
+        releaseConfig(conn->getSnapshot());
+        close(fd);
+        _table.detach(fd);
+        _table.destroyConnection(conn);
+    }
+    for (size_t i = 0; i < _listenSockets.size(); i++)
     {
-        //if (it->second)
-        delete it->second;
+        close(_listenSockets[i]->getSocketFD());
+        delete _listenSockets[i];
     }
+    unregisterLifecycleWakeup(_wakeFd);
+    delete _wakeSock;
+    delete _loop;
+    releaseConfig(_snapshot);
 }
 
-//boucle principale : poll surveille chaque fd pour gerer les flux dispo
-//sans attendre un temps indeterminé : pas besoin de thread
-//pour chaque fd le stock dans revents
+//boucle principale : le backend ne rend que les fds prets, chacun avec son jeton
+//(fd + generation) : un acces a la table par evenement, jeton perime = evenement ignore.
+//Ne rend la main qu'apres un drain (upgrade ou SIGQUIT), quand la derniere connexion est fermee
 void Server::run(void){
-    int nbPollOpen;
-    while (1)
+    int nbReady;
+    while (!_draining || _table.liveConnections() > 0)
     {
-        if ((nbPollOpen = poll(_pfds, _fd_n, -1)) < 0){
-            throw("Poll error...\n");
+        //au repos sans connexion : -1, on dort ; sinon reveil au prochain delai qui peut expirer
+        if ((nbReady = _loop->wait(_events, _timers.nextTimeoutMs(TimerWheel::nowMs()))) < 0){
+            if (errno == EINTR)
+                continue ;
+            throw("Event loop error...\n");
         }
-        for(int i = 0; i < _fd_n; i++)
+        countWakeup();
+        HttpDate::tick();//horloge du header Date de ce reacteur : reformatee au plus une fois par seconde
+        for(int i = 0; i < nbReady; i++)
         {
-            if (_pfds[i].revents & POLLHUP)
-                closeConect(i);
-            else if (_pfds[i].revents & POLLIN)
-            {//si trouve un socket d'ecoute, ca veux dire que c'est un debut d'ecoute
-                Socket* socket = checkListen(_pfds[i].fd);
-                if (socket != NULL)
-                {
-					makeNewConect(socket);
-                    break ;
-                }//else//si pas de socket trouve, ca veux dire que c'est en cours sans doute
-				readConect(i);
-            }//simplifiable fort
-            else if (_pfds[i].revents & POLLOUT)
-                manageRespond(i);
+            Socket* socket = _table.lookup(_events[i].data);
+            int     ev = _events[i].events;
+
+            if (!socket)
+                continue ;//fd ferme (et peut-etre deja reutilise) depuis que l'evenement a ete produit
+
+            if (socket == _wakeSock)
+            {
+                handleLifecycle();
+                continue ;
+            }
+            if (socket->isListener())
+            {//debut d'ecoute : nouvelle connexion
+                makeNewConect(socket);
+                continue ;
+            }
+            Connection* conn = static_cast<Connection*>(socket);
+            if ((ev & EV_READ) && conn->isLingering())
+            {//fermeture en douceur : ce qui arrive est jete
+                drainLingering(conn);
+                continue ;
+            }
+            if (ev & EV_READ)
+            {
+                if (!readConect(conn, (ev & EV_HUP) != 0))
+                    continue ;//connexion fermee pendant la lecture
+                syncPending(conn);
+                if (conn->hasPendingResponse())
+                {//ecriture directe : le socket est presque toujours writable, on evite un tour de boucle
+                    manageRespond(conn);
+                    continue ;
+                }
+                updateTimer(conn);
+            }
+            else if (ev & (EV_HUP | EV_ERROR))
+            {
+                closeConect(conn);
+                continue ;
+            }
+            if ((ev & EV_WRITE) && conn->hasPendingResponse())
+                manageRespond(conn);
         }
+        expireTimers();
     }
+    std::cout << "- drained, server stopping" << std::endl;
 }
 
-//close socket connection avec client
-void	Server::closeConect(int i) {
-    _connections[_pfds[i].fd]->closeSocket();
-    std::map<int, Connection*>::iterator it = _connections.find(_pfds[i].fd);
-    if (it != _connections.end())//check pas la fin de la map
+//signal recu : SIGUSR2 lance le nouveau binaire avec nos sockets d'ecoute puis on se vide,
+//SIGQUIT vide directement. Si l'exec echoue on continue de servir comme si de rien n'etait
+void    Server::handleLifecycle(void) {
+    consumeLifecycleWakeup(_wakeFd);
+    if (claimReload() && reloadConfig())
+        wakeLifecycleLoops();//les autres reacteurs du process viennent chercher la snapshot
+    if (!_draining && currentConfigGeneration() != _snapshot->generation)
+        adoptConfig();
+    if (claimUpgrade())
+    {
+        std::vector<std::pair<int, int> >   fds;
+
+        for (size_t i = 0; !_reusePort && i < _listenSockets.size(); i++)
+            fds.push_back(std::make_pair(_listenSockets[i]->getServerBlock()->port, _listenSockets[i]->getSocketFD()));
+        if (execNewBinary(fds) < 0)
+        {
+            std::cerr << "upgrade failed, still serving" << std::endl;
+            return ;
+        }
+        requestDrain();
+    }
+    if (pendingLifecycle() & LC_DRAIN)
+        startDrain();
+}
+
+//on arrete d'accepter (le nouveau binaire a les memes sockets ou ouvre les siens),
+//les co au repos ferment tout de suite, les autres finissent leur requete en "Connection: close"
+void    Server::startDrain(void) {
+    if (_draining)
+        return ;
+    _draining = true;
+    for (size_t i = 0; i < _listenSockets.size(); i++)
+    {
+        int fd = _listenSockets[i]->getSocketFD();
+
+        _loop->remove(fd);
+        _table.detach(fd);
+        close(fd);
+        delete _listenSockets[i];
+    }
+    _listenSockets.clear();
+    _loop->remove(_wakeFd);
+    _table.detach(_wakeFd);
+    std::cout << "- draining " << _table.liveConnections() << " connections" << std::endl;
+    for (size_t fd = 0; fd < _table.capacity(); fd++)
     {
-        delete it->second;//value
-        _connections.erase(it);
+        Socket* sock = _table.get(fd);
+
+        if (!sock || sock->isListener())
+            continue ;
+        Connection* conn = static_cast<Connection*>(sock);
+        conn->disableKeepAlive();
+        if (conn->getPhase() == CONN_KEEPALIVE)
+            closeConect(conn);
+    }
+}
+
+//close socket connection avec client
+void	Server::closeConect(Connection* conn) {
+    int fd = conn->getSocketFD();
+
+    _timers.cancel(conn->getTimer());
+    conn->releaseRecvBuffers(_rxPool);
+    releaseConfig(conn->getSnapshot());
+    if (conn->isCountedPending())
+    {//reponse abandonnee avec la connexion
+        conn->setCountedPending(false);
+        _admission.pending--;
+        _admission.overloaded = _config->maxPendingRequests > 0
+            && _admission.pending >= (unsigned long)_config->maxPendingRequests;
     }
-    if (i != _fd_n - 1)//remplace la connexion perdue par la plus recente
-        _pfds[i] = _pfds[_fd_n - 1];
-	_fd_n--;//diminue nb fd
+    _loop->remove(fd);
+    try {
+        conn->closeSocket();
+    } catch (const char* e) {
+        std::cerr << e << std::endl;
+    }
+    _table.detach(fd);
+    _table.destroyConnection(conn);
     std::cout << "Socket Close Succelly" << std::endl;
 }
 
-//compare chaque fd au socket actuel, et renvoie le lien si il trouve 
-Socket*    Server::checkListen(int fd) {
-    for (std::vector<Socket*>::iterator it = _listenSockets.begin(); it != _listenSockets.end(); it++){
-        if (fd == (*it)->getSocketFD())
-            return (*it) ;
+//accept non bloquant + close-on-exec : accept4 fait les deux en un appel sur linux,
+//sinon fcntl derriere accept. Sans CLOEXEC les fils CGI heritent des sockets clients
+static int	acceptClient(int listenFd, struct sockaddr_storage* addr, socklen_t* addrlen) {
+    int fd;
+
+#if defined(__linux__) && defined(SOCK_NONBLOCK) && defined(SOCK_CLOEXEC)
+    fd = accept4(listenFd, (struct sockaddr *)addr, addrlen, SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
+    int flags;
+
+    if ((fd = accept(listenFd, (struct sockaddr *)addr, addrlen)) < 0)
+        return (-1);
+    if ((flags = fcntl(fd, F_GETFL, 0)) < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0
+        || fcntl(fd, F_SETFD, FD_CLOEXEC) < 0)
+    {
+        close(fd);
+        return (-1);
     }
-    return (NULL);
+#endif
+    return (fd);
 }
 
-//ouvre une nouvelle connexion sur un socket dispo et un port associé
+//vide la file d'attente du listener jusqu'a EAGAIN, accept_batch connexions au plus par evenement :
+//le listener est en level-triggered, ce qui reste sera repris au prochain wait() sans affamer les autres
 void	Server::makeNewConect(Socket* listenSock) {
 	socklen_t				addrlen;
 	struct sockaddr_storage	remote_addr;
 	char					remoteIP[INET_ADDRSTRLEN];
-    Connection*             new_connection = new Connection();
+    int                     fd;
 
-	addrlen = sizeof(remote_addr);
-    try {
-	    new_connection->setSocketFD(accept(listenSock->getSocketFD(), (struct sockaddr *)&remote_addr, &addrlen));// Set the socket for the connection
-        new_connection->setServerBlock(listenSock->getServerBlock());// Add server block config to this connection
-    } catch (std::exception& e) {
-        std::cerr << e.what() << std::endl;
-    }
-    addConect(new_connection->getSocketFD(), new_connection);	// add connection to list of existing connections in pfds
-	std::cout << "New connexion " << inet_ntop(remote_addr.ss_family, get_in_addr((struct sockaddr*)&remote_addr), remoteIP, INET_ADDRSTRLEN);
-	std::cout << " on socket " << new_connection->getSocketFD();
-    std::cout << " over port " << new_connection->getServerBlock()->getListeningPort() << std::endl;
-}
-
-//gère la lecture des données de la connexion
-void	Server::readConect(int i) {// A modif en try catch
-	int	    n;
-	char    str[BUFF_SIZE];
-
-	memset(str, 0, BUFF_SIZE);
-    n = recv(_pfds[i].fd, str, sizeof(str), 0);
-	if (n <= 0)
-	{
-		if (n == 0)// pas d'erreur : co fermee par le client
-			std::cout << "Socket closed : " << _connections[_pfds[i].fd]->getSocketFD() << std::endl;
-		else if (n < 0)//erreur
-            closeConect(i);
-		closeConect(i);// repetition pas forcement nessessaire
-	}
-	else
-	{
-        _connections[_pfds[i].fd]->handleRequest(str);
-        memset(str, 0, BUFF_SIZE);
-	}
-}
-
-//gere les reponses, a voir avec ta partie puisque de base se basait sur une srtuct perso
-void    Server::manageRespond(int i) {
-    std::string     str;
+    for (int n = 0; n < _config->acceptBatch; n++)
+    {
+        addrlen = sizeof(remote_addr);
+        if ((fd = acceptClient(listenSock->getSocketFD(), &remote_addr, &addrlen)) < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue ;//client parti avant l'accept : le suivant attend peut-etre
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                std::cerr << "error with accept : " << strerror(errno) << std::endl;
+            return ;//EAGAIN : file vide ; EMFILE/ENFILE : on reessaiera au prochain tour
+        }
+        if (_table.liveConnections() >= (size_t)_config->workerConnections)
+        {//worker_connections atteint : on vide quand meme la file, chaque client recoit un 503 immediat
+            refuseConnection(fd);
+            continue ;
+        }
+        Connection*             new_connection = _table.createConnection();//slab : pas de new par accept
+        new_connection->setSocketFD(fd);// Set the socket for the connection
+        retainConfig(_snapshot);//la connexion garde sa snapshot jusqu'a sa prochaine requete
+        new_connection->setSnapshot(_snapshot, listenSock->getServerBlock());
+        new_connection->setAdmission(&_admission);
+        new_connection->setRateLimiter(&_rateLimiter);
+        new_connection->setClientAddr(remote_addr);
+        if (!addConect(fd, new_connection))	// add connection to the event loop
+            continue ;
+        _admission.accepted++;//compte seulement une fois enregistree
+        std::cout << "New connexion " << inet_ntop(remote_addr.ss_family, get_in_addr((struct sockaddr*)&remote_addr), remoteIP, INET_ADDRSTRLEN);
+        std::cout << " on socket " << fd;
+        std::cout << " over port " << new_connection->getServerBlock()->port << std::endl;
+    }
+}
 
-    try {
-        str = _connections[_pfds[i].fd]->getRawstr();
-    } catch (std::exception& e) {
-        std::cerr << "error with repsonse to existing socket..." << std::endl;
+//gère la lecture des données de la connexion : readv dans les blocs du pool, on vide le socket
+//(obligatoire en edge-triggered, sans effet de bord en level). Une lecture plus courte que les
+//blocs veut dire que le socket est vide : pas besoin d'un readv de plus pour voir EAGAIN,
+//la prochaine arrivee de donnees redonnera un evenement. Sauf si le client a deja ferme (EV_HUP) :
+//la fin de flux arrive dans le meme front, aucun autre evenement ne suivra, on lit jusqu'a la voir.
+//Fin de flux avec des reponses en file : elles partent d'abord, la connexion est fermee ensuite.
+//renvoie false si la connexion a ete fermee
+bool	Server::readConect(Connection* conn, bool peerClosed) {
+    struct iovec    iov[RECV_CHUNKS_BODY];
+	ssize_t	        n;
+    int             cnt;
+
+    while (!conn->isPipelinePaused())//file pleine : le reste attend dans le socket (EV_READ retire)
+    {
+        cnt = conn->prepareRecv(_rxPool, iov);
+        n = readv(conn->getSocketFD(), iov, cnt);
+        if (n > 0)
+        {
+            conn->consumeRecv(n);
+            if (conn->shouldClose())
+                break ;//refus en file : il part tout de suite, le reste sera lu et jete en fermant
+            if ((size_t)n == (size_t)cnt * RECV_CHUNK_SIZE || peerClosed)
+                continue ;//blocs pleins : il en reste peut-etre ; EV_HUP : jusqu'a la fin de flux
+            break ;
+        }
+        if (n < 0 && errno == EINTR)
+            continue ;
+        if (n == 0 && conn->hasPendingResponse())
+        {
+            conn->setPeerClosed();
+            break ;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break ;//tout est lu
+        if (n == 0)// pas d'erreur : co fermee par le client
+            std::cout << "Socket closed : " << conn->getSocketFD() << std::endl;
+        closeConect(conn);
+        return (false);
     }
-    if (str.empty())
-        return ;
+    if (conn->isPipelinePaused())
+        conn->setReadCut(true);//socket pas vide : en edge-triggered, pas d'autre evenement sans re-armement
+    if (conn->getPhase() != CONN_BODY)
+        conn->releaseRecvBuffers(_rxPool);//en-tete complet ou co au repos : rien a garder
+    return (true);
+}
 
-    char* buffer = new char[str.size()];//add protzection !!!
-    std::memcpy(buffer, str.c_str(), str.size());
-    int bytes_sent = send(_pfds[i].fd, buffer, str.size(), 0);
-    if (str.find("302 Found") != std::string::npos
-        || str.find("404 Not Found") != std::string::npos
-        || str.find("204 No Content") != std::string::npos
-        || str.find("413 Content Too Large") != std::string::npos
-        || str.find("401 Unauthorized") != std::string::npos
-		)
+//vide la file de sortie de la connexion : ce qui ne part pas (socket plein) attend le prochain EV_WRITE
+//renvoie false si la connexion a ete fermee
+bool    Server::manageRespond(Connection* conn) {
+    int res;
+
+    while ((res = conn->flushResponse()) == FLUSH_DONE && conn->resumePipeline())
+        ;//pipeline suspendu sur une file pleine : la suite part dans le meme passage (SIGPIPE ignore dans le main)
+
+    if (res == FLUSH_ERROR)
     {
+        std::cerr << "error with send for respond..." << std::endl;
+        closeConect(conn);
+        return (false);
+    }
+    if (res == FLUSH_DONE && conn->getSnapshot() != _snapshot && !conn->shouldClose()
+        && conn->getPhase() == CONN_KEEPALIVE && !rebindConfig(conn))
+        return (false);//reponse finie sur l'ancienne config, port retire depuis
+    if (res == FLUSH_DONE && conn->shouldLinger())
+        return (lingerConect(conn));
+    if (res == FLUSH_DONE && (conn->shouldClose() || (_draining && conn->getPhase() == CONN_KEEPALIVE)))
+    {//Connection: close, keepalive_requests atteint ou erreur de requete
         std::cout << "End connect" << std::endl;
-        closeConect(i);
-    }// permet de ne traiter que les reponses attendues
-    delete[] buffer;
-    if (bytes_sent <= 0)
+        closeConect(conn);
+        return (false);
+    }
+    syncPending(conn);
+    updateInterest(conn);//reste en file : EV_WRITE arme, sinon desarme
+    updateTimer(conn);
+    return (true);
+}
+
+//fermeture en douceur apres un refus (413 des l'en-tete...) : le client envoie peut-etre encore son corps.
+//Un close() avec des octets non lus part en RST, qui peut detruire la reponse chez le client avant
+//qu'il la lise : on ferme seulement l'ecriture, puis on lit et jette jusqu'a ce qu'il ferme,
+//LINGERING_TIMEOUT_MS sans rien recevoir ou LINGERING_TIME_MS au total.
+//renvoie false si la connexion a ete fermee
+bool    Server::lingerConect(Connection* conn) {
+    if (shutdown(conn->getSocketFD(), SHUT_WR) < 0)
     {
-        std::cerr << "error with send for respond..." << std::endl;
-        closeConect(i);
-    }//try catch possible pour amelio
-}
-
-//add des connexion socket
-void	Server::addConect(int newfd, Connection* new_conn) {
-	if (_fd_n == _fd_max)
-	{
-		_fd_max *= 2;// pour reallouer exponotiellement et s'adapter au besoin
-		struct pollfd *pfds_new = new pollfd[_fd_max];
-		for (int i = 0; i < _fd_n; i++)
-		{
-			pfds_new[i].fd = _pfds[i].fd;
-			pfds_new[i].events = _pfds[i].events;
-			pfds_new[i].revents = _pfds[i].revents;
-		}
-		delete[] _pfds;
-		_pfds = pfds_new;
-	}
-	_pfds[_fd_n].fd = newfd;
-	_pfds[_fd_n].events = POLLIN | POLLOUT;
-	_fd_n++;
-
-    // Add a connection to the list of connections to the server
-    _connections.insert(std::make_pair(newfd, new_conn));// check fct fct : map?
+        closeConect(conn);
+        return (false);
+    }
+    conn->startLingering(TimerWheel::nowMs() + LINGERING_TIME_MS);
+    conn->releaseRecvBuffers(_rxPool);
+    syncPending(conn);
+    updateInterest(conn);
+    return (drainLingering(conn));
+}
+
+//lit et jette ce qui est arrive (edge-triggered : jusqu'a EAGAIN), ferme a la fin du client ou du delai.
+//Au plus LINGERING_READS_MAX lectures par evenement : un client qui envoie sans fin n'accapare pas
+//la boucle, les octets suivants redonnent un evenement.
+//renvoie false si la connexion a ete fermee
+bool    Server::drainLingering(Connection* conn) {
+    char    buf[RECV_CHUNK_SIZE];
+    ssize_t n = -1;
+    int     reads = 0;
+
+    while (reads++ < LINGERING_READS_MAX)
+    {
+        n = recv(conn->getSocketFD(), buf, sizeof(buf), 0);
+        if (n <= 0 && !(n < 0 && errno == EINTR))
+            break ;
+    }
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+        || TimerWheel::nowMs() >= conn->getLingerDeadline())
+    {//fin du client, erreur ou lingering_time ecoule
+        closeConect(conn);
+        return (false);
+    }
+    updateTimer(conn);
+    return (true);
+}
+
+//add des connexion socket : case dans la table, jeton fd+generation, edge-triggered sur epoll
+//seulement en lecture : un socket connecte est presque toujours writable,
+//l'ecriture n'est armee que quand une reponse attend (updateInterest)
+bool	Server::addConect(int newfd, Connection* new_conn) {
+    uint64_t    token = _table.attach(newfd, new_conn);
+
+    new_conn->setInterest(EV_READ | EV_EDGE);
+    if (!_loop->add(newfd, new_conn->getInterest(), token))
+    {
+        std::cerr << "error with event loop registration" << std::endl;
+        releaseConfig(new_conn->getSnapshot());//reference prise par makeNewConect
+        close(newfd);
+        _table.detach(newfd);
+        _table.destroyConnection(new_conn);
+        return (false);
+    }
+    updateTimer(new_conn);//client_header_timeout des l'accept : une co muette ne reste pas
+    return (true);
+}
+
+//(re)arme le delai de la connexion selon sa phase. L'en-tete et le keep-alive ont un delai global,
+//arme au changement de phase seulement (un octet toutes les 59s ne prolonge rien) ;
+//corps et envoi ont un delai entre deux operations, relance a chaque passage
+void    Server::updateTimer(Connection* conn) {
+    ServerConfig*   sb = conn->getServerBlock();
+    int             phase = conn->getPhase();
+    long            delay;
+
+    if (phase == conn->getTimerPhase() && (phase == CONN_HEADERS || phase == CONN_KEEPALIVE))
+        return ;
+    if (phase == CONN_HEADERS)
+        delay = sb->clientHeaderTimeout;
+    else if (phase == CONN_KEEPALIVE)
+        delay = sb->keepaliveTimeout;
+    else if (phase == CONN_LINGERING)
+    {//relance a chaque lecture, sans depasser la fin de la fermeture en douceur
+        unsigned long   now = TimerWheel::nowMs();
+        unsigned long   left = conn->getLingerDeadline() > now ? conn->getLingerDeadline() - now : 0;
+
+        delay = left < LINGERING_TIMEOUT_MS ? left : LINGERING_TIMEOUT_MS;
+    }
+    else
+        delay = sb->clientBodyTimeout;
+    conn->setTimerPhase(phase);
+    _timers.schedule(conn->getTimer(), delay, conn);
+}
+
+//ferme les connexions dont le delai est depasse : O(1) par tick, quel que soit leur nombre
+void    Server::expireTimers(void) {
+    _timers.advance(TimerWheel::nowMs(), _expired);
+    for (size_t i = 0; i < _expired.size(); i++)
+    {
+        Connection* conn = static_cast<Connection*>(_expired[i]);
+
+        std::cout << "Timeout on socket " << conn->getSocketFD() << std::endl;
+        closeConect(conn);
+    }
+}
+
+//arme EV_WRITE tant qu'il reste une reponse a envoyer, le retire quand la file est vide
+//sans ca poll revient immediatement et la boucle tourne a 100% d'un coeur.
+//EV_READ est retire tant que le pipeline est suspendu. Une lecture coupee est toujours re-armee
+//a la reprise, meme sans changement d'interet : le backend reevalue l'etat du fd et redonne
+//un evenement pour ce qui attend dans le socket
+void    Server::updateInterest(Connection* conn) {
+    bool    paused = conn->isPipelinePaused();
+    int     wanted = paused ? EV_EDGE : EV_READ | EV_EDGE;
+
+    if (conn->hasPendingResponse())
+        wanted |= EV_WRITE;
+    if (wanted == conn->getInterest() && (paused || !conn->isReadCut()))
+        return ;
+    if (!paused)
+        conn->setReadCut(false);
+    if (_loop->modify(conn->getSocketFD(), wanted, _table.tokenOf(conn->getSocketFD())))
+        conn->setInterest(wanted);
+}
+
+//une connexion qui vient d'avoir (ou de vider) sa file de sortie : tient le compte des reponses
+//en attente, et donc la decision de delester les prochaines requetes
+void    Server::syncPending(Connection* conn) {
+    bool    pending = conn->hasPendingResponse();
+
+    if (pending != conn->isCountedPending())
+    {
+        if (pending)
+            _admission.pending++;
+        else
+            _admission.pending--;
+        conn->setCountedPending(pending);
+    }
+    _admission.overloaded = _config->maxPendingRequests > 0
+        && _admission.pending >= (unsigned long)_config->maxPendingRequests;
+}
+
+//client en trop : 503 serialise envoye tel quel (best effort, socket tout neuf donc buffer vide),
+//puis fermeture. Aucune Connection, aucun timer, aucune case dans la boucle
+void    Server::refuseConnection(int fd) {
+    const std::string&  raw = Connection::overloadResponse();
+
+    (void)send(fd, raw.data(), raw.size(), MSG_DONTWAIT | MSG_NOSIGNAL);//client deja parti : rien a faire de plus
+    close(fd);
+    _admission.refused++;
+}
+
+//une ligne par seconde au plus, seulement si quelque chose a bouge
+void    Server::reportAdmission(void) {
+    if (_admission.accepted == _lastReport.accepted && _admission.refused == _lastReport.refused
+        && _admission.admitted == _lastReport.admitted && _admission.shed == _lastReport.shed)
+        return ;
+    std::cout << "admission : accepted " << _admission.accepted << ", refused " << _admission.refused
+        << ", admitted " << _admission.admitted << ", shed " << _admission.shed
+        << ", pending " << _admission.pending << ", live " << _table.liveConnections() << std::endl;
+    _lastReport = _admission;
+}
+
+const AdmissionStats&   Server::getAdmissionStats(void) const {
+    return (_admission);
+}
+
+//compte les reveils de la boucle, bascule sur chaque nouvelle seconde
+//(au repos wait() dort : pas de reveil, pas de compteur qui tourne)
+void    Server::countWakeup(void) {
+    time_t  now = time(NULL);
+
+    if (now != _wakeupsSec)
+    {
+        _wakeupsPerSec = _wakeups;
+        std::cout << "wakeups/s : " << _wakeupsPerSec << std::endl;
+        reportAdmission();
+        _wakeups = 0;
+        _wakeupsSec = now;
+    }
+    _wakeups++;
+}
+
+unsigned long   Server::getWakeupsPerSecond(void) const {
+    return (_wakeupsPerSec);
 }
 
 void* Server::get_in_addr(struct sockaddr *sa) {
     return &(((struct sockaddr_in*)sa)->sin_addr);
-}
\ No newline at end of file
+}
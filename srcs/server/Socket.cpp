@@ -1,6 +1,6 @@
 #include "../../includes/server/Socket.hpp"
 
-Socket::Socket() {
+Socket::Socket() : _sockfd(-1), _sin_size(sizeof(_addr)), _server_block(NULL), _listening(false) {
 }
 
 Socket::~Socket() {
@@ -9,11 +9,15 @@ Socket::~Socket() {
 Socket::Socket(const Socket	&cpy) {
 	this->_sockfd = cpy._sockfd;
 	this->_sin_size = cpy._sin_size;
+	this->_server_block = cpy._server_block;
+	this->_listening = cpy._listening;
 }
 
 Socket& Socket::operator=(const Socket	&src) {
 	this->_sockfd = src._sockfd;
 	this->_sin_size = src._sin_size;
+	this->_server_block = src._server_block;
+	this->_listening = src._listening;
 	return (*this);
 }
 
@@ -26,13 +30,22 @@ static void	*get_in_addr(struct sockaddr *sa)
 }//savoir quelle methode ip est utilisee
 
 //creation de socket unitaire : prepare le point de com
-void	Socket::createSocket(int ai_family, int ai_socktype, int ai_protocol) {
+//reusePort : chaque worker ouvre son propre socket sur le meme port, le noyau repartit les connexions
+void	Socket::createSocket(int ai_family, int ai_socktype, int ai_protocol, bool reusePort) {
 	int yes = 1;
 
 	if ((_sockfd = socket(ai_family, ai_socktype, ai_protocol)) < 0)
 		throw ("error with socket");
+	if (fcntl(_sockfd, F_SETFD, FD_CLOEXEC) < 0)
+		throw ("error with fcntl FD_CLOEXEC");//les fils CGI n'heritent pas du listener
 	if (setsockopt(_sockfd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(int)) < 0)
 		throw ("error with socket opt");
+#ifdef SO_REUSEPORT
+	if (reusePort && setsockopt(_sockfd, SOL_SOCKET, SO_REUSEPORT, &yes, sizeof(int)) < 0)
+		throw ("error with socket opt SO_REUSEPORT");
+#else
+	(void)reusePort;
+#endif
 }
 
 //lie socket et addrIP/port : pour que serv ecoute port 8080 a ip 2.2.2.2 :
@@ -46,6 +59,7 @@ void	Socket::bindSocket(struct sockaddr* ai_addr, socklen_t ai_addrlen) {
 void	Socket::listenOnSocket(void) {
 	if (listen(_sockfd, BACKLOG) < 0)
 		throw ("error with listen socket");
+	_listening = true;
 	std::cout << "listen socket : " << _sockfd << std::endl;
 }
 
@@ -64,7 +78,7 @@ void	Socket::printConnection(void) {
 }
 
 //Fct gestion d'activation de socket
-void	Socket::initListenSocket(const char* port) {
+void	Socket::initListenSocket(const char* port, bool reusePort) {
 	struct addrinfo	base;
 	struct addrinfo	*ai;
 	struct addrinfo *p;
@@ -78,16 +92,18 @@ void	Socket::initListenSocket(const char* port) {
 	for (p = ai; p != NULL; p = p->ai_next)
 	{
 		try {
-			createSocket(p->ai_family, p->ai_socktype, p->ai_protocol);
-		} catch (std::exception& e) {
-			std::cerr << e.what() << std::endl;
+			createSocket(p->ai_family, p->ai_socktype, p->ai_protocol, reusePort);
+		} catch (const char* e) {
+			if (_sockfd >= 0)
+				close(_sockfd);
+			std::cerr << e << std::endl;
 			continue ;
 		}
 		try {
 			bindSocket(p->ai_addr, p->ai_addrlen);
-		} catch (std::exception& e) {
+		} catch (const char* e) {
             close(_sockfd);
-			std::cerr << e.what() << std::endl;
+			std::cerr << e << std::endl;
 			continue ;
 		}
 		break ;
@@ -96,6 +112,26 @@ void	Socket::initListenSocket(const char* port) {
 	if (p == NULL)
 		throw ("error with socket bind");
 	listenOnSocket();
+	setNonBlocking();
+}
+
+//reprend un socket deja lie et en ecoute (herite de l'ancien binaire lors d'un upgrade) :
+//pas de bind ni de listen, les clients en file d'attente ne voient aucune coupure
+void	Socket::adoptListenSocket(int fd) {
+	_sockfd = fd;
+	if (fcntl(_sockfd, F_SETFD, FD_CLOEXEC) < 0)
+		throw ("error with fcntl FD_CLOEXEC");
+	_listening = true;
+	setNonBlocking();
+	std::cout << "listen socket : " << _sockfd << " (inherited)" << std::endl;
+}
+
+//non bloquant : indispensable en edge-triggered, on lit/ecrit jusqu'a EAGAIN
+void    Socket::setNonBlocking(void) {
+	int flags = fcntl(_sockfd, F_GETFL, 0);
+
+	if (flags < 0 || fcntl(_sockfd, F_SETFL, flags | O_NONBLOCK) < 0)
+		throw ("error with fcntl O_NONBLOCK");
 }
 
 //fermeture propre d'un socket
@@ -116,6 +152,10 @@ ServerConfig*    Socket::getServerBlock(void) {
     return (_server_block);
 }
 
+bool    Socket::isListener(void) const {
+    return (_listening);
+}
+
 void    Socket::setSocketFD(int fd) {
     if (fd < 0)
         throw ("Error fd incorrect");
@@ -128,4 +168,4 @@ void    Socket::setPortFD(std::string port) {
 
 void    Socket::setServerBlock(ServerConfig* sb) {
     this->_server_block = sb;
-}
\ No newline at end of file
+}
\ No newline at end of file
@@ -0,0 +1,150 @@
+#include "../../includes/server/TimerWheel.hpp"
+#include <ctime>
+#include <sys/time.h>
+
+TimerWheel::TimerWheel(unsigned long tickMs) : _tickMs(tickMs ? tickMs : 1), _count(0) {
+	for (int l = 0; l < TIMER_LEVELS; l++)
+		for (int i = 0; i < TIMER_SLOTS; i++)
+			_slots[l][i].prev = _slots[l][i].next = &_slots[l][i];
+	_current = nowMs() / _tickMs;
+}
+
+//les noeuds appartiennent aux connexions : on les detache juste
+TimerWheel::~TimerWheel() {
+	for (int l = 0; l < TIMER_LEVELS; l++)
+		for (int i = 0; i < TIMER_SLOTS; i++)
+			while (_slots[l][i].next != &_slots[l][i])
+				cancel(_slots[l][i].next);
+}
+
+//horloge monotone en ms : un changement d'heure systeme ne doit pas faire expirer tout le monde
+unsigned long	TimerWheel::nowMs(void) {
+#ifdef CLOCK_MONOTONIC
+	struct timespec	ts;
+
+	if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
+		return (ts.tv_sec * 1000UL + ts.tv_nsec / 1000000);
+#endif
+	struct timeval	tv;
+
+	gettimeofday(&tv, NULL);
+	return (tv.tv_sec * 1000UL + tv.tv_usec / 1000);
+}
+
+//range le noeud dans le niveau qui couvre son delai
+void	TimerWheel::insert(TimerNode* node) {
+	unsigned long	delta;
+	TimerNode*		head;
+
+	if (node->expires < _current)
+		node->expires = _current;//deja du : traite au prochain tick
+	delta = node->expires - _current;
+	if (delta < (1UL << TIMER_SLOT_BITS))
+		head = &_slots[0][node->expires & TIMER_SLOT_MASK];
+	else if (delta < (1UL << (2 * TIMER_SLOT_BITS)))
+		head = &_slots[1][(node->expires >> TIMER_SLOT_BITS) & TIMER_SLOT_MASK];
+	else if (delta < (1UL << (3 * TIMER_SLOT_BITS)))
+		head = &_slots[2][(node->expires >> (2 * TIMER_SLOT_BITS)) & TIMER_SLOT_MASK];
+	else
+	{
+		if (delta >= (1UL << (4 * TIMER_SLOT_BITS)))
+			node->expires = _current + (1UL << (4 * TIMER_SLOT_BITS)) - 1;//borne : ~19 jours
+		head = &_slots[3][(node->expires >> (3 * TIMER_SLOT_BITS)) & TIMER_SLOT_MASK];
+	}
+	node->prev = head->prev;
+	node->next = head;
+	head->prev->next = node;
+	head->prev = node;
+}
+
+//(re)programme : un timer deja arme est d'abord retire, le delai repart de maintenant
+void	TimerWheel::schedule(TimerNode* node, unsigned long delayMs, void* owner) {
+	unsigned long	ticks = (delayMs + _tickMs - 1) / _tickMs;
+
+	cancel(node);
+	node->owner = owner;
+	node->expires = (nowMs() / _tickMs) + (ticks ? ticks : 1);
+	insert(node);
+	_count++;
+}
+
+void	TimerWheel::cancel(TimerNode* node) {
+	if (!node->pending())
+		return ;
+	node->prev->next = node->next;
+	node->next->prev = node->prev;
+	node->prev = node->next = NULL;
+	_count--;
+}
+
+//redistribue une case d'un niveau superieur : ses timers tombent d'un niveau (ou plus)
+void	TimerWheel::cascade(int level, int index) {
+	TimerNode*	head = &_slots[level][index];
+	TimerNode*	node = head->next;
+
+	head->prev = head->next = head;
+	while (node != head)
+	{
+		TimerNode*	next = node->next;
+
+		insert(node);
+		node = next;
+	}
+}
+
+//traite le tick _current : cascade si le niveau 0 a fait un tour, puis vide sa case
+void	TimerWheel::runTick(std::vector<void*>& expired) {
+	int	index = _current & TIMER_SLOT_MASK;
+
+	for (int l = 1; l < TIMER_LEVELS && index == 0; l++)
+	{
+		index = (_current >> (l * TIMER_SLOT_BITS)) & TIMER_SLOT_MASK;
+		cascade(l, index);
+	}
+	TimerNode*	head = &_slots[0][_current & TIMER_SLOT_MASK];
+	while (head->next != head)
+	{
+		TimerNode*	node = head->next;
+
+		cancel(node);
+		expired.push_back(node->owner);
+	}
+	_current++;
+}
+
+//rattrape tous les ticks jusqu'a maintenant, expired recoit les owners arrives a echeance
+void	TimerWheel::advance(unsigned long nowMs, std::vector<void*>& expired) {
+	unsigned long	target = nowMs / _tickMs;
+
+	expired.clear();
+	if (_count == 0)
+	{//rien d'arme : inutile de rejouer les ticks ecoules
+		if (_current <= target)
+			_current = target + 1;
+		return ;
+	}
+	while (_current <= target)
+		runTick(expired);
+}
+
+//delai avant le prochain tick utile, pour le timeout de wait() (-1 : aucun timer)
+//on regarde les cases du niveau 0 jusqu'a la prochaine cascade : 64 cases au plus
+int		TimerWheel::nextTimeoutMs(unsigned long nowMs) const {
+	unsigned long	t;
+
+	if (_count == 0)
+		return (-1);
+	for (t = _current; ; t++)
+	{
+		const TimerNode*	head = &_slots[0][t & TIMER_SLOT_MASK];
+
+		if (head->next != head || (t & TIMER_SLOT_MASK) == 0)
+			break ;//case non vide, ou cascade qui peut en remplir
+	}
+	unsigned long	deadline = t * _tickMs;
+	return (deadline > nowMs ? static_cast<int>(deadline - nowMs) : 0);
+}
+
+size_t	TimerWheel::size(void) const {
+	return (_count);
+}
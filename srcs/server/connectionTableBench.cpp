@@ -0,0 +1,121 @@
+#include "../../includes/server/ConnectionTable.hpp"
+#include "../../includes/server/TimerWheel.hpp"
+#include <map>
+#include <cstdlib>
+#include <iostream>
+
+// bench : std::map<int, Connection*> + new/delete (ancien Server) contre ConnectionTable + slab,
+// sur 50k connexions (pas de vrais sockets : les fds sont simules)
+
+#define BENCH_CONNS		50000
+#define BENCH_LOOKUPS	2000000
+#define BENCH_FD_BASE	5	// 0-2 std, 3-4 epoll + listener
+
+static unsigned long	elapsed(unsigned long start) {
+	return (TimerWheel::nowMs() - start);
+}
+
+static void	report(const char* what, unsigned long mapMs, unsigned long tableMs) {
+	std::cout << "  " << what << " : map " << mapMs << " ms, table " << tableMs << " ms";
+	if (tableMs > 0)
+		std::cout << " (x" << (double)mapMs / tableMs << ")";
+	std::cout << std::endl;
+}
+
+int	main(void) {
+	std::vector<int>	order(BENCH_LOOKUPS);
+	unsigned long		start;
+	unsigned long		mapInsert, mapLookup, mapChurn, tabInsert, tabLookup, tabChurn;
+	size_t				hits = 0;
+
+	std::srand(42);
+	for (size_t i = 0; i < order.size(); i++)
+		order[i] = BENCH_FD_BASE + std::rand() % BENCH_CONNS;
+	std::cout << "--- connection table bench : " << BENCH_CONNS << " connections, "
+		<< BENCH_LOOKUPS << " event lookups ---" << std::endl;
+
+	// ancien chemin : map + new/delete
+	{
+		std::map<int, Connection*>	conns;
+
+		start = TimerWheel::nowMs();
+		for (int fd = BENCH_FD_BASE; fd < BENCH_FD_BASE + BENCH_CONNS; fd++)
+		{
+			Connection*	c = new Connection();
+			c->setSocketFD(fd);
+			conns.insert(std::make_pair(fd, c));
+		}
+		mapInsert = elapsed(start);
+		start = TimerWheel::nowMs();
+		for (size_t i = 0; i < order.size(); i++)
+		{
+			std::map<int, Connection*>::iterator	it = conns.find(order[i]);
+			if (it != conns.end() && it->second->getSocketFD() == order[i])
+				hits++;
+		}
+		mapLookup = elapsed(start);
+		start = TimerWheel::nowMs();
+		for (int fd = BENCH_FD_BASE; fd < BENCH_FD_BASE + BENCH_CONNS; fd++)
+		{//fermeture puis accept sur le meme fd
+			std::map<int, Connection*>::iterator	it = conns.find(fd);
+			delete it->second;
+			conns.erase(it);
+			Connection*	c = new Connection();
+			c->setSocketFD(fd);
+			conns.insert(std::make_pair(fd, c));
+		}
+		mapChurn = elapsed(start);
+		for (std::map<int, Connection*>::iterator it = conns.begin(); it != conns.end(); ++it)
+			delete it->second;
+	}
+
+	// nouveau chemin : table indexee par fd + slab, lookup par jeton
+	bool	staleOk = true;
+	{
+		ConnectionTable			table;
+		std::vector<uint64_t>	tokens(BENCH_FD_BASE + BENCH_CONNS);
+
+		start = TimerWheel::nowMs();
+		for (int fd = BENCH_FD_BASE; fd < BENCH_FD_BASE + BENCH_CONNS; fd++)
+		{
+			Connection*	c = table.createConnection();
+			c->setSocketFD(fd);
+			tokens[fd] = table.attach(fd, c);
+		}
+		tabInsert = elapsed(start);
+		start = TimerWheel::nowMs();
+		for (size_t i = 0; i < order.size(); i++)
+		{
+			Socket*	s = table.lookup(tokens[order[i]]);
+			if (s && s->getSocketFD() == order[i])
+				hits++;
+		}
+		tabLookup = elapsed(start);
+		start = TimerWheel::nowMs();
+		for (int fd = BENCH_FD_BASE; fd < BENCH_FD_BASE + BENCH_CONNS; fd++)
+		{
+			uint64_t	old = tokens[fd];
+
+			table.destroyConnection(static_cast<Connection*>(table.get(fd)));
+			table.detach(fd);
+			Connection*	c = table.createConnection();
+			c->setSocketFD(fd);
+			tokens[fd] = table.attach(fd, c);
+			if (table.lookup(old) != NULL)
+				staleOk = false;//un evenement de l'ancienne connexion ne doit pas tomber sur la nouvelle
+		}
+		tabChurn = elapsed(start);
+		for (int fd = BENCH_FD_BASE; fd < BENCH_FD_BASE + BENCH_CONNS; fd++)
+		{
+			table.destroyConnection(static_cast<Connection*>(table.get(fd)));
+			table.detach(fd);
+		}
+	}
+
+	report("insert    ", mapInsert, tabInsert);
+	report("lookup    ", mapLookup, tabLookup);
+	report("close+open", mapChurn, tabChurn);
+	std::cout << "  hits : " << hits << " / " << 2 * order.size() << std::endl;
+	std::cout << "  stale tokens rejected : " << (staleOk ? "yes" : "NO") << std::endl;
+	return ((staleOk && hits == 2 * order.size()) ? 0 : 1);
+}
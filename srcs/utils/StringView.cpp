@@ -0,0 +1,97 @@
+#include "../../includes/utils/StringView.hpp"
+
+#include <cstring> // For std::strlen, std::memcmp
+#include <cctype>  // For std::tolower
+
+const size_t StringView::npos;
+
+StringView::StringView() : _data(NULL), _size(0) {}
+
+StringView::StringView(const char* data, size_t size) : _data(data), _size(data ? size : 0) {}
+
+StringView::StringView(const char* cstr) : _data(cstr), _size(cstr ? std::strlen(cstr) : 0) {}
+
+StringView::StringView(const std::string& str) : _data(str.data()), _size(str.size()) {}
+
+const char* StringView::data() const {
+    return _data;
+}
+
+size_t StringView::size() const {
+    return _size;
+}
+
+bool StringView::empty() const {
+    return _size == 0;
+}
+
+char StringView::operator[](size_t i) const {
+    return _data[i];
+}
+
+std::string StringView::str() const {
+    return _size ? std::string(_data, _size) : std::string();
+}
+
+bool StringView::equals(const StringView& other) const {
+    return _size == other._size && (_size == 0 || std::memcmp(_data, other._data, _size) == 0);
+}
+
+bool StringView::iequals(const StringView& other) const {
+    if (_size != other._size) {
+        return false;
+    }
+    for (size_t i = 0; i < _size; ++i) {
+        if (std::tolower(static_cast<unsigned char>(_data[i])) != std::tolower(static_cast<unsigned char>(other._data[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool StringView::startsWith(const StringView& prefix) const {
+    return prefix._size <= _size && (prefix._size == 0 || std::memcmp(_data, prefix._data, prefix._size) == 0);
+}
+
+size_t StringView::find(char c, size_t pos) const {
+    for (size_t i = pos; i < _size; ++i) {
+        if (_data[i] == c) {
+            return i;
+        }
+    }
+    return npos;
+}
+
+size_t StringView::rfind(char c) const {
+    for (size_t i = _size; i > 0; --i) {
+        if (_data[i - 1] == c) {
+            return i - 1;
+        }
+    }
+    return npos;
+}
+
+StringView StringView::substr(size_t pos, size_t n) const {
+    if (pos > _size) {
+        return StringView();
+    }
+    if (n > _size - pos) {
+        n = _size - pos;
+    }
+    return StringView(_data + pos, n);
+}
+
+bool operator==(const StringView& a, const StringView& b) {
+    return a.equals(b);
+}
+
+bool operator!=(const StringView& a, const StringView& b) {
+    return !a.equals(b);
+}
+
+std::ostream& operator<<(std::ostream& os, const StringView& view) {
+    if (view.size()) {
+        os.write(view.data(), view.size());
+    }
+    return os;
+}